@@ -1,10 +1,15 @@
 #include "ConnectionBenchmark.h"
 
-bool ConnectionBenchmark::update(uint32_t time) {
-    return this->timer.expired(time);
+void ConnectionBenchmark::sent() {
+    this->estimator.sent();
+    this->inFlight++;
 }
 
 void ConnectionBenchmark::newAnswer(uint16_t rtt) {
-    uint32_t previousRtt = this->averageRtt * this->receivedCount;
-    this->averageRtt = (previousRtt + rtt) / ++this->receivedCount;
+    this->estimator.received(rtt);
+    if (this->inFlight > 0) this->inFlight--;
+}
+
+void ConnectionBenchmark::lost() {
+    if (this->inFlight > 0) this->inFlight--;
 }
\ No newline at end of file
@@ -1,44 +1,76 @@
 #ifndef NETWORKPROTOCOL_CONNECTIONBENCHMARK_H
 #define NETWORKPROTOCOL_CONNECTIONBENCHMARK_H
 #include <cstdint>
-#include "../timer.h"
+#include "LinkEstimator.h"
 
 
 class ConnectionBenchmark {
     /**
-     * Number of pings returned.
+     * Quality of the connection, estimated from the pings.
      */
-    uint8_t receivedCount;
+    LinkEstimator estimator;
 
     /**
-     * Average round trip time of the received pings.
+     * Number of pings that have neither been answered nor timed out.
      */
-    uint16_t averageRtt;
+    uint8_t inFlight = 0;
 
     /**
-     * Timer for the Benchmark.
+     * True if no more pings are sent, because the result is clear already.
      */
-    Timer timer;
+    bool stopped = false;
 
 public:
     /**
-     * Sets up the benchmark for one device.
-     * @param timeout Time maximum waited beginning at the current time.
-     * @param currentTime Current time.
+     * A ping has been sent.
      */
-    explicit ConnectionBenchmark(uint16_t timeout, uint32_t currentTime) : receivedCount(0), averageRtt(0), timer(timeout, currentTime) {}
-
-    /**
-     * Checks if the benchmark is finished.
-     * @return True, if benchmark is finished.
-     */
-    bool update(uint32_t time);
+    void sent();
 
     /**
      * Got a new answer, save it.
      * @param rtt Round trip time of the ping.
      */
     void newAnswer(uint16_t rtt);
+
+    /**
+     * A ping has timed out.
+     */
+    void lost();
+
+    /**
+     * Stops sending pings, because the result is clear already.
+     */
+    void stop() {
+        this->stopped = true;
+    }
+
+    /**
+     * @return True if no more pings are sent, because the result is clear already.
+     */
+    bool isStopped() const {
+        return this->stopped;
+    }
+
+    /**
+     * @return Number of pings sent.
+     */
+    uint16_t getSentCount() const {
+        return this->estimator.getSentCount();
+    }
+
+    /**
+     * @return Number of pings that have been answered or have timed out.
+     */
+    uint16_t getResolvedCount() const {
+        return this->estimator.getSentCount() - this->inFlight;
+    }
+
+    /**
+     * @return Quality of the connection, estimated from the pings so far.
+     */
+    const LinkEstimator& getEstimator() const {
+        return this->estimator;
+    }
 };
 
 
@@ -1,34 +1,147 @@
 #include "ConnectionBenchmarkWrapper.h"
 
 #include "../Messages/messageObjects.h"
-#include "../networkDevice.h"
+#include "../timer.h"
 
-bool ConnectionBenchmarkWrapper::update(uint32_t time, Message** msg) {
+ConnectionBenchmarkWrapper::ConnectionBenchmarkWrapper(const uint8_t *devices, uint8_t numberDevices,
+    uint8_t numberMessages, uint16_t timeout, uint8_t window, uint8_t id) : numberMessages(numberMessages),
+    window(window < BENCHMARK_MAX_WINDOW ? window : BENCHMARK_MAX_WINDOW), timeout(timeout), id(id) {
+    if (this->window == 0) this->window = 1;
+    for (uint8_t i = 0; i < numberDevices; i++) {
+        // each device is pinged in its turn only once
+        if (this->benchmarks.count(devices[i]) != 0) continue;
+        this->devices.push_back(devices[i]);
+        this->benchmarks[devices[i]] = new ConnectionBenchmark();
+    }
+}
 
-    if (this->currentDeviceIndex == this->numberDevices) {
-        // All messages to all devices have already been sent, check if all benchmarks have finished
+bool ConnectionBenchmarkWrapper::_needsPings(const ConnectionBenchmark *benchmark) const {
+    return !benchmark->isStopped() && benchmark->getSentCount() < this->numberMessages;
+}
 
-        for (uint8_t i = 0; i < this->numberDevices; ++i) {
-            uint8_t id = (*this->devices)[i];
+void ConnectionBenchmarkWrapper::_expire(uint32_t time) {
+    bool expired = false;
+    for (BenchmarkProbe &probe : this->probes) {
+        if (!probe.used || Timer::elapsed(probe.sentTime, time) <= this->timeout) continue;
+        probe.used = false;
+        this->benchmarks[probe.device]->lost();
+        expired = true;
+    }
+    if (expired) this->_evaluate();
+}
 
-            // A benchmark has not finished yet
-            if (!this->benchmarks[id]->update(time)) return false;
+void ConnectionBenchmarkWrapper::_evaluate() {
+    // lowest cost of the devices with enough results
+    uint32_t bestCost = UINT32_MAX;
+    ConnectionBenchmark *best = nullptr;
+    for (auto &entry : this->benchmarks) {
+        ConnectionBenchmark *benchmark = entry.second;
+        if (benchmark->getResolvedCount() < BENCHMARK_MIN_PINGS) continue;
+        uint32_t cost = benchmark->getEstimator().cost();
+        if (best == nullptr || cost < bestCost) {
+            bestCost = cost;
+            best = benchmark;
         }
+    }
+    if (best == nullptr) return;
 
-        return true;
+    // devices that have not answered at all or are far behind the best one are clearly bad
+    bool othersStopped = true;
+    for (auto &entry : this->benchmarks) {
+        ConnectionBenchmark *benchmark = entry.second;
+        if (benchmark == best) continue;
+        if (benchmark->getResolvedCount() >= BENCHMARK_MIN_PINGS) {
+            uint32_t cost = benchmark->getEstimator().cost();
+            if (cost == UINT32_MAX || static_cast<uint64_t>(cost) > static_cast<uint64_t>(bestCost) * BENCHMARK_MARGIN) {
+                benchmark->stop();
+            }
+        }
+        if (this->_needsPings(benchmark)) othersStopped = false;
+    }
+    // the best device is clear, if it is the only one left
+    if (othersStopped) best->stop();
+}
+
+bool ConnectionBenchmarkWrapper::update(uint32_t time, uint8_t pingId, Message** msg) {
+    this->_expire(time);
+    if (this->finished()) return true;
+
+    BenchmarkProbe *slot = nullptr;
+    for (BenchmarkProbe &probe : this->probes) {
+        if (!probe.used) {
+            slot = &probe;
+            break;
+        }
+    }
+    if (this->inFlight() >= this->window || slot == nullptr) return false;
+
+    // the devices take turns, so all of them are benchmarked under the same conditions
+    for (uint8_t turn = 0; turn < this->devices.size(); turn++) {
+        uint8_t index = (this->nextDeviceIndex + turn) % this->devices.size();
+        uint8_t device = this->devices[index];
+        ConnectionBenchmark *benchmark = this->benchmarks[device];
+        if (!this->_needsPings(benchmark)) continue;
+
+        this->nextDeviceIndex = (index + 1) % this->devices.size();
+        *slot = {true, pingId, device, time};
+        benchmark->sent();
+        *msg = new PingMessage(device, pingId, this->id, false, time, true);
+        return false;
     }
+    // only the answers of the pings in flight are awaited
+    return false;
+}
+
+bool ConnectionBenchmarkWrapper::nextUpdate(uint32_t time, uint32_t *delay) const {
+    if (this->finished()) return false;
 
-    uint8_t id = (*this->devices)[this->currentDeviceIndex];
-    *msg = new PingMessage(id, time % 256, this->id, false, time);
+    uint8_t inFlight = this->inFlight();
+    bool canSend = inFlight < this->window && inFlight < BENCHMARK_MAX_WINDOW;
+    bool needsPings = false;
+    for (auto &entry : this->benchmarks) {
+        needsPings = needsPings || this->_needsPings(entry.second);
+    }
+    *delay = canSend && needsPings ? 0 : UINT32_MAX;
 
-    if (++this->numberMessagesSent == this->numberMessages) {
-        this->numberMessagesSent = 0;
-        ++this->currentDeviceIndex;
+    for (const BenchmarkProbe &probe : this->probes) {
+        if (!probe.used) continue;
+        uint32_t elapsed = Timer::elapsed(probe.sentTime, time);
+        uint32_t wait = elapsed > this->timeout ? 0 : this->timeout + 1 - elapsed;
+        if (wait < *delay) *delay = wait;
     }
+    return true;
+}
 
+bool ConnectionBenchmarkWrapper::newAnswer(uint8_t id, uint8_t pingId, uint32_t time) {
+    for (BenchmarkProbe &probe : this->probes) {
+        if (!probe.used || probe.pingId != pingId || probe.device != id) continue;
+        probe.used = false;
+        uint32_t rtt = Timer::elapsed(probe.sentTime, time);
+        this->benchmarks[id]->newAnswer(rtt > UINT16_MAX ? UINT16_MAX : rtt);
+        this->_evaluate();
+        return true;
+    }
     return false;
 }
 
-void ConnectionBenchmarkWrapper::newAnswer(uint8_t id, uint16_t rtt) {
-    this->benchmarks[id]->newAnswer(rtt);
-}
\ No newline at end of file
+bool ConnectionBenchmarkWrapper::finished() const {
+    if (this->inFlight() > 0) return false;
+    for (auto &entry : this->benchmarks) {
+        if (this->_needsPings(entry.second)) return false;
+    }
+    return true;
+}
+
+uint8_t ConnectionBenchmarkWrapper::inFlight() const {
+    uint8_t count = 0;
+    for (const BenchmarkProbe &probe : this->probes) {
+        if (probe.used) ++count;
+    }
+    return count;
+}
+
+const LinkEstimator* ConnectionBenchmarkWrapper::getEstimator(uint8_t id) const {
+    auto benchmark = this->benchmarks.find(id);
+    if (benchmark == this->benchmarks.end()) return nullptr;
+    return &benchmark->second->getEstimator();
+}
@@ -7,23 +7,59 @@
 #include "ConnectionBenchmark.h"
 #include "../Messages/messageObjects.h"
 
+#define BENCHMARK_MAX_WINDOW 16
+#define BENCHMARK_MIN_PINGS 5
+#define BENCHMARK_MARGIN 2
+
+/**
+ * A ping of a benchmark, that has neither been answered nor timed out.
+ */
+typedef struct BenchmarkProbe {
+    /**
+     * True if this slot holds a ping.
+     */
+    bool used;
+
+    /**
+     * ID of the ping, the response carries the same ID.
+     */
+    uint8_t pingId;
 
+    /**
+     * ID of the benchmarked device.
+     */
+    uint8_t device;
+
+    /**
+     * Time the ping has been sent.
+     */
+    uint32_t sentTime;
+} BenchmarkProbe;
+
+/**
+ * Benchmarks the connections to several devices at once. The pings are sent to the devices in turns,
+ * with up to a window of pings in flight, and the responses are matched to the pings by their ID.
+ * The pings are direct, so they measure the links to the neighbours instead of the routes to them.
+ * After BENCHMARK_MIN_PINGS pings to a device have been answered or have timed out, the device is stopped if its cost
+ * is more than BENCHMARK_MARGIN times the lowest cost. The device with the lowest cost is stopped, when all other
+ * devices are stopped, so the benchmark ends as soon as the best connection is clear.
+ */
 class ConnectionBenchmarkWrapper {
 
     /**
-     * Number of messages sent for each benchmark.
+     * Maximum number of messages sent for each benchmark.
      */
     uint8_t numberMessages;
 
     /**
-     * Number of messages sent for the current device.
+     * Maximum number of pings in flight.
      */
-    uint8_t numberMessagesSent;
+    uint8_t window;
 
     /**
-     * Index of the current device.
+     * Time after which a ping without response is counted as lost.
      */
-    uint8_t currentDeviceIndex;
+    uint16_t timeout;
 
     /**
      * ID of this device.
@@ -31,14 +67,14 @@ class ConnectionBenchmarkWrapper {
     uint8_t id;
 
     /**
-     * Number of devices to benchmark.
+     * Index of the device that is pinged next, if it still needs pings.
      */
-    uint8_t numberDevices;
+    uint8_t nextDeviceIndex = 0;
 
     /**
      * IDs of the devices to benchmark.
      */
-    uint8_t **devices;
+    std::vector<uint8_t> devices;
 
     /**
      * Benchmarks for the connections tested.
@@ -47,48 +83,96 @@ class ConnectionBenchmarkWrapper {
      */
     std::map<uint8_t, ConnectionBenchmark*> benchmarks;
 
+    /**
+     * Pings in flight.
+     */
+    BenchmarkProbe probes[BENCHMARK_MAX_WINDOW] = {};
+
+    /**
+     * @param benchmark A benchmark.
+     * @return True if the benchmark needs more pings.
+     */
+    bool _needsPings(const ConnectionBenchmark *benchmark) const;
+
+    /**
+     * Counts the pings without response within the timeout as lost.
+     * @param time Current time.
+     */
+    void _expire(uint32_t time);
+
+    /**
+     * Stops the benchmarks whose result is clear.
+     */
+    void _evaluate();
+
 public:
     /**
-     * Destructor. Destroys device array.
+     * Destructor. Destroys the benchmarks.
      */
     ~ConnectionBenchmarkWrapper() {
-        delete[] this->devices;
+        for (auto &benchmark : this->benchmarks) delete benchmark.second;
     }
 
+    ConnectionBenchmarkWrapper(const ConnectionBenchmarkWrapper&) = delete;
+    ConnectionBenchmarkWrapper& operator=(const ConnectionBenchmarkWrapper&) = delete;
+
     /**
      * Sets up benchmark tests.
-     * @param devices IDs of the devices to benchmark.
+     * @param devices IDs of the devices to benchmark. They are copied.
      * @param numberDevices Number of devices to benchmark.
-     * @param numberMessages Number of messages sent for each benchmark.
-     * @param timeout Time maximum waited in milliseconds beginning at the current time.
-     * @param currentTime Current time.
+     * @param numberMessages Maximum number of messages sent for each benchmark.
+     * @param timeout Time in milliseconds after which a ping without response is counted as lost.
+     * @param window Maximum number of pings in flight, at most BENCHMARK_MAX_WINDOW.
      * @param id ID of this ID.
      */
-    ConnectionBenchmarkWrapper(uint8_t **devices, uint8_t numberDevices, uint8_t numberMessages,
-        uint16_t timeout, uint32_t currentTime, uint8_t id) : numberMessages(numberMessages), numberMessagesSent(0),
-                                                              currentDeviceIndex(0), id(id),
-                                                              numberDevices(numberDevices),
-                                                              devices(devices) {
-        for (uint8_t i = 0; i < numberDevices; i++) {
-            this->benchmarks[(*devices)[i]] = new ConnectionBenchmark(timeout, currentTime);
-        }
-    }
+    ConnectionBenchmarkWrapper(const uint8_t *devices, uint8_t numberDevices, uint8_t numberMessages,
+        uint16_t timeout, uint8_t window, uint8_t id);
 
     /**
-     * Checks if the benchmark is finished.
+     * Checks if the benchmark is finished and creates the next ping, if the window allows it.
+     * Can be called several times per update to fill the window.
      * @param time Current time.
-     * @param msg If the benchmark is not finished yet, this message has to be sent and then deleted.
+     * @param pingId ID of the ping, if one is created. The device takes it from its message IDs, so the responses
+     * to its other pings are not mistaken for the responses to the benchmark.
+     * @param msg If a ping has to be sent, it is written into this. It has to be sent and then deleted.
      * @return True, if benchmark is finished.
      */
-    bool update(uint32_t time, Message** msg);
+    bool update(uint32_t time, uint8_t pingId, Message** msg);
+
+    /**
+     * Calculates when the benchmark has to be updated next.
+     * @param time Current time.
+     * @param delay Milliseconds until the next ping can be sent or a ping times out are written into this.
+     * @return False if the benchmark is finished.
+     */
+    bool nextUpdate(uint32_t time, uint32_t *delay) const;
+
+    /**
+     * Got a new answer, save it, if it belongs to a ping in flight.
+     * @param id ID of the benchmarked device.
+     * @param pingId ID of the ping.
+     * @param time Current time.
+     * @return True if the answer belongs to this benchmark.
+     */
+    bool newAnswer(uint8_t id, uint8_t pingId, uint32_t time);
+
+    /**
+     * @return True if no more pings are sent and all pings have been answered or have timed out.
+     */
+    bool finished() const;
+
+    /**
+     * @return Number of pings in flight.
+     */
+    uint8_t inFlight() const;
 
     /**
-     * Got a new answer, save it.
+     * Looks up the estimated quality of the connection to a benchmarked device.
      * @param id ID of the benchmarked device.
-     * @param rtt Round trip time of the ping.
+     * @return The estimate or nullptr if the device is not benchmarked.
      */
-    void newAnswer(uint8_t id, uint16_t rtt);
+    const LinkEstimator* getEstimator(uint8_t id) const;
 };
 
 
-#endif //NETWORKPROTOCOL_CONNECTIONBENCHMARKWRAPPER_H
\ No newline at end of file
+#endif //NETWORKPROTOCOL_CONNECTIONBENCHMARKWRAPPER_H
@@ -0,0 +1,90 @@
+#include "LinkEstimator.h"
+
+/**
+ * Divides and rounds to the nearest integer, so the smoothed values do not get stuck below or above the samples.
+ * @param value The dividend.
+ * @param divisor The divisor. Must be positive.
+ * @return The rounded quotient.
+ */
+static int32_t divideRounded(int32_t value, int32_t divisor) {
+    return (value >= 0 ? value + divisor / 2 : value - divisor / 2) / divisor;
+}
+
+uint8_t LinkEstimator::_bucket(uint16_t rtt) {
+    if (rtt < RTT_SKETCH_EXACT) return rtt;
+    uint8_t power = 15;
+    while (!(rtt & (UINT16_C(1) << power))) power--;
+    // two buckets per power of two, split by the next lower bit
+    uint8_t bucket = RTT_SKETCH_EXACT + (power - 3) * 2 + ((rtt >> (power - 1)) & 1);
+    return bucket < RTT_SKETCH_BUCKETS ? bucket : RTT_SKETCH_BUCKETS - 1;
+}
+
+uint16_t LinkEstimator::_upperBound(uint8_t bucket) {
+    if (bucket < RTT_SKETCH_EXACT) return bucket;
+    if (bucket == RTT_SKETCH_BUCKETS - 1) return UINT16_MAX;
+    uint8_t power = 3 + (bucket - RTT_SKETCH_EXACT) / 2;
+    uint16_t half = UINT16_C(1) << (power - 1);
+    return (UINT16_C(1) << power) + ((bucket - RTT_SKETCH_EXACT) % 2 + 1) * half - 1;
+}
+
+void LinkEstimator::_age() {
+    this->sentCount /= 2;
+    this->receivedCount /= 2;
+    for (uint16_t &count : this->sketch) count /= 2;
+}
+
+void LinkEstimator::sent() {
+    if (this->sentCount == UINT16_MAX) this->_age();
+    this->sentCount++;
+}
+
+void LinkEstimator::received(uint16_t rtt) {
+    uint8_t bucket = _bucket(rtt);
+    if (this->receivedCount == UINT16_MAX || this->sketch[bucket] == UINT16_MAX) this->_age();
+
+    if (this->receivedCount == 0 && this->smoothedRtt == 0) {
+        // the first sample sets the mean, its deviation is assumed to be half of it
+        this->smoothedRtt = static_cast<uint32_t>(rtt) << 3;
+        this->rttVariance = static_cast<uint32_t>(rtt) << 2;
+    } else {
+        // gains of 1/8 and 1/4 like the retransmission timer of TCP
+        int32_t error = (static_cast<int32_t>(rtt) << 3) - static_cast<int32_t>(this->smoothedRtt);
+        this->smoothedRtt += divideRounded(error, 8);
+        if (error < 0) error = -error;
+        this->rttVariance += divideRounded(error - static_cast<int32_t>(this->rttVariance), 4);
+    }
+
+    this->receivedCount++;
+    this->sketch[bucket]++;
+}
+
+uint16_t LinkEstimator::quantile(uint8_t percent) const {
+    uint32_t total = 0;
+    for (uint16_t count : this->sketch) total += count;
+    if (total == 0) return 0;
+
+    // rank of the quantile, at least the first round trip time
+    uint32_t rank = (total * percent + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < RTT_SKETCH_BUCKETS; bucket++) {
+        seen += this->sketch[bucket];
+        if (seen >= rank) return _upperBound(bucket);
+    }
+    return UINT16_MAX;
+}
+
+uint8_t LinkEstimator::deliveryRatio() const {
+    if (this->sentCount == 0) return 0;
+    // responses to pings sent before the counters were halved can exceed the sent pings
+    if (this->receivedCount >= this->sentCount) return 100;
+    return static_cast<uint8_t>(static_cast<uint32_t>(this->receivedCount) * 100 / this->sentCount);
+}
+
+uint32_t LinkEstimator::cost() const {
+    if (this->receivedCount == 0) return UINT32_MAX;
+    uint32_t latency = this->getRtt() + this->getRttVariance();
+    if (latency == 0) latency = 1;
+    if (this->sentCount <= this->receivedCount) return latency;
+    return latency * this->sentCount / this->receivedCount;
+}
@@ -0,0 +1,120 @@
+#ifndef NETWORKPROTOCOL_LINKESTIMATOR_H
+#define NETWORKPROTOCOL_LINKESTIMATOR_H
+#include <cstdint>
+
+#define RTT_SKETCH_EXACT 8
+#define RTT_SKETCH_BUCKETS 32
+
+/**
+ * Streaming estimate of the quality of the connection to one device, built from the round trip times of pings.
+ * The memory is constant: the smoothed round trip time and its variance are kept like the retransmission timer of TCP,
+ * the distribution in a log-linear histogram with two buckets per power of two and exact buckets below
+ * RTT_SKETCH_EXACT ms. The counters are halved before they overflow, so older pings weigh less.
+ */
+class LinkEstimator {
+
+    /**
+     * Smoothed round trip time in 1/8 ms.
+     */
+    uint32_t smoothedRtt = 0;
+
+    /**
+     * Mean deviation of the round trip time in 1/8 ms.
+     */
+    uint32_t rttVariance = 0;
+
+    /**
+     * Number of round trip times in each bucket of the histogram.
+     */
+    uint16_t sketch[RTT_SKETCH_BUCKETS] = {};
+
+    /**
+     * Number of pings sent.
+     */
+    uint16_t sentCount = 0;
+
+    /**
+     * Number of ping responses received.
+     */
+    uint16_t receivedCount = 0;
+
+    /**
+     * @param rtt A round trip time in milliseconds.
+     * @return Index of the bucket of the histogram the round trip time is counted in.
+     */
+    static uint8_t _bucket(uint16_t rtt);
+
+    /**
+     * @param bucket Index of a bucket of the histogram.
+     * @return Highest round trip time counted in the bucket.
+     */
+    static uint16_t _upperBound(uint8_t bucket);
+
+    /**
+     * Halves all counters, so they do not overflow.
+     */
+    void _age();
+
+public:
+    /**
+     * Counts a ping sent over the connection.
+     */
+    void sent();
+
+    /**
+     * Adds the round trip time of a ping response.
+     * @param rtt The round trip time in milliseconds.
+     */
+    void received(uint16_t rtt);
+
+    /**
+     * Estimates a quantile of the round trip times. The result is the upper bound of its bucket, which is less than
+     * 50 % above the real quantile for round trip times below 24 s.
+     * @param percent The quantile in percent, e.g. 95.
+     * @return The round trip time in milliseconds or 0 if no response has been received.
+     */
+    uint16_t quantile(uint8_t percent) const;
+
+    /**
+     * @return Percentage of the pings that have been answered.
+     */
+    uint8_t deliveryRatio() const;
+
+    /**
+     * Combines round trip time, jitter and losses into one score. It is the expected time until a ping is answered,
+     * if lost pings are repeated: (smoothed RTT + variance) * sent / received.
+     * @return The score in milliseconds, lower is better. UINT32_MAX if no response has been received.
+     */
+    uint32_t cost() const;
+
+    /**
+     * @return Smoothed round trip time in milliseconds.
+     */
+    uint16_t getRtt() const {
+        return static_cast<uint16_t>((this->smoothedRtt + 4) >> 3);
+    }
+
+    /**
+     * @return Mean deviation of the round trip time in milliseconds.
+     */
+    uint16_t getRttVariance() const {
+        return static_cast<uint16_t>((this->rttVariance + 4) >> 3);
+    }
+
+    /**
+     * @return Number of pings sent, halved with the other counters.
+     */
+    uint16_t getSentCount() const {
+        return this->sentCount;
+    }
+
+    /**
+     * @return Number of ping responses received, halved with the other counters.
+     */
+    uint16_t getReceivedCount() const {
+        return this->receivedCount;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_LINKESTIMATOR_H
@@ -2,18 +2,51 @@
 
 #include "Messages/messageObjects.h"
 
-bool Discovery::update(uint32_t time, Message** msg) {
+bool Discovery::update(uint32_t time, uint32_t requester, Message** msg) {
     if (this->pingFinished) return this->timer.expired(time);
 
-    *msg = new RegistrationMessage(this->nextDeviceToPing++, this->id, time, 0, time);
+    // 255 in the extra field marks the request, answers carry the hierarchy level instead
+    RegistrationMessage *request;
+    if (!this->targets.empty()) {
+        request = new RegistrationMessage(this->targets[this->nextDeviceToPing++], this->id, time, 0, 255);
+    } else if (this->broadcast) {
+        // the request is repeated, so a single lost broadcast does not hide all devices
+        request = new RegistrationMessage(DISCOVERY_CHANNEL, this->id, time, 0, 255);
+        this->nextDeviceToPing++;
+    } else {
+        request = new RegistrationMessage(this->nextDeviceToPing++, this->id, time, 0, 255);
+    }
+    request->requester = requester;
+    *msg = request;
 
-    if (this->nextDeviceToPing == 255) {
+    uint8_t requests = !this->targets.empty() ? this->targets.size() : this->broadcast ? DISCOVERY_BROADCASTS : 255;
+    if (this->nextDeviceToPing == requests) {
         this->pingFinished = true;
         this->timer.start(time);
     }
     return false;
 }
 
-void Discovery::newAnswer(uint8_t id, uint8_t level) {
-    this->foundDevices.emplace_back(id, level);
+uint32_t Discovery::nextUpdate(uint32_t time) const {
+    return this->pingFinished ? this->timer.remaining(time) : 0;
+}
+
+void Discovery::newAnswer(uint8_t id, uint8_t level, uint8_t freeSlots, uint16_t rtt) {
+    // a device answers each broadcast it receives
+    for (auto &device : this->foundDevices) {
+        if (device.id == id) {
+            device.level = level;
+            device.freeSlots = freeSlots;
+            if (rtt < device.rtt) device.rtt = rtt;
+            return;
+        }
+    }
+    this->foundDevices.push_back({id, level, freeSlots, rtt});
+}
+
+bool Discovery::answered(uint8_t id) const {
+    for (const auto &device : this->foundDevices) {
+        if (device.id == id) return true;
+    }
+    return false;
 }
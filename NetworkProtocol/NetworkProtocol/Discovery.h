@@ -7,11 +7,56 @@
 #include "timer.h"
 #include "Messages/messageObjects.h"
 
+#define DISCOVERY_CHANNEL 255
+#define DISCOVERY_BROADCASTS 2
+#define DISCOVERY_BACKOFF 20
+#define DISCOVERY_WINDOW 50
+
+/**
+ * A device that answered a discovery.
+ */
+typedef struct DiscoveredDevice {
+    /**
+     * ID of the device.
+     */
+    uint8_t id;
+
+    /**
+     * Level of the device in the hierarchy.
+     */
+    uint8_t level;
+
+    /**
+     * Number of free child slots of the device.
+     */
+    uint8_t freeSlots;
 
+    /**
+     * Round trip time of the request and the answer in milliseconds. UINT16_MAX if it is not known.
+     */
+    uint16_t rtt;
+} DiscoveredDevice;
+
+/**
+ * Discovery of the devices in range, that can become the parent of this device.
+ * By default the request is broadcast on the discovery channel and the answers, which the devices send after a random
+ * back-off, are collected for a short window. Without a broadcast capable data link layer each ID is pinged instead.
+ * A targeted discovery only asks the given devices, e.g. the cached neighbours.
+ */
 class Discovery {
 
     /**
-     * ID of the device to ping next.
+     * True if the request is broadcast, false if each ID is pinged.
+     */
+    bool broadcast;
+
+    /**
+     * Devices asked by a targeted discovery. Empty for a discovery of all devices.
+     */
+    std::vector<uint8_t> targets;
+
+    /**
+     * ID of the device to ping next, or number of broadcasts or targets sent.
      */
     uint8_t nextDeviceToPing;
 
@@ -33,33 +78,72 @@ class Discovery {
 public:
 
     /**
-     * IDs of the found device and their level in the hierarchy.
+     * The devices that answered.
      */
-    std::vector<std::pair<uint8_t, uint8_t>> foundDevices;
+    std::vector<DiscoveredDevice> foundDevices;
 
     /**
      * A new discovery is started.
-     * @param discoveryWaiting The time in ms how long the discovery waits for answers.
+     * @param discoveryWaiting The time in ms how long the discovery waits for answers. Broadcasts wait at most
+     * DISCOVERY_WINDOW, because all devices in range answer within the back-off.
      * @param deviceId ID of this device.
+     * @param broadcast True to broadcast the request on the discovery channel, false to ping each ID.
      */
-    explicit Discovery(uint16_t discoveryWaiting, uint8_t deviceId) : timer(discoveryWaiting), id(deviceId) {
+    explicit Discovery(uint16_t discoveryWaiting, uint8_t deviceId, bool broadcast = true) : broadcast(broadcast),
+        timer(broadcast && discoveryWaiting > DISCOVERY_WINDOW ? DISCOVERY_WINDOW : discoveryWaiting), id(deviceId) {
         this->nextDeviceToPing = 0;
     }
 
     /**
-     * Checks if the discovery is finished.
+     * A new targeted discovery is started, which sends one request to each of the given devices.
+     * @param discoveryWaiting The time in ms how long the discovery waits for answers, at most DISCOVERY_WINDOW.
+     * @param deviceId ID of this device.
+     * @param targets IDs of the devices to ask.
+     * @param targetCount Number of devices to ask. Must not be 0.
+     */
+    Discovery(uint16_t discoveryWaiting, uint8_t deviceId, const uint8_t *targets, uint8_t targetCount)
+        : broadcast(false), targets(targets, targets + targetCount),
+        timer(discoveryWaiting > DISCOVERY_WINDOW ? DISCOVERY_WINDOW : discoveryWaiting), id(deviceId) {
+        this->nextDeviceToPing = 0;
+    }
+
+    /**
+     * @return The devices asked by a targeted discovery, empty for a discovery of all devices.
+     */
+    const std::vector<uint8_t>& getTargets() const {
+        return this->targets;
+    }
+
+    /**
+     * Checks if the discovery is finished. Can be called several times per update to send a burst of requests.
      * @param time The current time.
+     * @param requester Temporary ID of this device, the answers to its requests carry it.
      * @param msg Message has to be sent for the discovery.
      * @return True, if discovery is finished.
      */
-    bool update(uint32_t time, Message** msg);
+    bool update(uint32_t time, uint32_t requester, Message** msg);
+
+    /**
+     * Calculates when the discovery has to be updated next.
+     * @param time The current time.
+     * @return Milliseconds until the next request has to be sent or the answers have been collected.
+     */
+    uint32_t nextUpdate(uint32_t time) const;
 
     /**
      * Got a new answer, save it.
      * @param id ID of the device, that answered.
      * @param level Level in the hierarchy of the device.
+     * @param freeSlots Number of free child slots of the device.
+     * @param rtt Round trip time of the request and the answer, UINT16_MAX if it is not known.
+     */
+    void newAnswer(uint8_t id, uint8_t level, uint8_t freeSlots, uint16_t rtt);
+
+    /**
+     * @param id ID of a device.
+     * @return True if the device has answered.
      */
-    void newAnswer(uint8_t id, uint8_t level);
+    bool answered(uint8_t id) const;
 
 };
 
@@ -0,0 +1,223 @@
+#include "checksum.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define READ_TABLE(table, index) pgm_read_byte(&(table)[index])
+#else
+#define READ_TABLE(table, index) ((table)[index])
+#define PROGMEM
+#endif
+
+/**
+ * CRC-8 of each single byte.
+ */
+static const uint8_t CRC8_TABLE[256] PROGMEM = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+};
+
+uint8_t Checksum::crc8Table(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        crc = READ_TABLE(CRC8_TABLE, crc ^ data[i]);
+    }
+    return crc;
+}
+
+#ifndef __AVR__
+
+#define CRC8_SLICES 8
+
+/**
+ * Shifts bits of zeros into a CRC-8, one bit at a time.
+ * @param crc The CRC-8.
+ * @param bits Number of bits, at most 8.
+ * @return The CRC-8 after the bits.
+ */
+static constexpr uint8_t crc8Bits(uint8_t crc, uint8_t bits) {
+    return bits == 0 ? crc : crc8Bits(static_cast<uint8_t>(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1), bits - 1);
+}
+
+/**
+ * Shifts zero bytes into a CRC-8, which multiplies it with x^(8 * zeros) modulo the polynomial.
+ * @param crc The CRC-8.
+ * @param zeros Number of zero bytes.
+ * @return The CRC-8 after the zero bytes.
+ */
+static constexpr uint8_t crc8Zeros(uint8_t crc, uint16_t zeros) {
+    return zeros == 0 ? crc : crc8Zeros(crc8Bits(crc, 8), zeros - 1);
+}
+
+/**
+ * Sequence of the indices of a table, expanded into its entries at compile time.
+ */
+template<uint16_t... indices>
+struct TableIndices {};
+
+template<uint16_t size, uint16_t... indices>
+struct MakeTableIndices : MakeTableIndices<size - 1, size - 1, indices...> {};
+
+template<uint16_t... indices>
+struct MakeTableIndices<0, indices...> {
+    typedef TableIndices<indices...> type;
+};
+
+/**
+ * Tables for slicing. Table k holds the CRC-8 of a byte followed by k zero bytes.
+ */
+typedef struct SlicingTables {
+    uint8_t table[CRC8_SLICES][256];
+} SlicingTables;
+
+/**
+ * Generates the slicing tables at compile time, so they are constant-initialized and need no guard.
+ * There is one row per slice.
+ * @return The tables.
+ */
+template<uint16_t... byte>
+static constexpr SlicingTables makeSlicingTables(TableIndices<byte...>) {
+    return {{
+        {crc8Zeros(crc8Bits(byte, 8), 0)...}, {crc8Zeros(crc8Bits(byte, 8), 1)...},
+        {crc8Zeros(crc8Bits(byte, 8), 2)...}, {crc8Zeros(crc8Bits(byte, 8), 3)...},
+        {crc8Zeros(crc8Bits(byte, 8), 4)...}, {crc8Zeros(crc8Bits(byte, 8), 5)...},
+        {crc8Zeros(crc8Bits(byte, 8), 6)...}, {crc8Zeros(crc8Bits(byte, 8), 7)...}
+    }};
+}
+
+static constexpr SlicingTables SLICING_TABLES = makeSlicingTables(MakeTableIndices<256>::type());
+
+/**
+ * Calculates the CRC-8 of a slice of bytes with one lookup per byte. The CRC is linear, so the contribution
+ * of each byte is looked up independently and only the first lookup depends on the previous CRC.
+ * The length is a template parameter, so the lookups are unrolled.
+ * @tparam length Number of bytes, 1 to CRC8_SLICES.
+ * @param crc CRC-8 of the preceding bytes.
+ * @param data The bytes.
+ * @return The CRC-8.
+ */
+template<uint8_t length>
+static inline uint8_t crc8Slice(uint8_t crc, const uint8_t *data) {
+    uint8_t result = SLICING_TABLES.table[length - 1][crc ^ data[0]];
+    for (uint8_t i = 1; i < length; i++) {
+        result ^= SLICING_TABLES.table[length - 1 - i][data[i]];
+    }
+    return result;
+}
+
+uint8_t Checksum::crc8Sliced(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0;
+    uint8_t i = 0;
+    for (; length - i >= CRC8_SLICES; i += CRC8_SLICES) {
+        crc = crc8Slice<CRC8_SLICES>(crc, data + i);
+    }
+    // the remaining bytes are one shorter slice instead of a chain of single lookups
+    switch (length - i) {
+        case 1: return crc8Slice<1>(crc, data + i);
+        case 2: return crc8Slice<2>(crc, data + i);
+        case 3: return crc8Slice<3>(crc, data + i);
+        case 4: return crc8Slice<4>(crc, data + i);
+        case 5: return crc8Slice<5>(crc, data + i);
+        case 6: return crc8Slice<6>(crc, data + i);
+        case 7: return crc8Slice<7>(crc, data + i);
+        default: return crc;
+    }
+}
+
+#endif
+
+#ifdef CHECKSUM_CLMUL
+#include <cstring>
+#include <immintrin.h>
+
+#define CLMUL_CHUNKS 32
+
+/**
+ * Reduction constant floor(x^64 / P) of the polynomial P = x^8 + x^2 + x + 1.
+ */
+#define CLMUL_BARRETT 0x0107156A166329DDULL
+
+/**
+ * x^(64 * k + 8) modulo the polynomial. A chunk of 8 bytes followed by k chunks contributes its product with this
+ * to the CRC-8.
+ */
+typedef struct ClmulPowers {
+    uint8_t power[CLMUL_CHUNKS];
+} ClmulPowers;
+
+/**
+ * Generates the powers for up to CLMUL_CHUNKS chunks at compile time.
+ * @return The powers.
+ */
+template<uint16_t... chunk>
+static constexpr ClmulPowers makeClmulPowers(TableIndices<chunk...>) {
+    return {{crc8Zeros(0x07, 8 * chunk)...}};
+}
+
+static constexpr ClmulPowers CLMUL_POWERS = makeClmulPowers(MakeTableIndices<CLMUL_CHUNKS>::type());
+
+/**
+ * Calculates the carry-less product of two polynomials of at most 64 bits.
+ * @param a The first polynomial.
+ * @param b The second polynomial.
+ * @return The product of at most 127 bits.
+ */
+__attribute__((target("pclmul")))
+static inline __m128i clmul(uint64_t a, uint64_t b) {
+    return _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(a)),
+        _mm_cvtsi64_si128(static_cast<int64_t>(b)), 0x00);
+}
+
+bool Checksum::clmulSupported() {
+    // queried on the first call instead of during the static initialization
+    static const bool supported = __builtin_cpu_supports("pclmul");
+    return supported;
+}
+
+__attribute__((target("pclmul")))
+uint8_t Checksum::crc8Clmul(const uint8_t *data, uint8_t length) {
+    if (length == 0) return 0;
+
+    // leading zero bytes do not change a CRC-8 with the initial value 0, so the first chunk is padded in front
+    uint8_t chunks = (length + 7) / 8;
+    uint8_t head = length - (chunks - 1) * 8;
+    uint64_t chunk = 0;
+    if (length >= 8) {
+        memcpy(&chunk, data, 8);
+        chunk = __builtin_bswap64(chunk) >> (64 - 8 * head);
+    } else {
+        for (uint8_t i = 0; i < head; i++) chunk = chunk << 8 | data[i];
+    }
+
+    // the chunks are independent, so their products are calculated in parallel
+    __m128i sum = clmul(chunk, CLMUL_POWERS.power[chunks - 1]);
+    for (uint8_t i = 1; i < chunks; i++) {
+        memcpy(&chunk, data + head + (i - 1) * 8, 8);
+        sum = _mm_xor_si128(sum, clmul(__builtin_bswap64(chunk), CLMUL_POWERS.power[chunks - 1 - i]));
+    }
+
+    // the sum has at most 72 bits, the ones from x^32 up are folded with x^32 modulo the polynomial
+    uint64_t low = static_cast<uint64_t>(_mm_cvtsi128_si64(sum)) & 0xFFFFFFFF;
+    uint64_t high = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(sum, 4)));
+    uint64_t folded = static_cast<uint64_t>(_mm_cvtsi128_si64(clmul(high, crc8Zeros(0x07, 3)))) ^ low;
+
+    // Barrett reduction of the remaining 48 bits: the quotient is the product with floor(x^64 / P) above x^56
+    __m128i product = clmul(folded >> 8, CLMUL_BARRETT);
+    uint64_t quotient = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(product, 7)));
+    return static_cast<uint8_t>(folded ^ static_cast<uint64_t>(_mm_cvtsi128_si64(clmul(quotient, 0x107))));
+}
+
+#endif
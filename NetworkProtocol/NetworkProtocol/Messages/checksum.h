@@ -0,0 +1,69 @@
+#ifndef NETWORKPROTOCOL_CHECKSUM_H
+#define NETWORKPROTOCOL_CHECKSUM_H
+#include <cstdint>
+
+// carry-less multiplication is selected at runtime on x86-64 processors that support it
+#if !defined(__AVR__) && defined(__x86_64__) && defined(__GNUC__)
+#define CHECKSUM_CLMUL
+#endif
+
+/**
+ * CRC-8 (polynomial 0x07, initial value 0) over the bytes of a package.
+ * On AVR only the table-driven implementation is compiled. The hub uses carry-less multiplication where the
+ * processor supports it, otherwise slicing-by-8.
+ */
+class Checksum {
+public:
+    /**
+     * Calculates the CRC-8 with the implementation selected for this platform.
+     * @param data The bytes.
+     * @param length Number of bytes.
+     * @return The CRC-8.
+     */
+    static uint8_t crc8(const uint8_t* data, uint8_t length) {
+#ifdef __AVR__
+        return crc8Table(data, length);
+#elif defined(CHECKSUM_CLMUL)
+        return clmulSupported() ? crc8Clmul(data, length) : crc8Sliced(data, length);
+#else
+        return crc8Sliced(data, length);
+#endif
+    }
+
+    /**
+     * Calculates the CRC-8 one byte at a time with a table of 256 bytes.
+     * @param data The bytes.
+     * @param length Number of bytes.
+     * @return The CRC-8.
+     */
+    static uint8_t crc8Table(const uint8_t* data, uint8_t length);
+
+#ifndef __AVR__
+    /**
+     * Calculates the CRC-8 eight bytes at a time with eight tables of 256 bytes.
+     * @param data The bytes.
+     * @param length Number of bytes.
+     * @return The CRC-8.
+     */
+    static uint8_t crc8Sliced(const uint8_t* data, uint8_t length);
+#endif
+
+#ifdef CHECKSUM_CLMUL
+    /**
+     * @return True if the processor supports carry-less multiplication.
+     */
+    static bool clmulSupported();
+
+    /**
+     * Calculates the CRC-8 eight bytes at a time with carry-less multiplications. Must only be called if
+     * clmulSupported returns true.
+     * @param data The bytes.
+     * @param length Number of bytes.
+     * @return The CRC-8.
+     */
+    static uint8_t crc8Clmul(const uint8_t* data, uint8_t length);
+#endif
+};
+
+
+#endif //NETWORKPROTOCOL_CHECKSUM_H
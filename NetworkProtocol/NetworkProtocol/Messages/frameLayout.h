@@ -0,0 +1,193 @@
+#ifndef NETWORKPROTOCOL_FRAMELAYOUT_H
+#define NETWORKPROTOCOL_FRAMELAYOUT_H
+#include <cstdint>
+#include <cstring>
+
+#define HEADER_SLOTS 3
+
+/**
+ * Converts a value to and from its byte representation in a raw package.
+ * Multi-byte values are stored in the byte order of the device.
+ * @tparam T Type of the value.
+ */
+template<typename T>
+struct FieldCodec {
+    static void write(uint8_t* position, T value) {
+        memcpy(position, &value, sizeof(T));
+    }
+
+    static T read(const uint8_t* position) {
+        T value;
+        memcpy(&value, position, sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * Flags are stored as one byte, every value except 0 is true.
+ */
+template<>
+struct FieldCodec<bool> {
+    static void write(uint8_t* position, bool value) {
+        *position = value;
+    }
+
+    static bool read(const uint8_t* position) {
+        return *position != 0;
+    }
+};
+
+/**
+ * Field of a raw package at a fixed offset.
+ * @tparam Offset Offset of the field in the raw package.
+ * @tparam T Type of the field.
+ */
+template<uint8_t Offset, typename T>
+struct PackageField {
+    typedef T Type;
+
+    /**
+     * Offset of the field in the raw package.
+     */
+    static const uint8_t offset = Offset;
+
+    /**
+     * Offset of the first byte behind the field.
+     */
+    static const uint8_t end = Offset + sizeof(T);
+
+    static void write(uint8_t* package, T value) {
+        FieldCodec<T>::write(package + Offset, value);
+    }
+
+    static T read(const uint8_t* package) {
+        return FieldCodec<T>::read(package + Offset);
+    }
+};
+
+/**
+ * Binds a field of a raw package to a member of a message class.
+ * @tparam Field The package field.
+ * @tparam Owner The message class.
+ * @tparam Member The member the field is read from and written to.
+ */
+template<typename Field, typename Owner, typename Field::Type Owner::*Member>
+struct MemberField : Field {
+    static void encode(const Owner& message, uint8_t* package) {
+        Field::write(package, message.*Member);
+    }
+
+    static void decode(Owner& message, const uint8_t* package) {
+        message.*Member = Field::read(package);
+    }
+};
+
+/**
+ * Binds a fixed number of bytes of a raw package to an array member of a message class.
+ * @tparam Offset Offset of the bytes in the raw package.
+ * @tparam Length Number of bytes.
+ * @tparam Owner The message class.
+ * @tparam Member The array the bytes are copied from and to.
+ */
+template<uint8_t Offset, uint8_t Length, typename Owner, uint8_t (Owner::*Member)[Length]>
+struct ArrayMemberField {
+    static const uint8_t offset = Offset;
+    static const uint8_t end = Offset + Length;
+
+    static void encode(const Owner& message, uint8_t* package) {
+        memcpy(package + Offset, message.*Member, Length);
+    }
+
+    static void decode(Owner& message, const uint8_t* package) {
+        memcpy(message.*Member, package + Offset, Length);
+    }
+};
+
+/**
+ * Binds a fixed number of bytes of a raw package to a pointer member of a message class.
+ * Decoding does not copy, the member points into the raw package afterwards.
+ * @tparam Offset Offset of the bytes in the raw package.
+ * @tparam Length Number of bytes.
+ * @tparam Owner The message class.
+ * @tparam Member The pointer to the bytes.
+ */
+template<uint8_t Offset, uint8_t Length, typename Owner, const uint8_t* Owner::*Member>
+struct ViewMemberField {
+    static const uint8_t offset = Offset;
+    static const uint8_t end = Offset + Length;
+
+    static void encode(const Owner& message, uint8_t* package) {
+        memcpy(package + Offset, message.*Member, Length);
+    }
+
+    static void decode(Owner& message, const uint8_t* package) {
+        message.*Member = package + Offset;
+    }
+};
+
+/**
+ * Wire layout of a message type behind the standard meta data.
+ * The encoder and decoder are generated from the list of fields and inline to fixed-offset loads and stores.
+ * @tparam Fields The member fields of the message type.
+ */
+template<typename... Fields>
+struct FrameLayout;
+
+template<>
+struct FrameLayout<> {
+    /**
+     * Offset of the first byte behind all fields.
+     */
+    static const uint8_t end = HEADER_SLOTS;
+
+    template<typename Owner>
+    static void encode(const Owner&, uint8_t*) {}
+
+    template<typename Owner>
+    static void decode(Owner&, const uint8_t*) {}
+};
+
+template<typename Field, typename... Rest>
+struct FrameLayout<Field, Rest...> {
+    static const uint8_t end = Field::end > FrameLayout<Rest...>::end ? Field::end : FrameLayout<Rest...>::end;
+
+    /**
+     * Writes all fields of the message into the raw package.
+     * @param message The message.
+     * @param package The raw package.
+     */
+    template<typename Owner>
+    static void encode(const Owner& message, uint8_t* package) {
+        Field::encode(message, package);
+        FrameLayout<Rest...>::encode(message, package);
+    }
+
+    /**
+     * Reads all fields of the message from the raw package.
+     * @param message The message.
+     * @param package The raw package.
+     */
+    template<typename Owner>
+    static void decode(Owner& message, const uint8_t* package) {
+        Field::decode(message, package);
+        FrameLayout<Rest...>::decode(message, package);
+    }
+};
+
+/**
+ * Standard meta data of all messages.
+ */
+typedef PackageField<0, uint8_t> VersionField;
+typedef PackageField<1, uint8_t> ReceiverField;
+typedef PackageField<2, uint8_t> GroupTypeField;
+
+/**
+ * Meta data of data messages.
+ */
+typedef PackageField<3, uint8_t> PackageNumberField;
+typedef PackageField<4, uint8_t> OriginField;
+typedef PackageField<5, uint16_t> MessageIDField;
+typedef PackageField<7, uint8_t> TotalPackagesField;
+typedef PackageField<8, uint8_t> LastPackageSizeField;
+
+#endif //NETWORKPROTOCOL_FRAMELAYOUT_H
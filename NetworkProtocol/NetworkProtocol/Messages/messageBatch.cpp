@@ -0,0 +1,84 @@
+#include "messageBatch.h"
+
+#include <new>
+
+bool DecodedMessage::decode(const uint8_t *rawPackage) {
+    this->clear();
+
+    if (!Message::verifyChecksum(rawPackage)) return false;
+
+    switch (Message::typeOf(rawPackage)) {
+        case 0: new (&this->data) PartialDataMessage(rawPackage); break;
+        case 1: new (&this->registration) RegistrationMessage(rawPackage); break;
+        case 2: new (&this->ping) PingMessage(rawPackage); break;
+        case 3: new (&this->addRemoveToGroup) AddRemoveToGroupMessage(rawPackage); break;
+        case 4: new (&this->error) ErrorMessage(rawPackage); break;
+        case 5: new (&this->reDisconnect) ReDisconnectMessage(rawPackage); break;
+        case 6: new (&this->ack) AckMessage(rawPackage); break;
+        case 7: new (&this->groupSummary) GroupSummaryMessage(rawPackage); break;
+        case 8: new (&this->aggregate) AggregateMessage(rawPackage); break;
+        default: return false;
+    }
+    this->type = Message::typeOf(rawPackage);
+    return true;
+}
+
+void DecodedMessage::clear() {
+    Message *message = this->get();
+    if (message != nullptr) {
+        message->~Message();
+    }
+    this->type = NO_MESSAGE_TYPE;
+}
+
+Message *DecodedMessage::get() {
+    switch (this->type) {
+        case 0: return &this->data;
+        case 1: return &this->registration;
+        case 2: return &this->ping;
+        case 3: return &this->addRemoveToGroup;
+        case 4: return &this->error;
+        case 5: return &this->reDisconnect;
+        case 6: return &this->ack;
+        case 7: return &this->groupSummary;
+        case 8: return &this->aggregate;
+        default: return nullptr;
+    }
+}
+
+void MessageBatch::decodeHeaders(const uint8_t *packages, uint16_t numberPackages,
+    uint8_t *receivers, uint8_t *types, bool *groups) {
+    for (uint16_t i = 0; i < numberPackages; i++) {
+        const uint8_t *package = packages + i * PACKAGE_SIZE;
+        uint8_t groupType = GroupTypeField::read(package);
+        receivers[i] = ReceiverField::read(package);
+        types[i] = groupType >> 1;
+        groups[i] = groupType & 1;
+    }
+}
+
+uint16_t MessageBatch::decode(const uint8_t *packages, uint16_t numberPackages, DecodedMessage *messages) {
+    uint16_t numberDecoded = 0;
+    for (uint16_t i = 0; i < numberPackages; i++) {
+        numberDecoded += messages[i].decode(packages + i * PACKAGE_SIZE);
+    }
+    return numberDecoded;
+}
+
+uint16_t MessageBatch::encode(Message **messages, uint16_t numberMessages, uint8_t *packages, uint16_t maxPackages,
+    uint16_t *numberEncoded) {
+    uint16_t numberPackages = 0;
+    uint16_t i = 0;
+
+    for (; i < numberMessages; i++) {
+        uint8_t messagePackages = messages[i]->getNumberPackages();
+        if (numberPackages + messagePackages > maxPackages) break;
+
+        numberPackages += messages[i]->writeRawPackages(packages + numberPackages * PACKAGE_SIZE);
+    }
+
+    if (numberEncoded != nullptr) {
+        *numberEncoded = i;
+    }
+    return numberPackages;
+}
@@ -0,0 +1,109 @@
+#ifndef NETWORKPROTOCOL_MESSAGEBATCH_H
+#define NETWORKPROTOCOL_MESSAGEBATCH_H
+#include <cstdint>
+
+#include "messageObjects.h"
+
+#define NO_MESSAGE_TYPE 0xFF
+
+/**
+ * A decoded message stored in place, without heap memory. Holds one of the message types that can be received.
+ * Error messages point into the raw package they have been decoded from, so it must outlive them.
+ */
+class DecodedMessage {
+public:
+    /**
+     * Type of the held message. NO_MESSAGE_TYPE if no message is held.
+     */
+    uint8_t type;
+
+    union {
+        PartialDataMessage data;
+        RegistrationMessage registration;
+        PingMessage ping;
+        AddRemoveToGroupMessage addRemoveToGroup;
+        ErrorMessage error;
+        ReDisconnectMessage reDisconnect;
+        AckMessage ack;
+        GroupSummaryMessage groupSummary;
+        AggregateMessage aggregate;
+    };
+
+    /**
+     * Creates an empty decoded message.
+     */
+    DecodedMessage() : type(NO_MESSAGE_TYPE) {}
+
+    /**
+     * Decodes the given raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit DecodedMessage(const uint8_t* rawPackage) : type(NO_MESSAGE_TYPE) {
+        this->decode(rawPackage);
+    }
+
+    ~DecodedMessage() {
+        this->clear();
+    }
+
+    DecodedMessage(const DecodedMessage&) = delete;
+    DecodedMessage& operator=(const DecodedMessage&) = delete;
+
+    /**
+     * Replaces the held message by the message of the given raw package.
+     * @param rawPackage The raw package of the message.
+     * @return False if the message type is unknown or the checksum is wrong, then no message is held.
+     */
+    bool decode(const uint8_t* rawPackage);
+
+    /**
+     * Destroys the held message.
+     */
+    void clear();
+
+    /**
+     * @return The held message or nullptr if no message is held.
+     */
+    Message* get();
+};
+
+/**
+ * Functions to encode and decode many packages in one call, e.g. for bursts of a gateway.
+ */
+class MessageBatch {
+public:
+    /**
+     * Reads the standard meta data of packages lying in a row. The loop has no branches, so it can be vectorized.
+     * @param packages The raw packages, each PACKAGE_SIZE bytes.
+     * @param numberPackages Number of packages.
+     * @param receivers Array of numberPackages receivers, that is filled.
+     * @param types Array of numberPackages message types, that is filled.
+     * @param groups Array of numberPackages group flags, that is filled.
+     */
+    static void decodeHeaders(const uint8_t* packages, uint16_t numberPackages,
+        uint8_t* receivers, uint8_t* types, bool* groups);
+
+    /**
+     * Decodes packages lying in a row.
+     * @param packages The raw packages, each PACKAGE_SIZE bytes.
+     * @param numberPackages Number of packages.
+     * @param messages Array of numberPackages decoded messages, that is filled.
+     * @return Number of packages with a known message type and a correct checksum.
+     */
+    static uint16_t decode(const uint8_t* packages, uint16_t numberPackages, DecodedMessage* messages);
+
+    /**
+     * Encodes messages into packages lying in a row. Stops before the first message that does not fit completely.
+     * @param messages The messages to encode.
+     * @param numberMessages Number of messages.
+     * @param packages Buffer for the raw packages.
+     * @param maxPackages Number of packages that fit into the buffer.
+     * @param numberEncoded If not null, the number of encoded messages is written into it.
+     * @return Number of packages written.
+     */
+    static uint16_t encode(Message** messages, uint16_t numberMessages, uint8_t* packages, uint16_t maxPackages,
+        uint16_t* numberEncoded = nullptr);
+};
+
+
+#endif //NETWORKPROTOCOL_MESSAGEBATCH_H
@@ -1,67 +1,175 @@
 
 #include "messageBuilder.h"
 
-#include <iostream>
-#include <ostream>
-
 #include "messageObjects.h"
 
-bool MessageBuilder::newDataMessage(PartialDataMessage *message, DataMessage *result) {
+ReassemblySlot *MessageBuilder::_findSlot(uint8_t origin, uint16_t messageID, uint32_t time) {
+    ReassemblySlot *freeSlot = nullptr;
+    ReassemblySlot *leastRecentSlot = nullptr;
+    uint32_t leastRecentElapsed = 0;
 
     // messages are identified by origin and message ID
-    std::pair<uint8_t, uint16_t> key = std::pair<uint8_t, uint16_t>(message->origin, message->messageID);
+    for (uint8_t i = 0; i < this->numberSlots; i++) {
+        ReassemblySlot *slot = &this->slots[i];
+        if (!slot->used) {
+            if (freeSlot == nullptr) freeSlot = slot;
+            continue;
+        }
+        if (slot->origin == origin && slot->messageID == messageID) {
+            return slot;
+        }
 
-    // if no package of the message has been received yet, create a new entry
-    if (this->partialDatas.find(key) == this->partialDatas.end()) {
-        this->partialDatas.insert(std::pair<std::pair<uint8_t, uint16_t>,
-            std::vector<PartialDataMessage*>>(key, std::vector<PartialDataMessage*>()));
+        uint32_t elapsed = Timer::elapsed(slot->timer.startTime, time);
+        if (leastRecentSlot == nullptr || elapsed > leastRecentElapsed) {
+            leastRecentSlot = slot;
+            leastRecentElapsed = elapsed;
+        }
     }
 
-    std::vector<PartialDataMessage*>* partialDatas = &this->partialDatas.at(key);
+    // if all slots are in use, drop the message that has not been updated for the longest time
+    if (freeSlot == nullptr) {
+        freeSlot = leastRecentSlot;
+        ++this->evictedCount;
+    }
 
-    // add the message to the list of partial messages
-    partialDatas->push_back(message);
+    // no package of the message has been received yet
+    freeSlot->used = true;
+    freeSlot->origin = origin;
+    freeSlot->messageID = messageID;
+    freeSlot->numberPackages = 0;
+    freeSlot->timer = Timer(this->timeout);
+    memset(freeSlot->receivedPackages, 0, sizeof(freeSlot->receivedPackages));
+    return freeSlot;
+}
+
+bool MessageBuilder::_addPackage(uint8_t receiver, bool group, uint8_t packageNumber, uint16_t messageID,
+    uint8_t origin, const uint8_t *content, DataMessage *result, uint32_t time) {
+
+    // the sizes in the first package come from the wire, a wrong size must not make the copy read behind the slot
+    if (packageNumber == 0) {
+        uint8_t numberPackages = content[0];
+        uint8_t lastPackageSize = content[1];
+        uint8_t maxSize = numberPackages == 1 ? FIRST_DATA_PACKAGE_SLOTS : DATA_SLOTS;
+        if (numberPackages == 0 || lastPackageSize == 0 || lastPackageSize > maxSize) return false;
+    }
 
-    if (message->packageNumber == 0) {
-        // first package has information about the number of packages
-        this->numPackages.insert(std::pair<std::pair<uint8_t, uint16_t>, uint8_t>(key, message->content[0]));
-    } else if (this->numPackages.find(key) == this->numPackages.end()) {
-        // first package has not arrived yet
+    // a retransmitted package of a message that has already been completed must not start a new message
+    if (this->_isCompleted(origin, messageID, time)) {
+        ++this->duplicateCount;
         return false;
     }
 
-    // check if all packages have arrived
-    if (partialDatas->size() != this->numPackages.at(key)) {
+    ReassemblySlot *slot = this->_findSlot(origin, messageID, time);
+    slot->timer.start(time);
+
+    // package numbers behind the last package are invalid
+    if (slot->numberPackages != 0 && packageNumber >= slot->numberPackages) return false;
+
+    uint32_t packageBit = static_cast<uint32_t>(1) << (packageNumber % 32);
+    if (slot->receivedPackages[packageNumber / 32] & packageBit) {
+        ++this->duplicateCount;
+        return false;
+    }
+
+    slot->receiver = receiver;
+    slot->group = group;
+
+    // copy the content directly to its final position
+    if (packageNumber == 0) {
+        // first package has information about the number of packages and the size of the last package
+        // and has less content
+        slot->numberPackages = content[0];
+        slot->lastPackageSize = content[1];
+        memcpy(slot->content, content + FIRST_METADATA_SLOTS, FIRST_DATA_PACKAGE_SLOTS);
+        // invalid packages behind the last package may have arrived before the count was known
+        _clearFrom(slot->receivedPackages, slot->numberPackages);
+    } else {
+        memcpy(slot->content + SLOT_COUNT(packageNumber), content, DATA_SLOTS);
+    }
+    slot->receivedPackages[packageNumber / 32] |= packageBit;
+
+    // check if all packages have arrived, as long as the first package is missing the number is unknown
+    if (slot->numberPackages == 0 || _countReceived(slot->receivedPackages) != slot->numberPackages) {
         return false;
     }
 
-    uint8_t size = SLOT_COUNT(this->numPackages.at(key));
+    uint16_t size = slot->lastPackageSize;
+    if (slot->numberPackages > 1) {
+        size += SLOT_COUNT(slot->numberPackages - 1);
+    }
 
-    result->receiver = message->receiver;
-    result->group = message->group;
-    result->messageID = message->messageID;
-    result->origin = message->origin;
+    result->receiver = slot->receiver;
+    result->group = slot->group;
+    result->messageID = slot->messageID;
+    result->origin = slot->origin;
     result->content = new uint8_t[size];
     result->contentSize = size;
+    memcpy(result->content, slot->content, size);
 
-    // assemble the content of the message
-    // iterate through packages to find the next package in order
-    for (uint8_t i = 0; i < partialDatas->size(); i++) {
-        PartialDataMessage *partialData = partialDatas->at(i);
+    slot->used = false;
 
-        if (partialDatas->at(i)->packageNumber == 0) {
-            // first package saves data and has less content
-            memcpy(result->content, partialData->content + FIRST_METADATA_SLOTS, FIRST_DATA_PACKAGE_SLOTS);
+    CompletedMessage *completedMessage = &this->completed[this->nextCompleted];
+    completedMessage->used = true;
+    completedMessage->origin = origin;
+    completedMessage->messageID = messageID;
+    completedMessage->timer = Timer(this->timeout, time);
+    this->nextCompleted = (this->nextCompleted + 1) % COMPLETED_HISTORY;
+
+    return true;
+}
+
+bool MessageBuilder::_isCompleted(uint8_t origin, uint16_t messageID, uint32_t time) {
+    for (CompletedMessage &message : this->completed) {
+        if (message.used && message.origin == origin && message.messageID == messageID) {
+            if (message.timer.expired(time)) {
+                message.used = false;
+                return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void MessageBuilder::_clearFrom(uint32_t *bitmap, uint16_t first) {
+    for (uint16_t word = first / 32; word < MAX_PACKAGES / 32; word++) {
+        if (word == first / 32 && first % 32 != 0) {
+            bitmap[word] &= (UINT32_C(1) << (first % 32)) - 1;
         } else {
-            memcpy(result->content + SLOT_COUNT(partialDatas->at(i)->packageNumber), partialData->content, DATA_SLOTS);
+            bitmap[word] = 0;
         }
+    }
+}
 
-        delete partialData;
+uint16_t MessageBuilder::_countReceived(const uint32_t *bitmap) {
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < MAX_PACKAGES / 32; i++) {
+        uint32_t bits = bitmap[i];
+        bits = bits - ((bits >> 1) & 0x55555555);
+        bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+        count += (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
     }
+    return count;
+}
 
-    this->partialDatas.erase(key);
-    this->numPackages.erase(key);
+bool MessageBuilder::newDataMessage(const PartialDataMessage *message, DataMessage *result, uint32_t time) {
+    return this->_addPackage(message->receiver, message->group, message->packageNumber, message->messageID,
+        message->origin, message->content, result, time);
+}
 
-    return true;
+bool MessageBuilder::newDataMessage(const uint8_t *rawPackage, DataMessage *result, uint32_t time) {
+    return this->_addPackage(Message::receiverOf(rawPackage), Message::isGroupPackage(rawPackage),
+        PackageNumberField::read(rawPackage), MessageIDField::read(rawPackage), OriginField::read(rawPackage),
+        rawPackage + METADATA_SLOTS, result, time);
 }
 
+void MessageBuilder::update(uint32_t time) {
+    for (uint8_t i = 0; i < this->numberSlots; i++) {
+        ReassemblySlot *slot = &this->slots[i];
+        if (!slot->used || !slot->timer.expired(time)) continue;
+
+        // a package of the message has been lost
+        slot->used = false;
+        ++this->expiredCount;
+    }
+}
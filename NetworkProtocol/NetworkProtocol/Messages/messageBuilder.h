@@ -1,39 +1,287 @@
 #ifndef MESSAGEBUILDER_H
 #define MESSAGEBUILDER_H
+#include <cstddef>
 #include <cstdint>
-#include <map>
 
 #include "messageObjects.h"
+#include "../timer.h"
+
+#define MAX_PACKAGES 256
+#define REASSEMBLY_BUFFER_SIZE (MAX_PACKAGES * DATA_SLOTS)
+#define REASSEMBLY_SLOTS 4
+#define REASSEMBLY_TIMEOUT 5000
+#define COMPLETED_HISTORY 8
+#define REASSEMBLY_MEMORY (REASSEMBLY_SLOTS * sizeof(ReassemblySlot))
+
+/**
+ * State of one data message that is being reassembled.
+ */
+typedef struct ReassemblySlot {
+    /**
+     * True if a message is being reassembled in this slot.
+     */
+    bool used;
+
+    /**
+     * Device that created the message.
+     */
+    uint8_t origin;
+
+    /**
+     * ID of the message.
+     */
+    uint16_t messageID;
+
+    /**
+     * Receiver of the message.
+     */
+    uint8_t receiver;
+
+    /**
+     * True if the message is addressed to a group.
+     */
+    bool group;
+
+    /**
+     * Total number of packages of the message. 0 as long as the first package has not arrived.
+     */
+    uint8_t numberPackages;
+
+    /**
+     * Number of content bytes in the last package. Only valid once the first package has arrived.
+     */
+    uint8_t lastPackageSize;
+
+    /**
+     * Timer restarted with every received package. The message is dropped when it expires.
+     */
+    Timer timer;
+
+    /**
+     * Bitmap of the received package numbers.
+     */
+    uint32_t receivedPackages[MAX_PACKAGES / 32];
+
+    /**
+     * Content of the message. Each package is copied directly to its final offset.
+     */
+    uint8_t content[REASSEMBLY_BUFFER_SIZE];
+} ReassemblySlot;
+
+/**
+ * Identifies a recently completed data message, so late duplicates of its packages can be dropped.
+ */
+typedef struct CompletedMessage {
+    /**
+     * True if this entry holds a completed message.
+     */
+    bool used;
+
+    /**
+     * Device that created the message.
+     */
+    uint8_t origin;
+
+    /**
+     * ID of the message.
+     */
+    uint16_t messageID;
+
+    /**
+     * Started when the message has been completed. Duplicates are only expected until it expires.
+     */
+    Timer timer;
+} CompletedMessage;
 
 /**
  * Class for building data messages.
+ * Uses a fixed number of preallocated slots, so receiving packages does not allocate memory.
  */
 class MessageBuilder {
 private:
     /**
-     * Map of partial data messages.
-     * Key: (lastDevice, timestamp)
-     * Value: The partial data message.
+     * Slots for the messages that are being reassembled.
+     */
+    ReassemblySlot* slots;
+
+    /**
+     * Number of slots.
+     */
+    uint8_t numberSlots;
+
+    /**
+     * Time after the last received package until an incomplete message is dropped.
+     */
+    uint16_t timeout;
+
+    /**
+     * Number of incomplete messages dropped, because their timer expired.
+     */
+    uint32_t expiredCount;
+
+    /**
+     * Number of incomplete messages dropped, because their slot was needed for a new message.
+     */
+    uint32_t evictedCount;
+
+    /**
+     * Number of packages dropped, because they have already been received.
+     */
+    uint32_t duplicateCount;
+
+    /**
+     * Ring buffer of the last completed messages.
+     */
+    CompletedMessage completed[COMPLETED_HISTORY];
+
+    /**
+     * Index in the ring buffer of completed messages that is overwritten next.
+     */
+    uint8_t nextCompleted;
+
+    /**
+     * Checks if the given message has been completed recently.
+     * @param origin Device that created the message.
+     * @param messageID ID of the message.
+     * @param time The current time.
+     * @return True if the message has been completed and its timer has not expired yet.
+     */
+    bool _isCompleted(uint8_t origin, uint16_t messageID, uint32_t time);
+
+    /**
+     * Finds the slot of the given message or a slot for it.
+     * If all slots are in use, the least recently updated message is evicted.
+     * @param origin Device that created the message.
+     * @param messageID ID of the message.
+     * @param time The current time.
+     * @return The slot.
+     */
+    ReassemblySlot* _findSlot(uint8_t origin, uint16_t messageID, uint32_t time);
+
+    /**
+     * Copies a package into its slot and assembles the message if it is complete.
+     * @param receiver Receiver of the message.
+     * @param group True if the message is addressed to a group.
+     * @param packageNumber Number of the package.
+     * @param messageID ID of the message.
+     * @param origin Device that created the message.
+     * @param content The DATA_SLOTS bytes of content of the package.
+     * @param result The completed data message.
+     * @param time The current time.
+     * @return True if the message is complete and a new data message has been created.
      */
-    std::map<std::pair<uint8_t, uint16_t>, std::vector<PartialDataMessage*>> partialDatas;
+    bool _addPackage(uint8_t receiver, bool group, uint8_t packageNumber, uint16_t messageID, uint8_t origin,
+        const uint8_t* content, DataMessage* result, uint32_t time);
 
     /**
-     * Map of the number of packages of a data message.
-     * Key: (lastDevice, timestamp)
-     * Value: The number of packages.
+     * Clears the bits of a bitmap of received packages from the given package number on.
+     * @param bitmap The bitmap.
+     * @param first Number of the first package to clear.
      */
-    std::map<std::pair<uint8_t, uint16_t>, uint8_t> numPackages;
+    static void _clearFrom(uint32_t* bitmap, uint16_t first);
+
+    /**
+     * Counts the set bits of a bitmap of received packages.
+     * @param bitmap The bitmap.
+     * @return Number of received packages.
+     */
+    static uint16_t _countReceived(const uint32_t* bitmap);
 
 public:
+    /**
+     * Allocates the slots for reassembling messages. Each slot takes about REASSEMBLY_BUFFER_SIZE bytes,
+     * so the number of slots caps the memory used, see slotsForMemory.
+     * @param numberSlots Maximum number of messages that are reassembled at the same time.
+     * @param timeout Time after the last received package until an incomplete message is dropped.
+     */
+    explicit MessageBuilder(uint8_t numberSlots = REASSEMBLY_SLOTS, uint16_t timeout = REASSEMBLY_TIMEOUT)
+        : numberSlots(numberSlots), timeout(timeout), expiredCount(0), evictedCount(0), duplicateCount(0),
+        completed(), nextCompleted(0) {
+        this->slots = new ReassemblySlot[numberSlots];
+        for (uint8_t i = 0; i < numberSlots; i++) {
+            this->slots[i].used = false;
+        }
+        for (CompletedMessage &message : this->completed) {
+            message.used = false;
+        }
+    }
+
+    ~MessageBuilder() {
+        delete[] this->slots;
+    }
+
+    MessageBuilder(const MessageBuilder&) = delete;
+    MessageBuilder& operator=(const MessageBuilder&) = delete;
+
+    /**
+     * Calculates the number of slots that fit into the given memory.
+     * @param maxMemory Maximum memory in bytes used for reassembling messages.
+     * @return Number of slots, at least one.
+     */
+    static uint8_t slotsForMemory(size_t maxMemory) {
+        size_t numberSlots = maxMemory / sizeof(ReassemblySlot);
+        if (numberSlots < 1) return 1;
+        if (numberSlots > 255) return 255;
+        return numberSlots;
+    }
+
     /**
      * A new partial data message has been received.
-     * This function checks if the message is complete, and if so, creates a new data message.
-     * The resulting message might have trailing zeros.
-     * @param message The received message.
+     * This function checks if the message is complete, and if so, creates a new data message
+     * with the exact content size of the sent message.
+     * Packages may arrive in any order. Packages that have already been received, also of recently completed
+     * messages, are dropped.
+     * If all slots are in use by other messages, the least recently updated message is dropped.
+     * @param message The received message. Its content is copied, so it is still owned by the caller.
      * @param result The completed data message.
+     * @param time The current time.
      * @return True if the message is complete and a new data message has been created.
      */
-    bool newDataMessage(PartialDataMessage* message, DataMessage* result);
+    bool newDataMessage(const PartialDataMessage* message, DataMessage* result, uint32_t time);
+
+    /**
+     * A new package of a data message has been received.
+     * Same as newDataMessage, but copies the content directly from the raw package.
+     * @param rawPackage The received raw package.
+     * @param result The completed data message.
+     * @param time The current time.
+     * @return True if the message is complete and a new data message has been created.
+     */
+    bool newDataMessage(const uint8_t* rawPackage, DataMessage* result, uint32_t time);
+
+    /**
+     * Drops all incomplete messages whose timer has expired.
+     * @param time The current time.
+     */
+    void update(uint32_t time);
+
+    /**
+     * @return Time after the last received package until an incomplete message is dropped.
+     */
+    uint16_t getTimeout() const {
+        return this->timeout;
+    }
+
+    /**
+     * @return Number of incomplete messages dropped, because their timer expired.
+     */
+    uint32_t getExpiredCount() const {
+        return this->expiredCount;
+    }
+
+    /**
+     * @return Number of incomplete messages dropped, because their slot was needed for a new message.
+     */
+    uint32_t getEvictedCount() const {
+        return this->evictedCount;
+    }
+
+    /**
+     * @return Number of packages dropped, because they have already been received.
+     */
+    uint32_t getDuplicateCount() const {
+        return this->duplicateCount;
+    }
 
 };
 
@@ -11,35 +11,84 @@ uint8_t Message::getGroupTypeByte() {
     return byte;
 }
 
+Message::Message(const uint8_t* rawPackage) :
+    version(VersionField::read(rawPackage)), receiver(ReceiverField::read(rawPackage)),
+    group(CHECK_BIT(GroupTypeField::read(rawPackage), 0)) {
+}
+
+PartialDataMessage::PartialDataMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    PartialDataLayout::decode(*this, rawPackage);
+}
+
+RegistrationMessage::RegistrationMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    RegistrationLayout::decode(*this, rawPackage);
+}
+
+PingMessage::PingMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    PingLayout::decode(*this, rawPackage);
+}
+
+AddRemoveToGroupMessage::AddRemoveToGroupMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    AddRemoveToGroupLayout::decode(*this, rawPackage);
+}
+
+ErrorMessage::ErrorMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    ErrorLayout::decode(*this, rawPackage);
+}
+
+ReDisconnectMessage::ReDisconnectMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    ReDisconnectLayout::decode(*this, rawPackage);
+}
+
+AckMessage::AckMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    AckLayout::decode(*this, rawPackage);
+}
+
+GroupSummaryMessage::GroupSummaryMessage(const uint8_t* rawPackage) : Message(rawPackage) {
+    GroupSummaryLayout::decode(*this, rawPackage);
+}
+
+AggregateMessage::AggregateMessage(const uint8_t* rawPackage) : Message(rawPackage), size(0), count(0) {
+    AggregateLayout::decode(*this, rawPackage);
+
+    uint8_t package[PACKAGE_SIZE];
+    uint8_t offset = 0;
+    while (unpack(rawPackage, &offset, package)) {
+        this->size = offset;
+        ++this->count;
+    }
+}
+
 Message *Message::fromRawBytes(const uint8_t *rawPackage) {
-    uint8_t type = rawPackage[2] >> 1;
+    if (!verifyChecksum(rawPackage)) return nullptr;
 
-    switch (type) {
+    switch (typeOf(rawPackage)) {
         case 0: {
-            uint16_t id = 0;
-            memcpy(&id, rawPackage + 5, 2);
-            return new PartialDataMessage(rawPackage[1], CHECK_BIT(rawPackage[2], 0), rawPackage[3], id,
-                rawPackage[4], rawPackage + METADATA_SLOTS);
+            return new PartialDataMessage(rawPackage);
         }
         case 1: {
-            uint8_t newDeviceId = rawPackage[4];
-            uint32_t id = 0;
-            memcpy(&id, rawPackage + 5, 4);
-            return new RegistrationMessage(rawPackage[1], newDeviceId, id, rawPackage[3], static_cast<bool>(rawPackage[9]));
+            return new RegistrationMessage(rawPackage);
         }
         case 2: {
-            uint32_t timestamp = 0;
-            memcpy(&timestamp, rawPackage + 6, 4);
-            return new PingMessage(rawPackage[1], rawPackage[4], rawPackage[3], rawPackage[5], timestamp);
+            return new PingMessage(rawPackage);
         }
         case 3: {
-            return new AddRemoveToGroupMessage(rawPackage[1], rawPackage[4], rawPackage[3]);
+            return new AddRemoveToGroupMessage(rawPackage);
         }
         case 4: {
-            return new ErrorMessage(rawPackage[1], rawPackage[3], rawPackage + 4);
+            return new ErrorMessage(rawPackage);
         }
         case 5: {
-            return new ReDisconnectMessage(rawPackage[1], rawPackage[3]);
+            return new ReDisconnectMessage(rawPackage);
+        }
+        case 6: {
+            return new AckMessage(rawPackage);
+        }
+        case 7: {
+            return new GroupSummaryMessage(rawPackage);
+        }
+        case 8: {
+            return new AggregateMessage(rawPackage);
         }
         default: {
             break;
@@ -48,16 +97,24 @@ Message *Message::fromRawBytes(const uint8_t *rawPackage) {
     return nullptr;
 }
 
-uint8_t Message::getRawPackages(uint8_t** data) {
-    auto *rawPackage = new uint8_t[32] {
-        this->version,
-        this->receiver,
-        this->getGroupTypeByte()
-    };
+void Message::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    VersionField::write(package, this->version);
+    ReceiverField::write(package, this->receiver);
+    GroupTypeField::write(package, this->getGroupTypeByte());
+    memset(package + HEADER_SLOTS, 0, CHECKED_SLOTS - HEADER_SLOTS);
+}
 
-    *data = rawPackage;
+uint8_t Message::writeRawPackages(uint8_t* packages) {
+    uint8_t numberPackages = this->getNumberPackages();
+    for (uint8_t i = 0; i < numberPackages; i++) {
+        this->writeRawPackage(packages + i * PACKAGE_SIZE, i);
+    }
+    return numberPackages;
+}
 
-    return 1;
+uint8_t Message::getRawPackages(uint8_t** data) {
+    *data = new uint8_t[this->getNumberPackages() * PACKAGE_SIZE];
+    return this->writeRawPackages(*data);
 }
 
 void Message::cleanUp(const uint8_t* packages) {
@@ -65,91 +122,125 @@ void Message::cleanUp(const uint8_t* packages) {
 }
 
 
-uint8_t DataMessage::getRawPackages(uint8_t** data) {
-
-    // first package has 24 slots, all others 25
-    // if 25 slots are used: 25 / 25 + 1 = 1 + 1 = 2
-    uint8_t numberPackages = (this->contentSize + FIRST_METADATA_SLOTS - 1) / DATA_SLOTS + 1;
+uint8_t DataMessage::getNumberPackages() {
+    // first package has 22 slots, all others 24
+    // if 23 slots are used: (23 + 1) / 24 + 1 = 1 + 1 = 2
+    return (this->contentSize + FIRST_METADATA_SLOTS - 1) / DATA_SLOTS + 1;
+}
 
-    // set up the metadata of the message using the base function
-    // use the created package as a template
-    uint8_t *templatePackageAddress[1];
-    Message::getRawPackages(templatePackageAddress);
-    uint8_t* templatePackage = *templatePackageAddress;
+void DataMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, packageNumber);
 
     // set meta data that does not differ between the packages
-    templatePackage[4] = this->origin;
-    memcpy(templatePackage + 5, &this->messageID, 2);
-
-    // raw packages for the data returned
-    auto* rawPackages = new uint8_t[numberPackages * 32];
-    *data = rawPackages;
+    DataLayout::encode(*this, package);
+    PackageNumberField::write(package, packageNumber);
+
+    uint8_t extraMetaDataSize = 0;
+    uint16_t startingIndex = SLOT_COUNT(packageNumber);
+
+    // first package saves total number of packages and the content size of the last package
+    if (packageNumber == 0) {
+        uint8_t numberPackages = this->getNumberPackages();
+        TotalPackagesField::write(package, numberPackages);
+        LastPackageSizeField::write(package,
+            this->contentSize - (numberPackages == 1 ? 0 : SLOT_COUNT(numberPackages - 1)));
+        extraMetaDataSize = FIRST_METADATA_SLOTS;
+        startingIndex = 0;
+    }
 
     // the last package is not completely filled
-    // remove 24 for first package and 25 for all other packages beside the last
-    uint8_t lastPackageSize = this->contentSize -
-        (numberPackages == 1 ? 0 : SLOT_COUNT(numberPackages - 1) - 2);
+    uint16_t slots = DATA_SLOTS - extraMetaDataSize;
+    if (this->contentSize - startingIndex < slots) {
+        slots = this->contentSize - startingIndex;
+    }
 
-    for (uint8_t i = 0; i < numberPackages; i++) {
-        // create a new raw package, copy the metadata from the template and set the package number
-        auto *package = rawPackages + i * 32;
-        memcpy(package, templatePackage, METADATA_SLOTS);
-        package[3] = i;
-
-        uint8_t extraMetaDataSize = 0;
-        uint8_t startingIndex = SLOT_COUNT(i);
-
-        // first package saves total number of packages
-        if (i == 0) {
-            rawPackages[7] = numberPackages;
-            extraMetaDataSize = FIRST_METADATA_SLOTS;
-            startingIndex = 0;
-        }
+    // copy the corresponding content into the slots
+    memcpy(package + METADATA_SLOTS + extraMetaDataSize, this->content + startingIndex, slots);
+}
 
-        // copy the corresponding content into the slots
-        memcpy(package + METADATA_SLOTS + extraMetaDataSize, this->content + startingIndex,
-            i == numberPackages - 1 ? lastPackageSize : DATA_SLOTS - extraMetaDataSize);
-    }
+void PartialDataMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    PartialDataLayout::encode(*this, package);
+}
 
-    cleanUp(templatePackage);
+void RegistrationMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    RegistrationLayout::encode(*this, package);
+}
 
-    return numberPackages;
+void PingMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    PingLayout::encode(*this, package);
+}
+
+void AddRemoveToGroupMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    AddRemoveToGroupLayout::encode(*this, package);
+}
+
+void ErrorMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    ErrorLayout::encode(*this, package);
+}
+
+void ReDisconnectMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    ReDisconnectLayout::encode(*this, package);
 }
 
-uint8_t RegistrationMessage::getRawPackages(uint8_t** data) {
-    Message::getRawPackages(data);
-    (*data)[3] = this->registrationType;
-    (*data)[4] = this->newDeviceID;
-    memcpy((*data) + 5, &this->tempID, 4);
-    (*data)[9] = this->extraField;
-    return 1;
+void AckMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    AckLayout::encode(*this, package);
 }
 
-uint8_t PingMessage::getRawPackages(uint8_t** data) {
-    Message::getRawPackages(data);
-    (*data)[3] = this->senderId;
-    (*data)[4] = this->pingId;
-    (*data)[5] = this->isResponse;
-    memcpy((*data) + 6, &this->timestamp, 4);
-    return 1;
+void GroupSummaryMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    GroupSummaryLayout::encode(*this, package);
 }
 
-uint8_t AddRemoveToGroupMessage::getRawPackages(uint8_t** data) {
-    Message::getRawPackages(data);
-    (*data)[3] = this->isAddToGroup;
-    (*data)[4] = this->groupId;
-    return 1;
+void AggregateMessage::encodePackage(uint8_t* package, uint8_t packageNumber) {
+    Message::encodePackage(package, 0);
+    AggregateLayout::encode(*this, package);
 }
 
-uint8_t ErrorMessage::getRawPackages(uint8_t** data) {
-    Message::getRawPackages(data);
-    (*data)[3] = this->errorCode;
-    memcpy((*data) + 4, this->erroneousMessage, 28);
-    return 1;
+uint8_t AggregateMessage::entrySize(const uint8_t* rawPackage) {
+    switch (typeOf(rawPackage)) {
+        case 0:     // data packages
+        case 6:     // acknowledgements are written directly
+        case 8:     // frames are not nested
+            return 0;
+        default:
+            break;
+    }
+
+    // the receiver and the type are always packed, the transmission ID never
+    uint8_t length = PAYLOAD_SLOTS - 1;
+    while (length > HEADER_SLOTS - 1 && rawPackage[length] == 0) --length;
+    return length + 1 <= AGGREGATE_SLOTS ? length + 1 : 0;
+}
+
+bool AggregateMessage::add(const uint8_t* rawPackage) {
+    uint8_t entrySize = AggregateMessage::entrySize(rawPackage);
+    if (entrySize == 0 || this->size + entrySize > AGGREGATE_SLOTS) return false;
+
+    this->entries[this->size] = entrySize - 1;
+    memcpy(this->entries + this->size + 1, rawPackage + 1, entrySize - 1);
+    this->size += entrySize;
+    ++this->count;
+    return true;
 }
 
-uint8_t ReDisconnectMessage::getRawPackages(uint8_t** data) {
-    Message::getRawPackages(data);
-    (*data)[3] = this->isDisconnect;
-    return 1;
+bool AggregateMessage::unpack(const uint8_t* rawPackage, uint8_t* offset, uint8_t* package) {
+    if (*offset >= AGGREGATE_SLOTS) return false;
+    const uint8_t *entry = rawPackage + HEADER_SLOTS + *offset;
+    uint8_t length = entry[0];
+    // the receiver and the type are always packed, so shorter entries are the end or corrupted
+    if (length < HEADER_SLOTS - 1 || *offset + 1 + length > AGGREGATE_SLOTS) return false;
+
+    VersionField::write(package, VersionField::read(rawPackage));
+    memcpy(package + 1, entry + 1, length);
+    memset(package + 1 + length, 0, CHECKED_SLOTS - 1 - length);
+    setChecksum(package);
+    *offset += 1 + length;
+    return true;
 }
@@ -4,19 +4,51 @@
 #include <cstdint>
 #include <cstring>
 #include <vector>
-#include <functional>
+
+#include "checksum.h"
+#include "frameLayout.h"
 
 #define NETWORKPROTOCOL_VERSION 0
+#define PACKAGE_SIZE 32
+#ifdef NETWORKPROTOCOL_CHECKSUM
+#define CHECKSUM_SLOTS 1
+#else
+#define CHECKSUM_SLOTS 0
+#endif
+#define CHECKED_SLOTS (PACKAGE_SIZE - CHECKSUM_SLOTS)
+#define TRANSMISSION_SLOTS 1
+#define PAYLOAD_SLOTS (CHECKED_SLOTS - TRANSMISSION_SLOTS)
+#define RELIABLE_FLAG 0x80
+#define SEQUENCE_MASK 0x7F
 #define METADATA_SLOTS 7
-#define FIRST_METADATA_SLOTS 1
-#define DATA_SLOTS (32 - METADATA_SLOTS)
+#define FIRST_METADATA_SLOTS 2
+#define DATA_SLOTS (PAYLOAD_SLOTS - METADATA_SLOTS)
 #define FIRST_DATA_PACKAGE_SLOTS (DATA_SLOTS - FIRST_METADATA_SLOTS)
 #define SLOT_COUNT(i) (FIRST_DATA_PACKAGE_SLOTS + DATA_SLOTS * (i - 1))
+#define MAX_DATA_SIZE SLOT_COUNT(255)
+#define ERROR_MESSAGE_SLOTS (PAYLOAD_SLOTS - 4)
+#define GROUP_SUMMARY_SLOTS 16
+#define AGGREGATE_SLOTS (PAYLOAD_SLOTS - HEADER_SLOTS)
+
+/**
+ * Transmission ID of a package between two hops. It is set by the sending hop behind the payload.
+ * The highest bit is set if the package has to be acknowledged, the other bits are the sequence number of the link.
+ */
+typedef PackageField<PAYLOAD_SLOTS, uint8_t> TransmissionField;
 
 /**
  * Base class for all messages.
  */
 class Message {
+protected:
+    /**
+     * Encodes one raw package of this message into the given buffer.
+     * The base implementation writes the standard meta data and zeroes all other slots.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Number of the package to write. Must be less than getNumberPackages().
+     */
+    virtual void encodePackage(uint8_t* package, uint8_t packageNumber);
+
 public:
     virtual ~Message() = default;
 
@@ -51,11 +83,106 @@ public:
 
     /**
      * Uses the given raw package to create a message object. The message object has to be deleted.
+     * On the receive path prefer typeOf() and the decoding constructors, which need no heap memory.
      * @param rawPackage The raw package of the message.
-     * @return The message object
+     * @return The message object or nullptr if the type is unknown or the checksum is wrong.
      */
     static Message *fromRawBytes(const uint8_t* rawPackage);
 
+    /**
+     * Reads the message type of a raw package without decoding it.
+     * @param rawPackage The raw package of the message.
+     * @return Type of the message.
+     */
+    static uint8_t typeOf(const uint8_t* rawPackage) {
+        return GroupTypeField::read(rawPackage) >> 1;
+    }
+
+    /**
+     * Reads the group flag of a raw package without decoding it.
+     * @param rawPackage The raw package of the message.
+     * @return True if the message is addressed to a group.
+     */
+    static bool isGroupPackage(const uint8_t* rawPackage) {
+        return GroupTypeField::read(rawPackage) & 1;
+    }
+
+    /**
+     * Reads the receiver of a raw package without decoding it.
+     * @param rawPackage The raw package of the message.
+     * @return Receiver of the message.
+     */
+    static uint8_t receiverOf(const uint8_t* rawPackage) {
+        return ReceiverField::read(rawPackage);
+    }
+
+    /**
+     * @return Number of raw packages this message is split into. Only data messages can have more than one.
+     */
+    virtual uint8_t getNumberPackages() {
+        return 1;
+    }
+
+    /**
+     * Writes one raw package of this message into the given buffer without allocating memory.
+     * Sets the checksum if checksums are enabled.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Number of the package to write. Must be less than getNumberPackages().
+     */
+    void writeRawPackage(uint8_t* package, uint8_t packageNumber = 0) {
+        this->encodePackage(package, packageNumber);
+        setChecksum(package);
+    }
+
+    /**
+     * Reads the transmission ID of a raw package.
+     * @param rawPackage The raw package.
+     * @return The transmission ID. 0 if the package does not need to be acknowledged.
+     */
+    static uint8_t transmissionOf(const uint8_t* rawPackage) {
+        return TransmissionField::read(rawPackage);
+    }
+
+    /**
+     * Sets the transmission ID of a raw package for the next hop and updates its checksum.
+     * @param rawPackage The raw package.
+     * @param transmission The transmission ID. 0 if the package does not need to be acknowledged.
+     */
+    static void setTransmission(uint8_t* rawPackage, uint8_t transmission) {
+        TransmissionField::write(rawPackage, transmission);
+        setChecksum(rawPackage);
+    }
+
+    /**
+     * Writes the checksum into the last slot of the raw package. Does nothing if checksums are disabled.
+     * @param rawPackage The raw package.
+     */
+    static void setChecksum(uint8_t* rawPackage) {
+#ifdef NETWORKPROTOCOL_CHECKSUM
+        rawPackage[CHECKED_SLOTS] = Checksum::crc8(rawPackage, CHECKED_SLOTS);
+#endif
+    }
+
+    /**
+     * Checks the checksum of a received raw package.
+     * @param rawPackage The raw package.
+     * @return True if the checksum is correct or checksums are disabled.
+     */
+    static bool verifyChecksum(const uint8_t* rawPackage) {
+#ifdef NETWORKPROTOCOL_CHECKSUM
+        return rawPackage[CHECKED_SLOTS] == Checksum::crc8(rawPackage, CHECKED_SLOTS);
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * Writes all raw packages of this message into the given buffer without allocating memory.
+     * @param packages Buffer of getNumberPackages() * PACKAGE_SIZE bytes the packages are written into.
+     * @return Number of raw packages.
+     */
+    uint8_t writeRawPackages(uint8_t* packages);
+
     /**
      * Converts the messages to arrays of 32 bytes.
      * For messages larger than 32 bytes, the message is split and each message is added to the data array.
@@ -65,7 +192,7 @@ public:
      * Free with the cleanUp method.
      * @return Number of raw packages.
      */
-    virtual uint8_t getRawPackages(uint8_t** data);
+    uint8_t getRawPackages(uint8_t** data);
 
     /**
      * Frees the memory of all raw packages of this message.
@@ -81,6 +208,12 @@ public:
     Message(uint8_t receiver, bool group) :
         version(NETWORKPROTOCOL_VERSION), receiver(receiver), group(group) {
     }
+
+    /**
+     * Decodes the standard meta data of a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit Message(const uint8_t* rawPackage);
 };
 
 
@@ -88,6 +221,14 @@ public:
  * Class for data messages.
  */
 class DataMessage : public Message {
+protected:
+    /**
+     * Encodes one package of the split message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Number of the package to write.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
     ~DataMessage() override {
         delete[] content;
@@ -134,12 +275,9 @@ public:
     uint16_t contentSize;
 
     /**
-     * Converts the messages to arrays of 32 bytes.
-     * For messages larger than 32 bytes, the message is split and each message is added to the data array.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages.
+     * @return Number of raw packages the content is split into.
      */
-    uint8_t getRawPackages(uint8_t** data) override;
+    uint8_t getNumberPackages() override;
 
     /**
      * @return Type of this message.
@@ -149,10 +287,27 @@ public:
     }
 };
 
+/**
+ * Wire layout of the fields of a data message that are the same in all of its packages.
+ * The package number, total packages and size of the last package are written per package.
+ */
+typedef FrameLayout<
+    MemberField<OriginField, DataMessage, &DataMessage::origin>,
+    MemberField<MessageIDField, DataMessage, &DataMessage::messageID>
+> DataLayout;
+
 /**
  * Class for partial data messages. Used when data messages arrive, but consist of multiple packages.
  */
 class PartialDataMessage : public Message {
+protected:
+    /**
+     * Encodes this part of a data message into the given buffer, e.g. to forward it unchanged.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, a partial data message always consists of its own package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
 
     /**
@@ -170,6 +325,12 @@ public:
         memcpy(this->content, content, DATA_SLOTS);
     }
 
+    /**
+     * Decodes a partial data message from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit PartialDataMessage(const uint8_t* rawPackage);
+
     /**
      * ID of the message.
      */
@@ -191,15 +352,6 @@ public:
     uint8_t content[DATA_SLOTS]{};
 
 
-    /**
-     * Converts the messages to arrays of 32 bytes.
-     * For messages larger than 32 bytes, the message is split and each message is added to the data array.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages.
-     */
-    uint8_t getRawPackages(uint8_t** data) override {
-        throw std::bad_function_call();
-    };
 
     /**
      * @return Type of this message.
@@ -209,10 +361,33 @@ public:
     }
 };
 
+/**
+ * Wire layout of a partial data message.
+ */
+typedef FrameLayout<
+    MemberField<PackageNumberField, PartialDataMessage, &PartialDataMessage::packageNumber>,
+    MemberField<OriginField, PartialDataMessage, &PartialDataMessage::origin>,
+    MemberField<MessageIDField, PartialDataMessage, &PartialDataMessage::messageID>,
+    ArrayMemberField<METADATA_SLOTS, DATA_SLOTS, PartialDataMessage, &PartialDataMessage::content>
+> PartialDataLayout;
+
+/**
+ * Registration type of a registration message.
+ */
+typedef PackageField<3, uint8_t> RegistrationTypeField;
+
 /**
  * Super class for all messages for registration.
  */
 class RegistrationMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
     using Message::Message;
 
@@ -229,6 +404,12 @@ public:
         : Message(receiver, false), tempID(tempID), newDeviceID(newDeviceID),
         registrationType(registrationType), extraField(extraField) {}
 
+    /**
+     * Decodes a registration message from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit RegistrationMessage(const uint8_t* rawPackage);
+
     /**
      * Temporary ID if ID = 0.
      */
@@ -257,25 +438,49 @@ public:
      */
     uint8_t extraField;
 
+    /**
+     * Number of free child slots of the answering device in answers to discoveries, 0 in all other messages.
+     */
+    uint8_t freeSlots = 0;
+
+    /**
+     * Temporary ID of the discovering device in discovery requests and in the answers to them, 0 in all other messages.
+     * Devices without ID share ID 0, so this tells which device the answer echoes the send time of.
+     */
+    uint32_t requester = 0;
+
     /**
      * @return Type of this message.
      */
     uint8_t getType() override {
         return 1;
     }
-
-    /**
-     * Creates a vector with only one element, which is a byte representation of this message.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages = 1.
-     */
-    uint8_t getRawPackages(uint8_t** data) override;
 };
 
+/**
+ * Wire layout of a registration message.
+ */
+typedef FrameLayout<
+    MemberField<RegistrationTypeField, RegistrationMessage, &RegistrationMessage::registrationType>,
+    MemberField<PackageField<4, uint8_t>, RegistrationMessage, &RegistrationMessage::newDeviceID>,
+    MemberField<PackageField<5, uint32_t>, RegistrationMessage, &RegistrationMessage::tempID>,
+    MemberField<PackageField<9, uint8_t>, RegistrationMessage, &RegistrationMessage::extraField>,
+    MemberField<PackageField<10, uint8_t>, RegistrationMessage, &RegistrationMessage::freeSlots>,
+    MemberField<PackageField<11, uint32_t>, RegistrationMessage, &RegistrationMessage::requester>
+> RegistrationLayout;
+
 /**
  * Class for ping and ping response messages.
  */
 class PingMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
 
     /**
@@ -283,15 +488,23 @@ public:
      * @param receiver Receiver of this message.
      * @param isResponse Indicates whether this is a ping or a response to one.
      * @param timestamp Timestamp of this message.
+     * @param isDirect Indicates whether the ping and its response are sent to the neighbour without routing.
      */
-    explicit PingMessage(uint8_t receiver, uint8_t pingId, uint8_t senderId, bool isResponse, uint32_t timestamp)
-        : Message(receiver, false) {
+    explicit PingMessage(uint8_t receiver, uint8_t pingId, uint8_t senderId, bool isResponse, uint32_t timestamp,
+        bool isDirect = false) : Message(receiver, false) {
         this->pingId = pingId;
         this->senderId = senderId;
         this->isResponse = isResponse;
         this->timestamp = timestamp;
+        this->isDirect = isDirect;
     }
 
+    /**
+     * Decodes a ping message from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit PingMessage(const uint8_t* rawPackage);
+
     /**
      * ID of this ping.
      */
@@ -312,25 +525,43 @@ public:
      */
     uint32_t timestamp;
 
+    /**
+     * Indicates whether the ping is sent to a neighbour without routing, so it measures the link to it.
+     * The response is sent back the same way.
+     */
+    bool isDirect;
+
     /**
      * @return Type of this message.
      */
     uint8_t getType() override {
         return 2;
     }
-
-    /**
-     * Creates a vector with only one element, which is a byte representation of this message.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages = 1.
-     */
-    uint8_t getRawPackages(uint8_t** data) override;
 };
 
+/**
+ * Wire layout of a ping message.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, uint8_t>, PingMessage, &PingMessage::senderId>,
+    MemberField<PackageField<4, uint8_t>, PingMessage, &PingMessage::pingId>,
+    MemberField<PackageField<5, bool>, PingMessage, &PingMessage::isResponse>,
+    MemberField<PackageField<6, uint32_t>, PingMessage, &PingMessage::timestamp>,
+    MemberField<PackageField<10, bool>, PingMessage, &PingMessage::isDirect>
+> PingLayout;
+
 /**
  * Class for messages to add or remove devices to/from a group.
  */
 class AddRemoveToGroupMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
 
     /**
@@ -345,6 +576,12 @@ public:
         this->isAddToGroup = isAddToGroup;
     }
 
+    /**
+     * Decodes a message to add or remove devices to/from a group from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit AddRemoveToGroupMessage(const uint8_t* rawPackage);
+
     /**
      * ID of the group.
      */
@@ -361,19 +598,28 @@ public:
     uint8_t getType() override {
         return 3;
     }
-
-    /**
-     * Creates a vector with only one element, which is a byte representation of this message.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages = 1.
-     */
-    uint8_t getRawPackages(uint8_t** data) override;
 };
 
+/**
+ * Wire layout of a message to add or remove devices to/from a group.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, bool>, AddRemoveToGroupMessage, &AddRemoveToGroupMessage::isAddToGroup>,
+    MemberField<PackageField<4, uint8_t>, AddRemoveToGroupMessage, &AddRemoveToGroupMessage::groupId>
+> AddRemoveToGroupLayout;
+
 /**
  * Class for error messages.
  */
 class ErrorMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
 
     /**
@@ -388,13 +634,19 @@ public:
         this->erroneousMessage = erroneousMessage;
     }
 
+    /**
+     * Decodes an error message from a raw package. The erroneous message points into the raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit ErrorMessage(const uint8_t* rawPackage);
+
     /**
      * Code of the occurred error.
      */
     uint8_t errorCode;
 
     /**
-     * First up to 28 bytes of the message that cause the error.
+     * First up to ERROR_MESSAGE_SLOTS bytes of the message that cause the error.
      */
     const uint8_t *erroneousMessage;
 
@@ -404,19 +656,28 @@ public:
     uint8_t getType() override {
         return 4;
     }
-
-    /**
-     * Creates a vector with only one element, which is a byte representation of this message.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages = 1.
-     */
-    uint8_t getRawPackages(uint8_t** data) override;
 };
 
+/**
+ * Wire layout of an error message.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, uint8_t>, ErrorMessage, &ErrorMessage::errorCode>,
+    ViewMemberField<4, ERROR_MESSAGE_SLOTS, ErrorMessage, &ErrorMessage::erroneousMessage>
+> ErrorLayout;
+
 /**
  * Class for reconnect and disconnect messages.
  */
 class ReDisconnectMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
 public:
 
     /**
@@ -429,6 +690,12 @@ public:
         this->isDisconnect = isDisconnect;
     }
 
+    /**
+     * Decodes a reconnect or disconnect message from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit ReDisconnectMessage(const uint8_t* rawPackage);
+
     /**
      * True if this message is a disconnect message, False if it is a reconnect message.
      */
@@ -440,13 +707,228 @@ public:
     uint8_t getType() override {
         return 5;
     }
+};
+
+/**
+ * Wire layout of a reconnect or disconnect message.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, bool>, ReDisconnectMessage, &ReDisconnectMessage::isDisconnect>
+> ReDisconnectLayout;
+
+/**
+ * Class for acknowledgements of the packages received over a link.
+ * Acknowledgements are only sent to the neighbour and never forwarded.
+ */
+class AckMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
+public:
 
     /**
-     * Creates a vector with only one element, which is a byte representation of this message.
-     * @param data Pointer to an array of pointer. Data is allocated on the heap. Free with the cleanUp method.
-     * @return Number of raw packages = 1.
+     * Constructor for acknowledgements.
+     * @param receiver Neighbour whose packages are acknowledged.
+     * @param cumulativeAck Sequence number of the next package expected. All packages before it have been received.
+     * @param selectiveAcks Bit i is set if the package cumulativeAck + 1 + i has been received.
      */
-    uint8_t getRawPackages(uint8_t** data) override;
+    explicit AckMessage(uint8_t receiver, uint8_t cumulativeAck, uint32_t selectiveAcks)
+        : Message(receiver, false) {
+        this->cumulativeAck = cumulativeAck;
+        this->selectiveAcks = selectiveAcks;
+    }
+
+    /**
+     * Decodes an acknowledgement from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit AckMessage(const uint8_t* rawPackage);
+
+    /**
+     * Sequence number of the next package expected. All packages before it have been received.
+     */
+    uint8_t cumulativeAck;
+
+    /**
+     * Bit i is set if the package cumulativeAck + 1 + i has been received.
+     */
+    uint32_t selectiveAcks;
+
+    /**
+     * @return Type of this message.
+     */
+    uint8_t getType() override {
+        return 6;
+    }
 };
 
+/**
+ * Wire layout of an acknowledgement.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, uint8_t>, AckMessage, &AckMessage::cumulativeAck>,
+    MemberField<PackageField<4, uint32_t>, AckMessage, &AckMessage::selectiveAcks>
+> AckLayout;
+
+/**
+ * Class for the groups of all devices in the subtree of the sender, which are sent to its parent.
+ * The bitmap of the 256 groups is split into two halves, which are sent separately.
+ */
+class GroupSummaryMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
+public:
+
+    /**
+     * Constructor for group summaries.
+     * @param receiver Parent of the sender.
+     * @param half 0 for the groups 0 to 127, 1 for the groups 128 to 255.
+     * @param groups Bitmap of GROUP_SUMMARY_SLOTS bytes of the groups in the half.
+     */
+    explicit GroupSummaryMessage(uint8_t receiver, uint8_t half, const uint8_t* groups)
+        : Message(receiver, false) {
+        this->half = half;
+        memcpy(this->groups, groups, GROUP_SUMMARY_SLOTS);
+    }
+
+    /**
+     * Decodes a group summary from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit GroupSummaryMessage(const uint8_t* rawPackage);
+
+    /**
+     * 0 for the groups 0 to 127, 1 for the groups 128 to 255.
+     */
+    uint8_t half;
+
+    /**
+     * Bitmap of the groups in the half. Group g is bit g % 8 of byte g / 8 of the half.
+     */
+    uint8_t groups[GROUP_SUMMARY_SLOTS];
+
+    /**
+     * @return Type of this message.
+     */
+    uint8_t getType() override {
+        return 7;
+    }
+};
+
+/**
+ * Wire layout of a group summary.
+ */
+typedef FrameLayout<
+    MemberField<PackageField<3, uint8_t>, GroupSummaryMessage, &GroupSummaryMessage::half>,
+    ArrayMemberField<4, GROUP_SUMMARY_SLOTS, GroupSummaryMessage, &GroupSummaryMessage::groups>
+> GroupSummaryLayout;
+
+/**
+ * Class for frames, that carry several small messages to the same neighbour, so they need only one transmission.
+ * Each entry is a length byte followed by that many bytes of the packed package, starting at its receiver.
+ * The version is the one of the frame, the transmission ID is not packed and the trailing zeros are omitted.
+ * A length of 0 ends the entries. Frames are unpacked by the neighbour and never forwarded.
+ */
+class AggregateMessage : public Message {
+protected:
+    /**
+     * Encodes the byte representation of this message into the given buffer.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @param packageNumber Ignored, this message always consists of one package.
+     */
+    void encodePackage(uint8_t* package, uint8_t packageNumber) override;
+
+public:
+
+    /**
+     * Constructor for empty frames.
+     * @param receiver Neighbour the frame is sent to.
+     */
+    explicit AggregateMessage(uint8_t receiver = 0) : Message(receiver, false), size(0), count(0) {
+        memset(this->entries, 0, AGGREGATE_SLOTS);
+    }
+
+    /**
+     * Decodes a frame from a raw package.
+     * @param rawPackage The raw package of the message.
+     */
+    explicit AggregateMessage(const uint8_t* rawPackage);
+
+    /**
+     * The packed packages.
+     */
+    uint8_t entries[AGGREGATE_SLOTS];
+
+    /**
+     * Number of bytes of the entries in use.
+     */
+    uint8_t size;
+
+    /**
+     * Number of packed packages.
+     */
+    uint8_t count;
+
+    /**
+     * Calculates the bytes a package takes in a frame. Only single control packages are packed, data packages
+     * would overwrite each other when several of them complete a message in one frame.
+     * @param rawPackage The raw package.
+     * @return Number of bytes of the entry, 0 if the package cannot be packed.
+     */
+    static uint8_t entrySize(const uint8_t* rawPackage);
+
+    /**
+     * Packs a package behind the other entries.
+     * @param rawPackage The raw package.
+     * @return False if the package cannot be packed or does not fit anymore.
+     */
+    bool add(const uint8_t* rawPackage);
+
+    /**
+     * Unpacks an entry of a raw frame into a package without decoding the frame.
+     * @param rawPackage The raw package of the frame.
+     * @param offset Offset of the entry, 0 for the first one. Set to the offset of the next entry.
+     * @param package Buffer of PACKAGE_SIZE bytes the unpacked package is written into.
+     * @return False if there are no more entries.
+     */
+    static bool unpack(const uint8_t* rawPackage, uint8_t* offset, uint8_t* package);
+
+    /**
+     * @return Type of this message.
+     */
+    uint8_t getType() override {
+        return 8;
+    }
+};
+
+/**
+ * Wire layout of a frame of packed messages.
+ */
+typedef FrameLayout<
+    ArrayMemberField<HEADER_SLOTS, AGGREGATE_SLOTS, AggregateMessage, &AggregateMessage::entries>
+> AggregateLayout;
+
+static_assert(TotalPackagesField::offset == METADATA_SLOTS && LastPackageSizeField::end == METADATA_SLOTS + FIRST_METADATA_SLOTS,
+    "Meta data of the first data package does not match its layout");
+static_assert(PartialDataLayout::end == PAYLOAD_SLOTS, "Partial data messages must fill the package");
+static_assert(RegistrationLayout::end <= PAYLOAD_SLOTS, "Registration messages do not fit into a package");
+static_assert(PingLayout::end <= PAYLOAD_SLOTS, "Ping messages do not fit into a package");
+static_assert(AddRemoveToGroupLayout::end <= PAYLOAD_SLOTS, "Group messages do not fit into a package");
+static_assert(ErrorLayout::end <= PAYLOAD_SLOTS, "Error messages do not fit into a package");
+static_assert(ReDisconnectLayout::end <= PAYLOAD_SLOTS, "Reconnect messages do not fit into a package");
+static_assert(AckLayout::end <= PAYLOAD_SLOTS, "Acknowledgements do not fit into a package");
+static_assert(GroupSummaryLayout::end <= PAYLOAD_SLOTS, "Group summaries do not fit into a package");
+static_assert(AggregateLayout::end == PAYLOAD_SLOTS, "Frames of packed messages must fill the package");
+
 #endif //NETWORKPROTOCOL_MESSAGEOBJECTS_H
\ No newline at end of file
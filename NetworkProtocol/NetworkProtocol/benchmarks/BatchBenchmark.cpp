@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../Messages/messageBatch.h"
+#include "../Messages/messageObjects.h"
+
+#define NUMBER_MESSAGES 1024
+#define ROUNDS 2000
+
+/**
+ * Measures the time of the given number of rounds of a function.
+ * @param name Name of the measured path.
+ * @param function Function run in each round. Returns a checksum, so the work cannot be optimized away.
+ * @return Checksum of the last round.
+ */
+template<typename Function>
+static uint32_t run(const char* name, Function function) {
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        sum = function();
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    double packages = static_cast<double>(NUMBER_MESSAGES) * ROUNDS;
+    printf("%-16s %8.2f ns/package %10.2f Mpackages/s\n", name,
+        duration.count() * 1e9 / packages, packages / duration.count() / 1e6);
+    return sum;
+}
+
+int main() {
+    // bursts of control messages as sent by the hub when it fans out pings and group updates
+    Message* messages[NUMBER_MESSAGES];
+    for (int i = 0; i < NUMBER_MESSAGES; i++) {
+        switch (i % 3) {
+            case 0: messages[i] = new PingMessage(std::rand() % 256, i, 0, false, std::rand()); break;
+            case 1: messages[i] = new AddRemoveToGroupMessage(std::rand() % 256, std::rand() % 256, true); break;
+            default: messages[i] = new RegistrationMessage(std::rand() % 256, std::rand() % 256, std::rand(), 2); break;
+        }
+    }
+
+    auto* packages = new uint8_t[NUMBER_MESSAGES * PACKAGE_SIZE];
+    auto* decodedMessages = new DecodedMessage[NUMBER_MESSAGES];
+    uint8_t receivers[NUMBER_MESSAGES];
+    uint8_t types[NUMBER_MESSAGES];
+    bool groups[NUMBER_MESSAGES];
+
+    run("encode single", [&]() {
+        uint32_t sum = 0;
+        for (Message* message : messages) {
+            uint8_t* data[1];
+            message->getRawPackages(data);
+            sum += (*data)[1];
+            Message::cleanUp(*data);
+        }
+        return sum;
+    });
+    run("encode batch", [&]() {
+        MessageBatch::encode(messages, NUMBER_MESSAGES, packages, NUMBER_MESSAGES);
+        return static_cast<uint32_t>(packages[1]);
+    });
+
+    uint32_t singleSum = run("decode single", [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < NUMBER_MESSAGES; i++) {
+            Message* message = Message::fromRawBytes(packages + i * PACKAGE_SIZE);
+            sum += message->receiver + message->getType();
+            delete message;
+        }
+        return sum;
+    });
+    uint32_t batchSum = run("decode batch", [&]() {
+        uint32_t sum = 0;
+        MessageBatch::decode(packages, NUMBER_MESSAGES, decodedMessages);
+        for (int i = 0; i < NUMBER_MESSAGES; i++) {
+            sum += decodedMessages[i].get()->receiver + decodedMessages[i].type;
+        }
+        return sum;
+    });
+    uint32_t headerSum = run("decode headers", [&]() {
+        uint32_t sum = 0;
+        MessageBatch::decodeHeaders(packages, NUMBER_MESSAGES, receivers, types, groups);
+        for (int i = 0; i < NUMBER_MESSAGES; i++) {
+            sum += receivers[i] + types[i];
+        }
+        return sum;
+    });
+
+    delete[] decodedMessages;
+    delete[] packages;
+    for (Message* message : messages) {
+        delete message;
+    }
+
+    if (singleSum != batchSum || singleSum != headerSum) {
+        printf("decoded values differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../Messages/checksum.h"
+#include "../Messages/messageObjects.h"
+
+#define NUMBER_PACKAGES 1024
+#define ROUNDS 2000
+
+/**
+ * Measures the time of the given number of rounds of a function.
+ * @param name Name of the measured path.
+ * @param function Function run in each round. Returns a checksum, so the work cannot be optimized away.
+ * @param nanoseconds The time per package in nanoseconds is written into this.
+ * @return Checksum of the last round.
+ */
+template<typename Function>
+static uint32_t run(const char* name, Function function, double *nanoseconds) {
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        sum = function();
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    double packages = static_cast<double>(NUMBER_PACKAGES) * ROUNDS;
+    *nanoseconds = duration.count() * 1e9 / packages;
+    printf("%-8s %8.2f ns/package\n", name, *nanoseconds);
+    return sum;
+}
+
+int main() {
+    auto* packages = new uint8_t[NUMBER_PACKAGES * PACKAGE_SIZE];
+    auto* copies = new uint8_t[NUMBER_PACKAGES * PACKAGE_SIZE];
+    for (int i = 0; i < NUMBER_PACKAGES * PACKAGE_SIZE; i++) {
+        packages[i] = std::rand() % 256;
+    }
+
+    double copyTime;
+    double tableTime;
+    double slicedTime;
+
+    // reference: the copy of a package the decoding path does anyway
+    run("memcpy", [&]() {
+        for (int i = 0; i < NUMBER_PACKAGES; i++) {
+            memcpy(copies + i * PACKAGE_SIZE, packages + i * PACKAGE_SIZE, PACKAGE_SIZE);
+        }
+        return static_cast<uint32_t>(copies[(NUMBER_PACKAGES - 1) * PACKAGE_SIZE]);
+    }, &copyTime);
+    uint32_t tableSum = run("table", [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < NUMBER_PACKAGES; i++) {
+            sum += Checksum::crc8Table(packages + i * PACKAGE_SIZE, PACKAGE_SIZE - 1);
+        }
+        return sum;
+    }, &tableTime);
+    uint32_t slicedSum = run("sliced", [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < NUMBER_PACKAGES; i++) {
+            sum += Checksum::crc8Sliced(packages + i * PACKAGE_SIZE, PACKAGE_SIZE - 1);
+        }
+        return sum;
+    }, &slicedTime);
+
+    uint32_t clmulSum = slicedSum;
+#ifdef CHECKSUM_CLMUL
+    double clmulTime = 0;
+    if (Checksum::clmulSupported()) {
+        clmulSum = run("clmul", [&]() {
+            uint32_t sum = 0;
+            for (int i = 0; i < NUMBER_PACKAGES; i++) {
+                sum += Checksum::crc8Clmul(packages + i * PACKAGE_SIZE, PACKAGE_SIZE - 1);
+            }
+            return sum;
+        }, &clmulTime);
+    }
+#endif
+
+    // a table lookup per byte cannot reach the cost of copying the package in a few wide moves
+    printf("table    %8.1fx memcpy\n", tableTime / copyTime);
+    printf("sliced   %8.1fx memcpy\n", slicedTime / copyTime);
+#ifdef CHECKSUM_CLMUL
+    if (clmulTime > 0) printf("clmul    %8.1fx memcpy\n", clmulTime / copyTime);
+#endif
+
+    delete[] copies;
+    delete[] packages;
+
+    if (tableSum != slicedSum || tableSum != clmulSum) {
+        printf("checksums differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../Messages/messageObjects.h"
+
+#define NUMBER_PACKAGES 1024
+#define ROUNDS 2000
+
+/**
+ * Fills the given buffer with raw packages of all message types.
+ * @param packages Buffer of NUMBER_PACKAGES * PACKAGE_SIZE bytes.
+ */
+static void createPackages(uint8_t* packages) {
+    uint8_t content[DATA_SLOTS];
+    uint8_t erroneousMessage[ERROR_MESSAGE_SLOTS] = {};
+
+    for (int i = 0; i < NUMBER_PACKAGES; i++) {
+        uint8_t* package = packages + i * PACKAGE_SIZE;
+        uint8_t receiver = std::rand() % 256;
+
+        switch (i % 6) {
+            case 0: {
+                // the data message does not own the stack content, so it is written by a partial message
+                for (uint8_t &byte : content) byte = std::rand() % 256;
+                PartialDataMessage(receiver, false, 0, std::rand() % 65536, std::rand() % 256, content)
+                    .writeRawPackage(package);
+                break;
+            }
+            case 1: RegistrationMessage(receiver, std::rand() % 256, std::rand(), 2).writeRawPackage(package); break;
+            case 2: PingMessage(receiver, std::rand() % 256, std::rand() % 256, false, std::rand()).writeRawPackage(package); break;
+            case 3: AddRemoveToGroupMessage(receiver, std::rand() % 256, true).writeRawPackage(package); break;
+            case 4: ErrorMessage(receiver, std::rand() % 256, erroneousMessage).writeRawPackage(package); break;
+            default: ReDisconnectMessage(receiver, true).writeRawPackage(package); break;
+        }
+    }
+}
+
+/**
+ * Decodes with the heap allocating path: fromRawBytes, dynamic_cast and delete.
+ * @return Checksum over the decoded fields, so the work cannot be optimized away.
+ */
+static uint32_t decodeHeap(const uint8_t* packages) {
+    uint32_t sum = 0;
+    for (int i = 0; i < NUMBER_PACKAGES; i++) {
+        Message* message = Message::fromRawBytes(packages + i * PACKAGE_SIZE);
+        switch (message->getType()) {
+            case 0: sum += dynamic_cast<PartialDataMessage*>(message)->messageID; break;
+            case 1: sum += dynamic_cast<RegistrationMessage*>(message)->tempID; break;
+            case 2: sum += dynamic_cast<PingMessage*>(message)->timestamp; break;
+            case 3: sum += dynamic_cast<AddRemoveToGroupMessage*>(message)->groupId; break;
+            case 4: sum += dynamic_cast<ErrorMessage*>(message)->errorCode; break;
+            case 5: sum += dynamic_cast<ReDisconnectMessage*>(message)->isDisconnect; break;
+            default: break;
+        }
+        delete message;
+    }
+    return sum;
+}
+
+/**
+ * Decodes with the stack path: dispatch on the type byte and the decoding constructors.
+ * @return Checksum over the decoded fields, so the work cannot be optimized away.
+ */
+static uint32_t decodeStack(const uint8_t* packages) {
+    uint32_t sum = 0;
+    for (int i = 0; i < NUMBER_PACKAGES; i++) {
+        const uint8_t* package = packages + i * PACKAGE_SIZE;
+        switch (Message::typeOf(package)) {
+            case 0: sum += PartialDataMessage(package).messageID; break;
+            case 1: sum += RegistrationMessage(package).tempID; break;
+            case 2: sum += PingMessage(package).timestamp; break;
+            case 3: sum += AddRemoveToGroupMessage(package).groupId; break;
+            case 4: sum += ErrorMessage(package).errorCode; break;
+            case 5: sum += ReDisconnectMessage(package).isDisconnect; break;
+            default: break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Runs the given decoder and prints its throughput.
+ * @param name Name of the decoding path.
+ * @param decode The decoder.
+ * @param packages The raw packages.
+ * @return Checksum of the last round.
+ */
+static uint32_t run(const char* name, uint32_t (*decode)(const uint8_t*), const uint8_t* packages) {
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        sum = decode(packages);
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    double packagesDecoded = static_cast<double>(NUMBER_PACKAGES) * ROUNDS;
+    printf("%-6s %8.2f ns/package %10.2f Mpackages/s\n", name,
+        duration.count() * 1e9 / packagesDecoded, packagesDecoded / duration.count() / 1e6);
+    return sum;
+}
+
+int main() {
+    auto* packages = new uint8_t[NUMBER_PACKAGES * PACKAGE_SIZE];
+    createPackages(packages);
+
+    uint32_t heapSum = run("heap", decodeHeap, packages);
+    uint32_t stackSum = run("stack", decodeStack, packages);
+
+    delete[] packages;
+
+    if (heapSum != stackSum) {
+        printf("decoded values differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ConnectionBenchmarkTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+#include "../ConnectionBenchmark/ConnectionBenchmarkWrapper.h"
+
+
+/**
+ * Takes the next ping of the benchmark. Like a device, it only uses up an ID if a ping is created.
+ * @param wrapper The benchmark.
+ * @param time The current time.
+ * @param ping The ping is written into this.
+ * @return False if no ping has to be sent.
+ */
+static bool nextPing(ConnectionBenchmarkWrapper &wrapper, uint32_t time, PingMessage *ping) {
+    static uint8_t nextId = 0;
+    Message *msg = nullptr;
+    wrapper.update(time, nextId, &msg);
+    if (msg == nullptr) return false;
+    nextId++;
+    *ping = *static_cast<PingMessage*>(msg);
+    delete msg;
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(ConnectionBenchmarkTest)
+
+BOOST_AUTO_TEST_CASE(InterleaveTest) {
+    uint8_t devices[] = {3, 5, 7};
+    ConnectionBenchmarkWrapper wrapper(devices, 3, 50, 100, 4, 1);
+    PingMessage ping(0, 0, 0, false, 0);
+
+    // the devices take turns until the window is full
+    BOOST_REQUIRE(nextPing(wrapper, 0, &ping));
+    BOOST_CHECK_EQUAL(ping.receiver, 3);
+    uint8_t firstPing = ping.pingId;
+    // the pings measure the links to the neighbours and take the IDs they are given
+    BOOST_CHECK(ping.isDirect);
+    BOOST_REQUIRE(nextPing(wrapper, 0, &ping));
+    BOOST_CHECK_EQUAL(ping.receiver, 5);
+    BOOST_CHECK_EQUAL(ping.pingId, static_cast<uint8_t>(firstPing + 1));
+    BOOST_REQUIRE(nextPing(wrapper, 0, &ping));
+    BOOST_CHECK_EQUAL(ping.receiver, 7);
+    BOOST_REQUIRE(nextPing(wrapper, 0, &ping));
+    BOOST_CHECK_EQUAL(ping.receiver, 3);
+    BOOST_CHECK_EQUAL(ping.senderId, 1);
+    BOOST_CHECK(!nextPing(wrapper, 0, &ping));
+    BOOST_CHECK_EQUAL(wrapper.inFlight(), 4);
+
+    // responses are matched by device and ping ID
+    BOOST_CHECK(!wrapper.newAnswer(5, firstPing, 10));
+    BOOST_CHECK(!wrapper.newAnswer(3, firstPing + 100, 10));
+    BOOST_CHECK(wrapper.newAnswer(3, firstPing, 10));
+    BOOST_CHECK(!wrapper.newAnswer(3, firstPing, 10));
+    BOOST_CHECK_EQUAL(wrapper.getEstimator(3)->getRtt(), 10);
+    BOOST_CHECK_EQUAL(wrapper.inFlight(), 3);
+    BOOST_REQUIRE(nextPing(wrapper, 10, &ping));
+    BOOST_CHECK_EQUAL(ping.receiver, 5);
+
+    // pings without response are lost after the timeout and free the window
+    BOOST_CHECK(!nextPing(wrapper, 100, &ping));
+    BOOST_REQUIRE(nextPing(wrapper, 101, &ping));
+    BOOST_CHECK_EQUAL(wrapper.inFlight(), 2);
+    BOOST_CHECK(wrapper.getEstimator(9) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EarlyStopTest) {
+    uint8_t devices[] = {3, 5, 7};
+    ConnectionBenchmarkWrapper wrapper(devices, 3, 50, 100, 4, 1);
+    // device 3 answers after 10 ms, device 5 after 40 ms and device 7 never
+    std::map<uint8_t, uint32_t> delays = {{3, 10}, {5, 40}};
+    std::map<uint32_t, PingMessage> responses;
+    uint32_t sent = 0;
+    uint32_t time = 0;
+    for (; time < 10000 && !wrapper.finished(); time++) {
+        auto response = responses.find(time);
+        while (response != responses.end() && response->first == time) {
+            wrapper.newAnswer(response->second.receiver, response->second.pingId, time);
+            response = responses.erase(response);
+        }
+        PingMessage ping(0, 0, 0, false, 0);
+        while (nextPing(wrapper, time, &ping)) {
+            sent++;
+            auto delay = delays.find(ping.receiver);
+            if (delay == delays.end()) continue;
+            // the times of the responses differ, so they can be kept in a map
+            uint32_t arrival = time + delay->second;
+            while (responses.count(arrival) != 0) arrival++;
+            responses.emplace(arrival, ping);
+        }
+    }
+    BOOST_REQUIRE(wrapper.finished());
+    // the best connection is clear long before all 150 pings have been sent
+    BOOST_CHECK_LT(sent, 40);
+    BOOST_CHECK_LT(time, 1000);
+    BOOST_CHECK_GE(wrapper.getEstimator(3)->getReceivedCount(), BENCHMARK_MIN_PINGS);
+    BOOST_CHECK_EQUAL(wrapper.getEstimator(7)->getReceivedCount(), 0);
+    BOOST_CHECK_LT(wrapper.getEstimator(3)->cost(), wrapper.getEstimator(5)->cost());
+    BOOST_CHECK_EQUAL(wrapper.getEstimator(7)->cost(), UINT32_MAX);
+
+    // no more pings after the end
+    PingMessage ping(0, 0, 0, false, 0);
+    BOOST_CHECK(!nextPing(wrapper, time, &ping));
+}
+
+BOOST_AUTO_TEST_CASE(NoDevicesTest) {
+    ConnectionBenchmarkWrapper wrapper(nullptr, 0, 50, 100, 4, 1);
+    PingMessage ping(0, 0, 0, false, 0);
+    BOOST_CHECK(wrapper.finished());
+    BOOST_CHECK(!nextPing(wrapper, 0, &ping));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include <boost/test/unit_test.hpp>
 #include <cstdlib>
 
+#include "../Messages/messageBatch.h"
 #include "../Messages/messageObjects.h"
 
 
@@ -57,6 +58,8 @@ BOOST_AUTO_TEST_CASE(DataRawPackageTest) {
 
             if (j == 0) {
                 BOOST_CHECK_EQUAL(package[7], numberPackages[i]);
+                BOOST_CHECK_EQUAL(package[8], numberPackages[i] == 1 ? contentSizes[i]
+                    : contentSizes[i] - SLOT_COUNT(numberPackages[i] - 1));
                 for (int k = 0; k < FIRST_DATA_PACKAGE_SLOTS; k++) {
                     BOOST_CHECK_MESSAGE(package[METADATA_SLOTS + FIRST_METADATA_SLOTS + k] == content[k], "Package 0 at slot " << k);
                 }
@@ -335,7 +338,7 @@ BOOST_AUTO_TEST_CASE(ErrorRawPackageTest) {
     uint8_t id = std::rand() % 256;
     uint8_t errorCode = std::rand() % 256;
 
-    uint8_t erroneousMessage[28];
+    uint8_t erroneousMessage[ERROR_MESSAGE_SLOTS];
 
     for (unsigned char & i : erroneousMessage) {
         i = std::rand() % 256;
@@ -356,7 +359,7 @@ BOOST_AUTO_TEST_CASE(ErrorRawPackageTest) {
     BOOST_CHECK_EQUAL(package[2] / 2, 4);
     BOOST_CHECK_EQUAL(package[3], errorCode);
 
-    for (int i = 0; i < 28; ++i) {
+    for (int i = 0; i < ERROR_MESSAGE_SLOTS; ++i) {
         BOOST_CHECK_EQUAL(package[i + 4], erroneousMessage[i]);
     }
 
@@ -368,7 +371,7 @@ BOOST_AUTO_TEST_CASE(ErrorRawPackageTest) {
     BOOST_CHECK_EQUAL(createdMsg->errorCode, errorCode);
     BOOST_CHECK_EQUAL(createdMsg->getType(), 4);
 
-    for (int i = 0; i < 28; ++i) {
+    for (int i = 0; i < ERROR_MESSAGE_SLOTS; ++i) {
         BOOST_CHECK_EQUAL(createdMsg->erroneousMessage[i], erroneousMessage[i]);
     }
 
@@ -380,6 +383,7 @@ BOOST_AUTO_TEST_CASE(DiscoverTempIDRawPackageTest) {
     uint8_t id = std::rand() % 256;
     uint32_t tempID = std::rand();
     RegistrationMessage msg = RegistrationMessage(id, id, tempID, 0, true);
+    msg.freeSlots = 3;
 
     uint8_t *dataAddress[1];
     uint8_t gotNumberPackages = msg.getRawPackages(dataAddress);
@@ -400,6 +404,7 @@ BOOST_AUTO_TEST_CASE(DiscoverTempIDRawPackageTest) {
 
     BOOST_CHECK_EQUAL(createdID, tempID);
     BOOST_CHECK(package[9]);
+    BOOST_CHECK_EQUAL(package[10], 3);
 
 
     auto* createdMsg = dynamic_cast<RegistrationMessage *>(Message::fromRawBytes(rawPackages));
@@ -411,6 +416,7 @@ BOOST_AUTO_TEST_CASE(DiscoverTempIDRawPackageTest) {
     BOOST_CHECK_EQUAL(createdMsg->getType(), 1);
     BOOST_CHECK_EQUAL(createdMsg->registrationType, 0);
     BOOST_CHECK(createdMsg->extraField);
+    BOOST_CHECK_EQUAL(createdMsg->freeSlots, 3);
 
     delete createdMsg;
     Message::cleanUp(rawPackages);
@@ -447,4 +453,243 @@ BOOST_AUTO_TEST_CASE(ReDisconnectRawPackageTest) {
     Message::cleanUp(rawPackages);
 }
 
+BOOST_AUTO_TEST_CASE(AckRawPackageTest) {
+    uint8_t id = std::rand() % 256;
+    uint8_t cumulativeAck = std::rand() % 128;
+    uint32_t selectiveAcks = std::rand();
+    AckMessage msg = AckMessage(id, cumulativeAck, selectiveAcks);
+
+    uint8_t package[PACKAGE_SIZE];
+    msg.writeRawPackage(package);
+
+    BOOST_CHECK_EQUAL(package[0], NETWORKPROTOCOL_VERSION);
+    BOOST_CHECK_EQUAL(package[1], id);
+    BOOST_CHECK_EQUAL(package[2] / 2, 6);
+    BOOST_CHECK_EQUAL(package[3], cumulativeAck);
+    // acknowledgements are not acknowledged themselves
+    BOOST_CHECK_EQUAL(Message::transmissionOf(package), 0);
+
+    auto* createdMsg = dynamic_cast<AckMessage *>(Message::fromRawBytes(package));
+
+    BOOST_REQUIRE(createdMsg != nullptr);
+    BOOST_CHECK_EQUAL(createdMsg->receiver, id);
+    BOOST_CHECK_EQUAL(createdMsg->getType(), 6);
+    BOOST_CHECK_EQUAL(createdMsg->cumulativeAck, cumulativeAck);
+    BOOST_CHECK_EQUAL(createdMsg->selectiveAcks, selectiveAcks);
+
+    delete createdMsg;
+}
+
+BOOST_AUTO_TEST_CASE(GroupSummaryRawPackageTest) {
+    uint8_t id = std::rand() % 256;
+    uint8_t groups[GROUP_SUMMARY_SLOTS];
+    for (uint8_t &byte : groups) {
+        byte = std::rand() % 256;
+    }
+    GroupSummaryMessage msg = GroupSummaryMessage(id, 1, groups);
+
+    uint8_t package[PACKAGE_SIZE];
+    msg.writeRawPackage(package);
+
+    BOOST_CHECK_EQUAL(package[0], NETWORKPROTOCOL_VERSION);
+    BOOST_CHECK_EQUAL(package[1], id);
+    BOOST_CHECK_EQUAL(package[2] / 2, 7);
+    BOOST_CHECK_EQUAL(package[3], 1);
+
+    auto* createdMsg = dynamic_cast<GroupSummaryMessage *>(Message::fromRawBytes(package));
+
+    BOOST_REQUIRE(createdMsg != nullptr);
+    BOOST_CHECK_EQUAL(createdMsg->receiver, id);
+    BOOST_CHECK_EQUAL(createdMsg->getType(), 7);
+    BOOST_CHECK_EQUAL(createdMsg->half, 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(createdMsg->groups, createdMsg->groups + GROUP_SUMMARY_SLOTS,
+        groups, groups + GROUP_SUMMARY_SLOTS);
+
+    delete createdMsg;
+}
+
+BOOST_AUTO_TEST_CASE(AggregateRawPackageTest) {
+    uint8_t packages[3][PACKAGE_SIZE];
+    PingMessage(std::rand() % 255 + 1, std::rand() % 256, std::rand() % 256, false, std::rand()).writeRawPackage(packages[0]);
+    AddRemoveToGroupMessage(std::rand() % 256, std::rand() % 256, true).writeRawPackage(packages[1]);
+    ReDisconnectMessage(std::rand() % 256, true).writeRawPackage(packages[2]);
+
+    uint8_t id = std::rand() % 256;
+    AggregateMessage msg = AggregateMessage(id);
+    for (const uint8_t *package : packages) {
+        BOOST_CHECK(msg.add(package));
+    }
+    BOOST_CHECK_EQUAL(msg.count, 3);
+
+    // data packages and acknowledgements are never packed
+    uint8_t other[PACKAGE_SIZE];
+    AckMessage(id, 1, 0).writeRawPackage(other);
+    BOOST_CHECK_EQUAL(AggregateMessage::entrySize(other), 0);
+    BOOST_CHECK(!msg.add(other));
+
+    uint8_t package[PACKAGE_SIZE];
+    msg.writeRawPackage(package);
+    BOOST_CHECK_EQUAL(package[1], id);
+    BOOST_CHECK_EQUAL(package[2] / 2, 8);
+
+    auto* createdMsg = dynamic_cast<AggregateMessage *>(Message::fromRawBytes(package));
+    BOOST_REQUIRE(createdMsg != nullptr);
+    BOOST_CHECK_EQUAL(createdMsg->receiver, id);
+    BOOST_CHECK_EQUAL(createdMsg->count, 3);
+    BOOST_CHECK_EQUAL(createdMsg->size, msg.size);
+    delete createdMsg;
+
+    // the packed packages are unpacked unchanged
+    uint8_t unpacked[PACKAGE_SIZE];
+    uint8_t offset = 0;
+    for (const uint8_t *original : packages) {
+        BOOST_REQUIRE(AggregateMessage::unpack(package, &offset, unpacked));
+        BOOST_CHECK_EQUAL_COLLECTIONS(unpacked, unpacked + PACKAGE_SIZE, original, original + PACKAGE_SIZE);
+    }
+    BOOST_CHECK(!AggregateMessage::unpack(package, &offset, unpacked));
+}
+
+BOOST_AUTO_TEST_CASE(AggregateFullTest) {
+    uint8_t package[PACKAGE_SIZE];
+    PingMessage(1, 2, 3, true, 0xFFFFFFFF).writeRawPackage(package);
+    uint8_t entrySize = AggregateMessage::entrySize(package);
+    BOOST_REQUIRE(entrySize > 0);
+
+    AggregateMessage msg = AggregateMessage(1);
+    while (msg.add(package)) {}
+    BOOST_CHECK_EQUAL(msg.count, AGGREGATE_SLOTS / entrySize);
+    BOOST_CHECK_LE(msg.size, AGGREGATE_SLOTS);
+}
+
+BOOST_AUTO_TEST_CASE(TransmissionTest) {
+    uint8_t package[PACKAGE_SIZE];
+    PingMessage(1, 2, 3, false, 4).writeRawPackage(package);
+
+    Message::setTransmission(package, RELIABLE_FLAG | 42);
+    BOOST_CHECK_EQUAL(Message::transmissionOf(package), RELIABLE_FLAG | 42);
+    BOOST_CHECK(Message::verifyChecksum(package));
+
+    // the transmission ID does not change the message
+    PingMessage ping = PingMessage(package);
+    BOOST_CHECK_EQUAL(ping.pingId, 2);
+    BOOST_CHECK_EQUAL(ping.timestamp, 4);
+}
+
+BOOST_AUTO_TEST_CASE(WriteRawPackagesTest) {
+    uint16_t contentSize = FIRST_DATA_PACKAGE_SLOTS + 2 * DATA_SLOTS + 1;
+    uint8_t *content = new uint8_t[contentSize];
+
+    for (int i = 0; i < contentSize; i++) {
+        content[i] = std::rand() % 256;
+    }
+
+    DataMessage msg = DataMessage(std::rand() % 256, false, std::rand() % 65536, std::rand() % 256,
+        content, contentSize);
+
+    BOOST_CHECK_EQUAL(msg.getNumberPackages(), 4);
+
+    uint8_t *dataAddress[1];
+    uint8_t gotNumberPackages = msg.getRawPackages(dataAddress);
+    uint8_t *rawPackages = *dataAddress;
+
+    uint8_t packages[4 * PACKAGE_SIZE];
+    BOOST_CHECK_EQUAL(msg.writeRawPackages(packages), gotNumberPackages);
+    BOOST_CHECK(memcmp(packages, rawPackages, 4 * PACKAGE_SIZE) == 0);
+
+    for (int j = 0; j < gotNumberPackages; j++) {
+        // a partial data message has to be serialized to the package it has been created from
+        uint8_t package[PACKAGE_SIZE];
+        auto* createdMsg = dynamic_cast<PartialDataMessage *>(Message::fromRawBytes(rawPackages + j * PACKAGE_SIZE));
+        createdMsg->writeRawPackage(package);
+
+        BOOST_CHECK(memcmp(package, rawPackages + j * PACKAGE_SIZE, PACKAGE_SIZE) == 0);
+
+        delete createdMsg;
+    }
+
+    Message::cleanUp(rawPackages);
+}
+
+BOOST_AUTO_TEST_CASE(BatchTest) {
+    uint8_t content[FIRST_DATA_PACKAGE_SLOTS + 1] = {};
+    content[FIRST_DATA_PACKAGE_SLOTS] = 42;
+    DataMessage data = DataMessage(3, true, 7, 1, content, sizeof(content));
+    PingMessage ping = PingMessage(4, 5, 1, true, 123456);
+    ReDisconnectMessage disconnect = ReDisconnectMessage(6, true);
+
+    Message* messages[] = {&data, &ping, &disconnect};
+    uint8_t packages[4 * PACKAGE_SIZE];
+
+    // only the data message fits completely into a buffer of two packages
+    uint16_t numberEncoded = 0;
+    BOOST_CHECK_EQUAL(MessageBatch::encode(messages, 3, packages, 2, &numberEncoded), 2);
+    BOOST_CHECK_EQUAL(numberEncoded, 1);
+
+    BOOST_CHECK_EQUAL(MessageBatch::encode(messages, 3, packages, 4, &numberEncoded), 4);
+    BOOST_CHECK_EQUAL(numberEncoded, 3);
+
+    uint8_t receivers[4];
+    uint8_t types[4];
+    bool groups[4];
+    MessageBatch::decodeHeaders(packages, 4, receivers, types, groups);
+
+    uint8_t expectedReceivers[] = {3, 3, 4, 6};
+    uint8_t expectedTypes[] = {0, 0, 2, 5};
+    for (int i = 0; i < 4; i++) {
+        BOOST_CHECK_EQUAL(receivers[i], expectedReceivers[i]);
+        BOOST_CHECK_EQUAL(types[i], expectedTypes[i]);
+        BOOST_CHECK_EQUAL(groups[i], i < 2);
+    }
+
+    DecodedMessage decodedMessages[4];
+    BOOST_CHECK_EQUAL(MessageBatch::decode(packages, 4, decodedMessages), 4);
+
+    BOOST_CHECK_EQUAL(decodedMessages[1].type, 0);
+    BOOST_CHECK_EQUAL(decodedMessages[1].data.packageNumber, 1);
+    BOOST_CHECK_EQUAL(decodedMessages[1].data.content[0], 42);
+    BOOST_CHECK_EQUAL(decodedMessages[2].type, 2);
+    BOOST_CHECK_EQUAL(decodedMessages[2].ping.timestamp, 123456);
+    BOOST_CHECK(decodedMessages[2].ping.isResponse);
+    BOOST_CHECK_EQUAL(decodedMessages[3].get()->getType(), 5);
+    BOOST_CHECK(decodedMessages[3].reDisconnect.isDisconnect);
+
+    data.content = nullptr;
+}
+
+BOOST_AUTO_TEST_CASE(ChecksumTest) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    BOOST_CHECK_EQUAL(Checksum::crc8Table(check, sizeof(check)), 0xF4);
+    BOOST_CHECK_EQUAL(Checksum::crc8(check, sizeof(check)), 0xF4);
+
+    uint8_t data[PACKAGE_SIZE];
+    for (uint8_t length = 0; length <= PACKAGE_SIZE; length++) {
+        for (uint8_t &byte : data) byte = std::rand() % 256;
+        BOOST_CHECK_EQUAL(Checksum::crc8(data, length), Checksum::crc8Table(data, length));
+    }
+
+    // the slices and the chunks of the carry-less multiplication also cover lengths above a package
+    uint8_t longData[255];
+    for (uint8_t &byte : longData) byte = std::rand() % 256;
+    for (uint16_t length = 0; length <= 255; length++) {
+        uint8_t crc = Checksum::crc8Table(longData, length);
+        BOOST_CHECK_EQUAL(Checksum::crc8Sliced(longData, length), crc);
+#ifdef CHECKSUM_CLMUL
+        if (Checksum::clmulSupported()) BOOST_CHECK_EQUAL(Checksum::crc8Clmul(longData, length), crc);
+#endif
+    }
+
+    uint8_t package[PACKAGE_SIZE];
+    PingMessage(1, 2, 3, false, 4).writeRawPackage(package);
+    BOOST_CHECK(Message::verifyChecksum(package));
+
+#ifdef NETWORKPROTOCOL_CHECKSUM
+    // a corrupted package is not decoded
+    package[6] ^= 0x10;
+    BOOST_CHECK(!Message::verifyChecksum(package));
+    BOOST_CHECK(Message::fromRawBytes(package) == nullptr);
+    DecodedMessage decodedMessage;
+    BOOST_CHECK(!decodedMessage.decode(package));
+#endif
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
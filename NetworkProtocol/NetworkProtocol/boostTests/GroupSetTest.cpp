@@ -0,0 +1,116 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE GroupSetTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../groupSet.h"
+
+
+BOOST_AUTO_TEST_SUITE(GroupSetTest)
+
+BOOST_AUTO_TEST_CASE(MembershipTest) {
+    GroupSet groups;
+
+    BOOST_CHECK(groups.empty());
+    for (int group = 0; group < 256; ++group) {
+        BOOST_CHECK(!groups.contains(group));
+    }
+
+    BOOST_CHECK(groups.add(0));
+    BOOST_CHECK(groups.add(31));
+    BOOST_CHECK(groups.add(32));
+    BOOST_CHECK(groups.add(255));
+    // adding a group twice does not duplicate it
+    BOOST_CHECK(!groups.add(31));
+    BOOST_CHECK_EQUAL(groups.size(), 4);
+    BOOST_CHECK(groups.contains(31));
+    BOOST_CHECK(groups.contains(255));
+    BOOST_CHECK(!groups.contains(30));
+
+    BOOST_CHECK(groups.remove(31));
+    BOOST_CHECK(!groups.remove(31));
+    BOOST_CHECK(!groups.contains(31));
+    BOOST_CHECK_EQUAL(groups.size(), 3);
+
+    groups.clear();
+    BOOST_CHECK(groups.empty());
+}
+
+BOOST_AUTO_TEST_CASE(BulkTest) {
+    GroupSet first;
+    GroupSet second;
+    for (int group = 0; group < 256; group += 2) {
+        first.add(group);
+    }
+    for (int group = 0; group < 256; group += 3) {
+        second.add(group);
+    }
+    BOOST_CHECK(first.intersects(second));
+
+    GroupSet united = first;
+    united.add(second);
+    GroupSet common = first;
+    common.retain(second);
+    GroupSet difference = first;
+    difference.remove(second);
+    for (int group = 0; group < 256; ++group) {
+        BOOST_CHECK_EQUAL(united.contains(group), group % 2 == 0 || group % 3 == 0);
+        BOOST_CHECK_EQUAL(common.contains(group), group % 6 == 0);
+        BOOST_CHECK_EQUAL(difference.contains(group), group % 2 == 0 && group % 3 != 0);
+    }
+    BOOST_CHECK(!difference.intersects(second));
+    BOOST_CHECK_EQUAL(common.size(), 43);
+
+    // iterate over the groups
+    uint16_t count = 0;
+    uint8_t group = 0;
+    for (uint16_t from = 0; from < 256 && common.next(&group, from); from = group + 1) {
+        BOOST_CHECK_EQUAL(group % 6, 0);
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 43);
+}
+
+BOOST_AUTO_TEST_CASE(BytesTest) {
+    GroupSet groups;
+    groups.add(0);
+    groups.add(9);
+    groups.add(255);
+
+    uint8_t bytes[GROUP_SET_BYTES];
+    groups.toBytes(bytes);
+    BOOST_CHECK_EQUAL(bytes[0], 0x01);
+    BOOST_CHECK_EQUAL(bytes[1], 0x02);
+    BOOST_CHECK_EQUAL(bytes[31], 0x80);
+
+    GroupSet copy;
+    copy.add(100);
+    copy.fromBytes(bytes);
+    BOOST_CHECK(copy == groups);
+    copy.add(100);
+    BOOST_CHECK(copy != groups);
+}
+
+BOOST_AUTO_TEST_CASE(PartialBytesTest) {
+    GroupSet groups;
+    groups.add(9);
+    groups.add(200);
+
+    uint8_t bytes[16];
+    groups.toBytes(bytes, 16, 16);
+    BOOST_CHECK_EQUAL(bytes[9], 0x01);
+
+    // only the groups of the replaced bytes change
+    GroupSet copy;
+    copy.add(3);
+    copy.add(130);
+    copy.fromBytes(bytes, 16, 16);
+    BOOST_CHECK(copy.contains(3));
+    BOOST_CHECK(!copy.contains(130));
+    BOOST_CHECK(copy.contains(200));
+    BOOST_CHECK(!copy.contains(9));
+    BOOST_CHECK_EQUAL(copy.size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
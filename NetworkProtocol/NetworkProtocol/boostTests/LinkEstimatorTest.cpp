@@ -0,0 +1,112 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE LinkEstimatorTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../ConnectionBenchmark/LinkEstimator.h"
+
+
+BOOST_AUTO_TEST_SUITE(LinkEstimatorTest)
+
+BOOST_AUTO_TEST_CASE(EmptyTest) {
+    LinkEstimator estimator;
+    BOOST_CHECK_EQUAL(estimator.quantile(50), 0);
+    BOOST_CHECK_EQUAL(estimator.deliveryRatio(), 0);
+    BOOST_CHECK_EQUAL(estimator.cost(), UINT32_MAX);
+
+    // nothing has been answered
+    estimator.sent();
+    BOOST_CHECK_EQUAL(estimator.deliveryRatio(), 0);
+    BOOST_CHECK_EQUAL(estimator.cost(), UINT32_MAX);
+}
+
+BOOST_AUTO_TEST_CASE(SmoothingTest) {
+    LinkEstimator estimator;
+    estimator.sent();
+    estimator.received(40);
+    BOOST_CHECK_EQUAL(estimator.getRtt(), 40);
+    BOOST_CHECK_EQUAL(estimator.getRttVariance(), 20);
+
+    // a constant round trip time converges and the variance decays
+    for (int i = 0; i < 100; i++) {
+        estimator.sent();
+        estimator.received(20);
+    }
+    BOOST_CHECK_EQUAL(estimator.getRtt(), 20);
+    BOOST_CHECK_LE(estimator.getRttVariance(), 1);
+
+    // a single outlier moves the mean by an eighth of the error
+    estimator.sent();
+    estimator.received(100);
+    BOOST_CHECK_EQUAL(estimator.getRtt(), 30);
+    BOOST_CHECK_GE(estimator.getRttVariance(), 20);
+}
+
+BOOST_AUTO_TEST_CASE(QuantileTest) {
+    LinkEstimator estimator;
+    // 1 to 100 ms
+    for (uint16_t rtt = 1; rtt <= 100; rtt++) {
+        estimator.sent();
+        estimator.received(rtt);
+    }
+    // the quantiles are the upper bounds of their buckets, less than 50 % above the real ones
+    uint16_t median = estimator.quantile(50);
+    uint16_t p95 = estimator.quantile(95);
+    BOOST_CHECK_GE(median, 50);
+    BOOST_CHECK_LT(median, 75);
+    BOOST_CHECK_GE(p95, 95);
+    BOOST_CHECK_LT(p95, 143);
+    BOOST_CHECK_EQUAL(estimator.quantile(1), 1);
+    BOOST_CHECK_GE(estimator.quantile(100), 100);
+
+    // round trip times below RTT_SKETCH_EXACT are exact
+    LinkEstimator exact;
+    exact.received(3);
+    exact.received(5);
+    BOOST_CHECK_EQUAL(exact.quantile(50), 3);
+    BOOST_CHECK_EQUAL(exact.quantile(100), 5);
+
+    LinkEstimator slow;
+    slow.received(UINT16_MAX);
+    BOOST_CHECK_EQUAL(slow.quantile(50), UINT16_MAX);
+}
+
+BOOST_AUTO_TEST_CASE(DeliveryTest) {
+    LinkEstimator reliable;
+    LinkEstimator lossy;
+    for (int i = 0; i < 100; i++) {
+        reliable.sent();
+        reliable.received(20);
+        lossy.sent();
+        if (i % 2 == 0) lossy.received(20);
+    }
+    BOOST_CHECK_EQUAL(reliable.deliveryRatio(), 100);
+    BOOST_CHECK_EQUAL(lossy.deliveryRatio(), 50);
+    // every second ping has to be repeated
+    BOOST_CHECK_EQUAL(lossy.cost(), 2 * reliable.cost());
+
+    // a slower, but reliable connection is preferred over a lossy one
+    LinkEstimator slower;
+    for (int i = 0; i < 100; i++) {
+        slower.sent();
+        slower.received(30);
+    }
+    BOOST_CHECK_LT(slower.cost(), lossy.cost());
+    BOOST_CHECK_GT(slower.cost(), reliable.cost());
+}
+
+BOOST_AUTO_TEST_CASE(AgingTest) {
+    LinkEstimator estimator;
+    for (uint32_t i = 0; i < 70000; i++) {
+        estimator.sent();
+        if (i % 4 != 0) estimator.received(10);
+    }
+    // the counters are halved instead of overflowing, so the ratio is kept
+    BOOST_CHECK_LT(estimator.getSentCount(), UINT16_MAX);
+    BOOST_CHECK_GE(estimator.deliveryRatio(), 74);
+    BOOST_CHECK_LE(estimator.deliveryRatio(), 75);
+    BOOST_CHECK_EQUAL(estimator.quantile(50), 11);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
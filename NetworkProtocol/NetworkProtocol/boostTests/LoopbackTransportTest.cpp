@@ -0,0 +1,118 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE LoopbackTransportTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../loopbackTransport.h"
+#include "../networkHub.h"
+
+
+BOOST_AUTO_TEST_SUITE(LoopbackTransportTest)
+
+BOOST_AUTO_TEST_CASE(LatencyTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *first = medium.createTransport(1);
+    LoopbackTransport *second = medium.createTransport(2);
+    LoopbackTransport *third = medium.createTransport(3);
+    medium.connect(first, second, {5, 0, 0});
+
+    uint8_t package[PACKAGE_SIZE] = {42};
+    BOOST_CHECK(first->write(package, 2));
+    // the third transport is not in range
+    BOOST_CHECK(!first->write(package, 3));
+
+    medium.advance(4);
+    BOOST_CHECK(!second->messageAvailable());
+    medium.advance(1);
+    BOOST_REQUIRE(second->messageAvailable());
+
+    uint8_t received[PACKAGE_SIZE];
+    BOOST_CHECK_EQUAL(second->read(received), 1);
+    BOOST_CHECK_EQUAL(received[0], 42);
+    BOOST_CHECK(!second->messageAvailable());
+    BOOST_CHECK(!third->messageAvailable());
+
+    // the discovery channel reaches all transports in range
+    medium.connect(first, third, {0, 0, 0});
+    BOOST_CHECK(first->write(package, BROADCAST_ADDRESS));
+    BOOST_CHECK(third->messageAvailable());
+    medium.advance(5);
+    BOOST_CHECK(second->messageAvailable());
+    BOOST_CHECK_EQUAL(medium.getDeliveredCount(), 1);
+
+    // packages are only received for the current address
+    second->setAddress(7);
+    BOOST_CHECK(!first->write(package, 2));
+    BOOST_CHECK(first->write(package, 7));
+}
+
+BOOST_AUTO_TEST_CASE(BandwidthAndLossTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *sender = medium.createTransport(1);
+    LoopbackTransport *receiver = medium.createTransport(2);
+    // one package of 256 bits per millisecond
+    medium.connectOneWay(sender, receiver, {0, 0, PACKAGE_SIZE * 8 * 1000});
+
+    uint8_t package[PACKAGE_SIZE] = {};
+    for (uint8_t i = 0; i < 10; i++) {
+        package[0] = i;
+        sender->write(package, 2);
+    }
+
+    // the packages arrive one by one in their order
+    uint8_t received[PACKAGE_SIZE];
+    for (uint8_t i = 0; i < 10; i++) {
+        medium.advance(1);
+        BOOST_REQUIRE(receiver->messageAvailable());
+        receiver->read(received);
+        BOOST_CHECK_EQUAL(received[0], i);
+        BOOST_CHECK(!receiver->messageAvailable());
+    }
+
+    // the link is one way
+    BOOST_CHECK(!receiver->write(package, 1));
+
+    medium.connectOneWay(sender, receiver, {0, 0.5, 0});
+    for (int i = 0; i < 1000; i++) {
+        sender->write(package, 2);
+    }
+    BOOST_CHECK(medium.getLostCount() > 400 && medium.getLostCount() < 600);
+}
+
+BOOST_AUTO_TEST_CASE(DeviceTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *deviceTransport = medium.createTransport();
+    medium.connect(hubTransport, deviceTransport, {2, 0.1, 0});
+
+    NetworkHub hub(1000);
+    NetworkDevice device(5);
+    hub.setTransport(hubTransport);
+    device.setTransport(deviceTransport);
+    BOOST_CHECK_EQUAL(deviceTransport->getAddress(), 5);
+
+    // the data message is split into several packages, some of them are lost and sent again
+    uint8_t content[100];
+    for (uint8_t i = 0; i < 100; i++) {
+        content[i] = i;
+    }
+    BOOST_CHECK(device.send(0, content, 100));
+
+    bool received = false;
+    for (int i = 0; i < 2000 && !received; i++) {
+        device.update();
+        // the hub also gets the discoveries of the device
+        for (int j = 0; j < 8 && !received; j++) {
+            received = hub.update();
+        }
+        medium.advance(1);
+    }
+    BOOST_REQUIRE(received);
+
+    uint8_t *data;
+    BOOST_CHECK_EQUAL(hub.receive(&data), 100);
+    BOOST_CHECK_EQUAL_COLLECTIONS(data, data + 100, content, content + 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -83,22 +83,195 @@ BOOST_AUTO_TEST_CASE(MessageBuilderTest) {
 
 
             auto createdDataMessage = DataMessage();
-            bool messageBuilt = builder.newDataMessage(createdMsg, &createdDataMessage);
+            bool messageBuilt = builder.newDataMessage(createdMsg, &createdDataMessage, 0);
 
 
             if (j1 == numberPackages[i] - 1) {
                 BOOST_CHECK(messageBuilt);
-                BOOST_CHECK_EQUAL(createdDataMessage.contentSize, SLOT_COUNT(numberPackages[i]));
+                BOOST_CHECK_EQUAL(createdDataMessage.contentSize, contentSizes[i]);
                 for (int k = 0; k < contentSizes[i]; k++) {
                     BOOST_CHECK_EQUAL(createdDataMessage.content[k], content[k]);
                 }
             } else {
                 BOOST_CHECK(!messageBuilt);
             }
+
+            delete createdMsg;
         }
 
         Message::cleanUp(rawPackages);
     }
 }
 
+BOOST_AUTO_TEST_CASE(InterleavedMessagesTest) {
+    uint16_t contentSize = FIRST_DATA_PACKAGE_SLOTS + 2 * DATA_SLOTS;
+    uint8_t numberMessages = 3;
+
+    MessageBuilder builder(numberMessages);
+
+    uint8_t *contents[3];
+    uint8_t packages[3][3 * PACKAGE_SIZE];
+
+    for (int i = 0; i < numberMessages; i++) {
+        contents[i] = new uint8_t[contentSize];
+        for (int j = 0; j < contentSize; j++) {
+            contents[i][j] = std::rand() % 256;
+        }
+        // the message does not own the content, it is freed after the messages have been built
+        DataMessage msg = DataMessage(1, false, 42, i, contents[i], contentSize);
+        BOOST_CHECK_EQUAL(msg.writeRawPackages(packages[i]), 3);
+        msg.content = nullptr;
+    }
+
+    // packages of all messages arrive interleaved and in reverse order
+    for (int j = 2; j >= 0; j--) {
+        for (int i = 0; i < numberMessages; i++) {
+            DataMessage createdDataMessage = DataMessage();
+            bool messageBuilt = builder.newDataMessage(packages[i] + j * PACKAGE_SIZE, &createdDataMessage, 0);
+
+            BOOST_CHECK_EQUAL(messageBuilt, j == 0);
+            if (!messageBuilt) continue;
+
+            BOOST_CHECK_EQUAL(createdDataMessage.origin, i);
+            BOOST_CHECK_EQUAL(createdDataMessage.messageID, 42);
+            BOOST_CHECK(memcmp(createdDataMessage.content, contents[i], contentSize) == 0);
+        }
+    }
+
+    for (uint8_t *content : contents) {
+        delete[] content;
+    }
+
+    BOOST_CHECK_EQUAL(builder.getEvictedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(EvictionAndTimeoutTest) {
+    uint8_t content[DATA_SLOTS] = {};
+    uint8_t packages[4][PACKAGE_SIZE];
+
+    // second package of four different messages with two packages each
+    for (int i = 0; i < 4; i++) {
+        PartialDataMessage(1, false, 1, i, 7, content).writeRawPackage(packages[i]);
+    }
+    uint8_t firstPackage[PACKAGE_SIZE];
+    content[0] = 2;
+    content[1] = DATA_SLOTS;
+    PartialDataMessage(1, false, 0, 0, 7, content).writeRawPackage(firstPackage);
+
+    MessageBuilder builder(2, 100);
+    DataMessage createdDataMessage = DataMessage();
+
+    BOOST_CHECK(!builder.newDataMessage(packages[0], &createdDataMessage, 0));
+    BOOST_CHECK(!builder.newDataMessage(packages[1], &createdDataMessage, 10));
+
+    // the least recently updated message 0 is evicted, so its first package starts a new reassembly
+    BOOST_CHECK(!builder.newDataMessage(packages[2], &createdDataMessage, 20));
+    BOOST_CHECK_EQUAL(builder.getEvictedCount(), 1);
+    BOOST_CHECK(!builder.newDataMessage(firstPackage, &createdDataMessage, 30));
+    BOOST_CHECK_EQUAL(builder.getEvictedCount(), 2);
+
+    // message 2 expires, message 0 is still in time and completes
+    builder.update(125);
+    BOOST_CHECK_EQUAL(builder.getExpiredCount(), 1);
+    BOOST_CHECK(builder.newDataMessage(packages[0], &createdDataMessage, 125));
+    BOOST_CHECK_EQUAL(createdDataMessage.messageID, 0);
+
+    // a message without any further package expires
+    BOOST_CHECK(!builder.newDataMessage(packages[3], &createdDataMessage, 130));
+    builder.update(231);
+    BOOST_CHECK_EQUAL(builder.getExpiredCount(), 2);
+    BOOST_CHECK_EQUAL(builder.getEvictedCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(DuplicatePackagesTest) {
+    uint16_t contentSize = FIRST_DATA_PACKAGE_SLOTS + 3 * DATA_SLOTS;
+    uint8_t *content = new uint8_t[contentSize];
+
+    for (int i = 0; i < contentSize; i++) {
+        content[i] = std::rand() % 256;
+    }
+
+    DataMessage msg = DataMessage(1, false, 42, 7, content, contentSize);
+    uint8_t packages[4 * PACKAGE_SIZE];
+    BOOST_CHECK_EQUAL(msg.writeRawPackages(packages), 4);
+
+    MessageBuilder builder;
+    DataMessage createdDataMessage = DataMessage();
+
+    // packages arrive out of order with retransmissions, the first package arrives last
+    int order[] = {2, 2, 1, 3, 1, 3};
+    for (int packageNumber : order) {
+        BOOST_CHECK(!builder.newDataMessage(packages + packageNumber * PACKAGE_SIZE, &createdDataMessage, 0));
+    }
+    BOOST_CHECK_EQUAL(builder.getDuplicateCount(), 3);
+
+    BOOST_CHECK(builder.newDataMessage(packages, &createdDataMessage, 0));
+    BOOST_CHECK(memcmp(createdDataMessage.content, content, contentSize) == 0);
+
+    // late duplicates of the completed message neither complete it again nor start a new message
+    BOOST_CHECK(!builder.newDataMessage(packages + 2 * PACKAGE_SIZE, &createdDataMessage, 10));
+    BOOST_CHECK(!builder.newDataMessage(packages, &createdDataMessage, 10));
+    BOOST_CHECK_EQUAL(builder.getDuplicateCount(), 5);
+    BOOST_CHECK_EQUAL(builder.getEvictedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidPackageNumberTest) {
+    uint16_t contentSize = FIRST_DATA_PACKAGE_SLOTS + 2 * DATA_SLOTS;
+    uint8_t *content = new uint8_t[contentSize];
+
+    for (int i = 0; i < contentSize; i++) {
+        content[i] = std::rand() % 256;
+    }
+
+    DataMessage msg = DataMessage(1, false, 43, 7, content, contentSize);
+    uint8_t packages[3 * PACKAGE_SIZE];
+    BOOST_CHECK_EQUAL(msg.writeRawPackages(packages), 3);
+
+    // a package behind the last package, that arrives before the number of packages is known
+    uint8_t invalid[PACKAGE_SIZE];
+    memcpy(invalid, packages + 2 * PACKAGE_SIZE, PACKAGE_SIZE);
+    PackageNumberField::write(invalid, 5);
+
+    MessageBuilder builder;
+    DataMessage createdDataMessage = DataMessage();
+    BOOST_CHECK(!builder.newDataMessage(invalid, &createdDataMessage, 0));
+    BOOST_CHECK(!builder.newDataMessage(packages + PACKAGE_SIZE, &createdDataMessage, 0));
+
+    // the invalid package does not count, so the message is not complete without its last package
+    BOOST_CHECK(!builder.newDataMessage(packages, &createdDataMessage, 0));
+    BOOST_CHECK(!builder.newDataMessage(invalid, &createdDataMessage, 0));
+    BOOST_CHECK(builder.newDataMessage(packages + 2 * PACKAGE_SIZE, &createdDataMessage, 0));
+    BOOST_CHECK_EQUAL(createdDataMessage.contentSize, contentSize);
+    BOOST_CHECK(memcmp(createdDataMessage.content, content, contentSize) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSizeTest) {
+    uint16_t contentSize = FIRST_DATA_PACKAGE_SLOTS + DATA_SLOTS;
+    uint8_t *content = new uint8_t[contentSize];
+    memset(content, 7, contentSize);
+
+    DataMessage msg = DataMessage(1, false, 44, 7, content, contentSize);
+    uint8_t packages[2 * PACKAGE_SIZE];
+    BOOST_CHECK_EQUAL(msg.writeRawPackages(packages), 2);
+
+    // sizes of the last package, that do not fit into it, or messages without packages are dropped
+    MessageBuilder builder;
+    DataMessage createdDataMessage = DataMessage();
+    uint8_t forged[PACKAGE_SIZE];
+    uint8_t invalidSizes[][2] = {{2, DATA_SLOTS + 1}, {2, 255}, {2, 0}, {0, 1}, {1, FIRST_DATA_PACKAGE_SLOTS + 1}};
+    for (auto &sizes : invalidSizes) {
+        memcpy(forged, packages, PACKAGE_SIZE);
+        TotalPackagesField::write(forged, sizes[0]);
+        LastPackageSizeField::write(forged, sizes[1]);
+        BOOST_CHECK(!builder.newDataMessage(forged, &createdDataMessage, 0));
+    }
+    BOOST_CHECK(!builder.newDataMessage(packages + PACKAGE_SIZE, &createdDataMessage, 0));
+    BOOST_CHECK(createdDataMessage.content == nullptr);
+
+    // the valid first package still completes the message
+    BOOST_CHECK(builder.newDataMessage(packages, &createdDataMessage, 0));
+    BOOST_CHECK_EQUAL(createdDataMessage.contentSize, contentSize);
+    BOOST_CHECK(memcmp(createdDataMessage.content, content, contentSize) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,78 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE NeighborCacheTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../neighborCache.h"
+
+
+BOOST_AUTO_TEST_SUITE(NeighborCacheTest)
+
+BOOST_AUTO_TEST_CASE(SeenTest) {
+    NeighborCache cache(1000);
+    BOOST_CHECK(cache.get(3) == nullptr);
+
+    cache.seen(3, 2, 100);
+    cache.seen(0, 0, 200);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_REQUIRE(cache.get(3) != nullptr);
+    BOOST_CHECK_EQUAL(cache.get(3)->level, 2);
+    BOOST_CHECK_EQUAL(cache.get(3)->rtt, 0);
+
+    // hearing a neighbour again updates it
+    cache.seen(3, 1, 300);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK_EQUAL(cache.get(3)->level, 1);
+    BOOST_CHECK_EQUAL(cache.get(3)->lastSeen, 300);
+
+    // round trip times are only saved for cached neighbours
+    BOOST_CHECK(cache.setRtt(3, 12, 400));
+    BOOST_CHECK(!cache.setRtt(4, 12, 400));
+    BOOST_CHECK_EQUAL(cache.get(3)->rtt, 12);
+    BOOST_CHECK_EQUAL(cache.get(3)->lastSeen, 400);
+
+    BOOST_CHECK(cache.erase(3));
+    BOOST_CHECK(!cache.erase(3));
+    BOOST_CHECK(cache.get(3) == nullptr);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FreshTest) {
+    NeighborCache cache(1000);
+    cache.seen(1, 1, 0);
+    cache.seen(2, 1, 500);
+
+    uint8_t ids[NEIGHBOR_CACHE_SLOTS];
+    BOOST_CHECK_EQUAL(cache.fresh(1000, ids), 2);
+    // the first neighbour is stale, but stays cached until it is replaced
+    BOOST_REQUIRE_EQUAL(cache.fresh(1001, ids), 1);
+    BOOST_CHECK_EQUAL(ids[0], 2);
+    BOOST_CHECK_EQUAL(cache.fresh(2000, ids), 0);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    // the clock overflows
+    NeighborCache overflowCache(1000);
+    overflowCache.seen(3, 1, UINT32_MAX - 10);
+    BOOST_REQUIRE_EQUAL(overflowCache.fresh(100, ids), 1);
+    BOOST_CHECK_EQUAL(ids[0], 3);
+    BOOST_CHECK_EQUAL(overflowCache.fresh(1000, ids), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ReplaceTest) {
+    NeighborCache cache(1000);
+    for (uint8_t id = 0; id < NEIGHBOR_CACHE_SLOTS; id++) {
+        cache.seen(id, 1, 100 + id);
+    }
+    cache.seen(0, 1, 200);
+    BOOST_CHECK_EQUAL(cache.size(), NEIGHBOR_CACHE_SLOTS);
+
+    // the neighbour heard least recently is replaced
+    cache.seen(100, 1, 300);
+    BOOST_CHECK_EQUAL(cache.size(), NEIGHBOR_CACHE_SLOTS);
+    BOOST_CHECK(cache.get(1) == nullptr);
+    BOOST_CHECK(cache.get(0) != nullptr);
+    BOOST_CHECK(cache.get(100) != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
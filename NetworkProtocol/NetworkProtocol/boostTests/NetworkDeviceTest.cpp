@@ -0,0 +1,583 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE NetworkDeviceTest
+
+
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../loopbackTransport.h"
+#include "../networkHub.h"
+
+
+/**
+ * Updates the devices and advances the medium by one millisecond per step, until the predicate holds.
+ * @param medium The medium of the devices.
+ * @param devices The devices, updated in this order.
+ * @param predicate Checked before each step.
+ * @param limit Maximum number of steps.
+ * @return Number of steps run.
+ */
+static int runUntil(LoopbackMedium &medium, std::initializer_list<NetworkDevice*> devices,
+    const std::function<bool()> &predicate, int limit) {
+    int steps = 0;
+    for (; steps < limit && !predicate(); steps++) {
+        for (NetworkDevice *device : devices) device->update();
+        medium.advance(1);
+    }
+    return steps;
+}
+
+/**
+ * Updates the devices and advances the medium for the given time.
+ * @param medium The medium of the devices.
+ * @param devices The devices, updated in this order.
+ * @param time Time in milliseconds.
+ */
+static void run(LoopbackMedium &medium, std::initializer_list<NetworkDevice*> devices, int time) {
+    runUntil(medium, devices, [] { return false; }, time);
+}
+
+
+BOOST_AUTO_TEST_SUITE(NetworkDeviceTest)
+
+BOOST_AUTO_TEST_CASE(RegistrationTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    // the second device is only in range of the first one
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    // devices without ID must not use the same temporary ID
+    secondTransport->setClockOffset(7);
+
+    NetworkHub hub(100);
+    NetworkDevice first(0, 100);
+    NetworkDevice second(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    second.setTransport(secondTransport);
+    BOOST_CHECK_EQUAL(firstTransport->getAddress(), DISCOVERY_CHANNEL);
+
+    runUntil(medium, {&hub, &first, &second},
+        [&] { return first.isRegistered() && second.isRegistered(); }, 5000);
+    BOOST_REQUIRE(first.isRegistered());
+    BOOST_REQUIRE(second.isRegistered());
+
+    BOOST_CHECK_NE(first.getID(), 0);
+    BOOST_CHECK_NE(second.getID(), 0);
+    BOOST_CHECK_NE(first.getID(), second.getID());
+    BOOST_CHECK_EQUAL(firstTransport->getAddress(), first.getID());
+    BOOST_CHECK_EQUAL(first.getParent(), 0);
+    BOOST_CHECK_EQUAL(second.getParent(), first.getID());
+    BOOST_CHECK_EQUAL(second.getHierarchyLevel(), 2);
+
+    // the hub reaches the second device over the first one
+    BOOST_CHECK_EQUAL(hub.getRoutingTable().nextHop(second.getID(), 0), first.getID());
+    BOOST_CHECK_EQUAL(first.getRoutingTable().nextHop(second.getID(), 0), second.getID());
+}
+
+BOOST_AUTO_TEST_CASE(TempIDCollisionTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    // both devices boot at the same time, so they use the same temporary ID
+    firstTransport->setClockOffset(5);
+    secondTransport->setClockOffset(5);
+
+    NetworkHub hub(100);
+    NetworkDevice first(0, 100);
+    NetworkDevice second(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    second.setTransport(secondTransport);
+    runUntil(medium, {&hub, &first, &second}, [&] { return first.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+
+    // the hub remembers the ID of the first device for its temporary ID, but must not give it to the second one
+    medium.connect(hubTransport, secondTransport, {2, 0, 0});
+    runUntil(medium, {&hub, &first, &second}, [&] { return second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_CHECK_NE(second.getID(), first.getID());
+    BOOST_CHECK_EQUAL(hub.getRoutingTable().nextHop(first.getID(), 0), first.getID());
+    BOOST_CHECK_EQUAL(hub.getRoutingTable().nextHop(second.getID(), 0), second.getID());
+}
+
+BOOST_AUTO_TEST_CASE(DiscoveryTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    LoopbackTransport *thirdTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(hubTransport, secondTransport, {2, 0, 0});
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    medium.connect(firstTransport, thirdTransport, {2, 0, 0});
+    secondTransport->setClockOffset(7);
+    thirdTransport->setClockOffset(13);
+
+    NetworkHub hub(1000);
+    NetworkDevice first(0, 1000);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    runUntil(medium, {&hub, &first}, [&] { return first.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+
+    // the broadcast is answered by the hub and the first device, long before the discovery timeout
+    NetworkDevice second(0, 1000);
+    second.setTransport(secondTransport);
+    int time = runUntil(medium, {&hub, &first, &second}, [&] { return second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_CHECK_LT(time, 200);
+    BOOST_CHECK_EQUAL(second.getParent(), 0);
+
+    // discovering by pinging each ID still works
+    NetworkDevice third(0, 1000);
+    third.setBroadcastDiscovery(false);
+    third.setTransport(thirdTransport);
+    runUntil(medium, {&hub, &first, &second, &third}, [&] { return third.isRegistered(); }, 5000);
+    BOOST_REQUIRE(third.isRegistered());
+    BOOST_CHECK_EQUAL(third.getParent(), first.getID());
+}
+
+BOOST_AUTO_TEST_CASE(DiscoveryEchoTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *otherTransport = medium.createTransport(DISCOVERY_CHANNEL);
+    LoopbackTransport *deviceTransport = medium.createTransport();
+    medium.connect(hubTransport, otherTransport, {2, 0, 0});
+    medium.connect(hubTransport, deviceTransport, {2, 0, 0});
+    deviceTransport->setClockOffset(7);
+
+    NetworkHub hub(1000);
+    hub.setTransport(hubTransport);
+    run(medium, {&hub}, 100);
+
+    // another device discovers right before, so the pending answer of the hub echoes the time of its request
+    uint8_t package[PACKAGE_SIZE];
+    RegistrationMessage request = RegistrationMessage(DISCOVERY_CHANNEL, 0, otherTransport->getTime() - 50, 0, 255);
+    request.requester = 4242;
+    request.writeRawPackage(package);
+    BOOST_REQUIRE(otherTransport->write(package, DISCOVERY_CHANNEL));
+
+    NetworkDevice device(0, 1000);
+    device.setTransport(deviceTransport);
+    runUntil(medium, {&hub, &device}, [&] { return device.isRegistered(); }, 3000);
+    BOOST_REQUIRE(device.isRegistered());
+
+    // the answer carries the temporary ID of the other device
+    bool answered = false;
+    while (otherTransport->messageAvailable()) {
+        otherTransport->read(package);
+        RegistrationMessage answer = RegistrationMessage(package);
+        if (answer.registrationType == 0 && answer.extraField != 255) answered = answered || answer.requester == 4242;
+    }
+    BOOST_CHECK(answered);
+
+    // so the device does not take the echo of the other request as its round trip time
+    BOOST_REQUIRE(device.getNeighbors().get(0) != nullptr);
+    BOOST_CHECK_LT(device.getNeighbors().get(0)->rtt, 20);
+
+    // a routed answer to a ping, that took long on its way over other devices, does not change it either
+    uint16_t rtt = device.getNeighbors().get(0)->rtt;
+    PingMessage(device.getID(), 7, 0, true, deviceTransport->getTime() - 500).writeRawPackage(package);
+    BOOST_REQUIRE(hubTransport->write(package, device.getID()));
+    run(medium, {&device}, 10);
+    BOOST_CHECK_EQUAL(device.getNeighbors().get(0)->rtt, rtt);
+}
+
+BOOST_AUTO_TEST_CASE(RediscoveryTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(hubTransport, secondTransport, {2, 0, 0});
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    secondTransport->setClockOffset(7);
+
+    NetworkHub hub(100);
+    NetworkDevice first(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    runUntil(medium, {&hub, &first}, [&] { return first.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+
+    NetworkDevice second(0, 100);
+    second.setTransport(secondTransport);
+    second.setBroadcastDiscovery(false);
+    run(medium, {&hub, &first, &second}, 3000);
+    BOOST_REQUIRE(second.isRegistered());
+    // the answers of the hub and the first device to the discoveries have been heard
+    BOOST_REQUIRE(second.getNeighbors().get(0) != nullptr);
+    BOOST_CHECK_EQUAL(second.getNeighbors().get(0)->level, 0);
+    BOOST_REQUIRE(second.getNeighbors().get(first.getID()) != nullptr);
+    BOOST_CHECK_EQUAL(second.getNeighbors().get(first.getID())->level, 1);
+    BOOST_CHECK(!hub.rediscover());
+
+    // the first device moves out of range, the rediscovery only asks the cached neighbours instead of all IDs
+    medium.disconnect(firstTransport, secondTransport);
+    uint64_t sent = medium.getSentCount();
+    BOOST_REQUIRE(second.rediscover());
+    BOOST_CHECK(!second.rediscover());
+    run(medium, {&hub, &first, &second}, DISCOVERY_WINDOW + 2);
+    BOOST_CHECK_LT(medium.getSentCount() - sent, 10);
+    BOOST_CHECK(second.getNeighbors().get(0) != nullptr);
+    BOOST_CHECK(second.getNeighbors().get(first.getID()) == nullptr);
+
+    // the hub answered, so its connection is benchmarked with the responses to the pings
+    run(medium, {&hub, &first, &second}, 100);
+    BOOST_REQUIRE(second.getBenchmark() != nullptr);
+    const LinkEstimator *estimator = second.getBenchmark()->getEstimator(0);
+    BOOST_REQUIRE(estimator != nullptr);
+    BOOST_CHECK_GE(estimator->getReceivedCount(), BENCHMARK_MIN_PINGS);
+    BOOST_CHECK_EQUAL(estimator->deliveryRatio(), 100);
+    BOOST_CHECK_GE(estimator->getRtt(), 4);
+    // the hub is the only device left, so the benchmark stops early
+    BOOST_CHECK(second.getBenchmark()->finished());
+    BOOST_CHECK_LT(estimator->getSentCount(), BENCHMARK_PINGS);
+    BOOST_CHECK(second.isIdle());
+}
+
+BOOST_AUTO_TEST_CASE(DirectBenchmarkTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(hubTransport, secondTransport, {2, 0, 0});
+    medium.connect(firstTransport, secondTransport, {20, 0, 0});
+
+    NetworkHub hub(1000);
+    NetworkDevice first(0, 1000);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    runUntil(medium, {&hub, &first}, [&] { return first.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+
+    NetworkDevice second(0, 1000);
+    second.setTransport(secondTransport);
+    second.setBroadcastDiscovery(false);
+    runUntil(medium, {&hub, &first, &second}, [&] { return second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_REQUIRE_EQUAL(second.getParent(), 0);
+
+    // the route to the first device leads over the hub, but the benchmark measures the slow link to it
+    BOOST_REQUIRE(second.rediscover());
+    uint8_t pingID = second.ping(first.getID());
+    runUntil(medium, {&hub, &first, &second}, [&] {
+        return second.getBenchmark() != nullptr && second.getBenchmark()->finished();
+    }, 3000);
+    BOOST_REQUIRE(second.getBenchmark() != nullptr);
+    const LinkEstimator *estimator = second.getBenchmark()->getEstimator(first.getID());
+    BOOST_REQUIRE(estimator != nullptr);
+    BOOST_REQUIRE_GT(estimator->getReceivedCount(), 0);
+    BOOST_CHECK_GE(estimator->getRtt(), 40);
+    BOOST_CHECK_LT(second.getBenchmark()->getEstimator(0)->getRtt(), 20);
+
+    // the benchmark takes other IDs than the pings of the device, so the response is not taken by it
+    BOOST_CHECK_GT(second.checkPing(pingID), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ParentSelectionTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(hubTransport, secondTransport, {15, 0, 0});
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    secondTransport->setClockOffset(7);
+
+    NetworkHub hub(1000);
+    NetworkDevice first(0, 1000);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    runUntil(medium, {&hub, &first}, [&] { return first.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+
+    // the slow link to the hub costs more than the extra hop over the first device
+    NetworkDevice second(0, 1000);
+    second.setTransport(secondTransport);
+    second.setBroadcastDiscovery(false);
+    runUntil(medium, {&hub, &first, &second}, [&] { return second.getParent() == first.getID(); }, 3000);
+    BOOST_REQUIRE_EQUAL(second.getParent(), first.getID());
+    BOOST_CHECK(!second.isRegistered());
+
+    // the first device is gone before the request arrives, so the next candidate is tried without a new discovery
+    medium.disconnect(firstTransport, secondTransport);
+    runUntil(medium, {&hub, &first, &second}, [&] { return second.isRegistered(); }, 1100);
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_CHECK_EQUAL(second.getParent(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(LivenessTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    secondTransport->setClockOffset(7);
+
+    // each device is pinged every 200 ms
+    NetworkHub hub(100, 200);
+    NetworkDevice first(0, 100);
+    NetworkDevice second(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    second.setTransport(secondTransport);
+
+    run(medium, {&hub, &first, &second}, 3000);
+    // devices that answer the pings stay connected, also behind another device
+    BOOST_REQUIRE(first.isRegistered());
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_CHECK(hub.getRoutingTable().contains(second.getID()));
+
+    // the answers of the second device are lost, so the hub disconnects it, but it still receives the disconnect
+    // through the first device and registers again with its ID
+    uint8_t secondID = second.getID();
+    medium.disconnect(firstTransport, secondTransport);
+    medium.connectOneWay(firstTransport, secondTransport, {2, 0, 0});
+    runUntil(medium, {&hub, &first, &second}, [&] { return !second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(!second.isRegistered());
+    BOOST_CHECK(!hub.getRoutingTable().contains(secondID));
+    medium.connect(firstTransport, secondTransport, {2, 0, 0});
+    runUntil(medium, {&hub, &first, &second}, [&] { return second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(second.isRegistered());
+    BOOST_CHECK_EQUAL(second.getID(), secondID);
+    BOOST_CHECK(hub.getRoutingTable().contains(secondID));
+    // it stays connected, since it answers again
+    run(medium, {&hub, &first, &second}, 3000);
+    BOOST_CHECK(second.isRegistered());
+    BOOST_CHECK(hub.getRoutingTable().contains(secondID));
+
+    // the second device is switched off
+    medium.disconnect(firstTransport, secondTransport);
+    run(medium, {&hub, &first}, 3000);
+    BOOST_CHECK(!hub.getRoutingTable().contains(second.getID()));
+    BOOST_CHECK(!first.getRoutingTable().contains(second.getID()));
+    BOOST_CHECK(hub.getRoutingTable().contains(first.getID()));
+    BOOST_CHECK(first.isRegistered());
+}
+
+BOOST_AUTO_TEST_CASE(AggregationTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *deviceTransport = medium.createTransport();
+    medium.connect(hubTransport, deviceTransport, {2, 0, 0});
+
+    NetworkHub hub(100);
+    NetworkDevice device(0, 100);
+    hub.setTransport(hubTransport);
+    device.setTransport(deviceTransport);
+    run(medium, {&hub, &device}, 3000);
+    BOOST_REQUIRE(device.isRegistered());
+
+    hub.setAggregationWindow(5);
+    device.setAggregationWindow(5);
+    uint64_t sent = medium.getSentCount();
+    uint8_t pings[3];
+    for (uint8_t &ping : pings) {
+        ping = hub.ping(device.getID());
+    }
+    run(medium, {&hub, &device}, 100);
+    for (uint8_t ping : pings) {
+        BOOST_CHECK_GT(hub.checkPing(ping), 0);
+    }
+    // one frame of pings, one frame of responses and their acknowledgements
+    BOOST_CHECK_EQUAL(medium.getSentCount() - sent, 4);
+}
+
+BOOST_AUTO_TEST_CASE(GroupPruningTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *memberTransport = medium.createTransport();
+    LoopbackTransport *otherTransport = medium.createTransport();
+    // both devices are children of the hub
+    medium.connect(hubTransport, memberTransport, {2, 0, 0});
+    medium.connect(hubTransport, otherTransport, {2, 0, 0});
+    otherTransport->setClockOffset(7);
+
+    NetworkHub hub(100);
+    NetworkDevice member(0, 100);
+    NetworkDevice other(0, 100);
+    hub.setTransport(hubTransport);
+    member.setTransport(memberTransport);
+    other.setTransport(otherTransport);
+
+    GroupSet groups;
+    groups.add(5);
+    member.setGroups(groups);
+
+    // run beyond the registration, so the group summaries arrive at the hub
+    run(medium, {&hub, &member, &other}, 3000);
+    BOOST_REQUIRE(member.isRegistered());
+    BOOST_REQUIRE(other.isRegistered());
+    BOOST_CHECK(hub.getSubtreeGroups().contains(5));
+    BOOST_CHECK(!other.getSubtreeGroups().contains(5));
+
+    uint8_t data[4] = {1, 2, 3, 4};
+    uint64_t sent = medium.getSentCount();
+    BOOST_REQUIRE(hub.sendToGroup(5, data, sizeof(data)));
+
+    run(medium, {&hub, &member, &other}, 100);
+    uint8_t *received;
+    BOOST_CHECK_EQUAL(member.receive(&received), sizeof(data));
+    BOOST_CHECK_EQUAL(other.receive(&received), 0);
+    // the package to the member and its acknowledgement, the branch without members is skipped
+    BOOST_CHECK_EQUAL(medium.getSentCount() - sent, 2);
+}
+
+BOOST_AUTO_TEST_CASE(GroupSummaryRetryTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *memberTransport = medium.createTransport();
+    medium.connect(hubTransport, memberTransport, {2, 0, 0});
+
+    NetworkHub hub(100);
+    NetworkDevice member(0, 100);
+    hub.setTransport(hubTransport);
+    member.setTransport(memberTransport);
+    runUntil(medium, {&hub, &member}, [&] { return member.isRegistered(); }, 3000);
+    BOOST_REQUIRE(member.isRegistered());
+    run(medium, {&hub, &member}, 100);
+
+    // the packages of a long message fill the send queue, so the summary of the new group cannot be queued
+    uint8_t content[FIRST_DATA_PACKAGE_SLOTS + 39 * DATA_SLOTS] = {};
+    BOOST_REQUIRE(member.send(0, content, sizeof(content)));
+    GroupSet groups;
+    groups.add(5);
+    member.setGroups(groups);
+    BOOST_CHECK(!member.isIdle());
+
+    // the summary is sent once the queue has room again
+    run(medium, {&hub, &member}, 3000);
+    uint8_t *data;
+    BOOST_CHECK_EQUAL(hub.receive(&data), sizeof(content));
+    BOOST_CHECK(hub.getSubtreeGroups().contains(5));
+}
+
+BOOST_AUTO_TEST_CASE(ReassemblyMemoryTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    // one package per millisecond on each link
+    medium.connect(hubTransport, firstTransport, {2, 0, PACKAGE_SIZE * 8 * 1000});
+    medium.connect(hubTransport, secondTransport, {2, 0, PACKAGE_SIZE * 8 * 1000});
+    secondTransport->setClockOffset(7);
+
+    // the memory of the hub only fits one message at a time
+    NetworkHub hub(100, 0, sizeof(ReassemblySlot));
+    NetworkDevice first(0, 100);
+    NetworkDevice second(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    second.setTransport(secondTransport);
+    runUntil(medium, {&hub, &first, &second},
+        [&] { return first.isRegistered() && second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+    BOOST_REQUIRE(second.isRegistered());
+
+    // the packages of both messages arrive interleaved, so each message evicts the other one
+    uint8_t content[100] = {};
+    BOOST_REQUIRE(first.send(0, content, sizeof(content)));
+    BOOST_REQUIRE(second.send(0, content, sizeof(content)));
+    run(medium, {&hub, &first, &second}, 100);
+    BOOST_CHECK_GT(hub.getEvictedMessages(), 0);
+
+    // the evicted message is missing its first packages, so it expires
+    run(medium, {&hub, &first, &second}, REASSEMBLY_TIMEOUT + 100);
+    BOOST_CHECK_GT(hub.getExpiredMessages(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BlockedNeighbourTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *firstTransport = medium.createTransport();
+    LoopbackTransport *secondTransport = medium.createTransport();
+    medium.connect(hubTransport, firstTransport, {2, 0, 0});
+    medium.connect(hubTransport, secondTransport, {2, 0, 0});
+    secondTransport->setClockOffset(7);
+
+    NetworkHub hub(100);
+    NetworkDevice first(0, 100);
+    NetworkDevice second(0, 100);
+    hub.setTransport(hubTransport);
+    first.setTransport(firstTransport);
+    second.setTransport(secondTransport);
+    runUntil(medium, {&hub, &first, &second},
+        [&] { return first.isRegistered() && second.isRegistered(); }, 3000);
+    BOOST_REQUIRE(first.isRegistered());
+    BOOST_REQUIRE(second.isRegistered());
+    run(medium, {&hub, &first, &second}, 100);
+
+    // the first device is switched off, the messages to it fill its window and wait in the send queue
+    medium.disconnect(hubTransport, firstTransport);
+    uint8_t content[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (uint8_t i = 0; i < ARQ_WINDOW + 1; i++) {
+        BOOST_REQUIRE(hub.send(first.getID(), content, sizeof(content)));
+    }
+    BOOST_REQUIRE(hub.send(second.getID(), content, sizeof(content)));
+
+    // the message to the second device passes them
+    bool received = false;
+    for (int i = 0; i < 50 && !received; i++) {
+        hub.update();
+        received = second.update();
+        medium.advance(1);
+    }
+    BOOST_CHECK(received);
+}
+
+BOOST_AUTO_TEST_CASE(SendQueueTest) {
+    LoopbackMedium medium;
+    LoopbackTransport *hubTransport = medium.createTransport();
+    LoopbackTransport *deviceTransport = medium.createTransport();
+    medium.connect(hubTransport, deviceTransport, {2, 0, 0});
+
+    NetworkHub hub(100);
+    NetworkDevice device(0, 100);
+    hub.setTransport(hubTransport);
+    device.setTransport(deviceTransport);
+    runUntil(medium, {&hub, &device}, [&] { return device.isRegistered(); }, 3000);
+    BOOST_REQUIRE(device.isRegistered());
+    run(medium, {&hub, &device}, 100);
+
+    // the number of packages has to fit into one byte
+    uint8_t large[MAX_DATA_SIZE + 1] = {};
+    BOOST_CHECK(!device.send(0, large, 0));
+    BOOST_CHECK(!device.send(0, large, sizeof(large)));
+
+    // sending only queues the packages, the packages that do not fit into the send queue are queued by the updates
+    uint8_t content[FIRST_DATA_PACKAGE_SLOTS + 39 * DATA_SLOTS];
+    for (uint16_t i = 0; i < sizeof(content); i++) content[i] = i;
+    uint64_t sent = medium.getSentCount();
+    BOOST_REQUIRE(device.send(0, content, sizeof(content)));
+    BOOST_CHECK_EQUAL(medium.getSentCount(), sent);
+    // the message is not sent in parts, so the next one waits until all its packages are queued
+    uint8_t next[1] = {42};
+    BOOST_CHECK(!device.send(0, next, sizeof(next)));
+    memset(content, 0, sizeof(content));
+
+    bool received = false;
+    for (int step = 0; step < 3000 && !received; step++) {
+        received = hub.update();
+        device.update();
+        medium.advance(1);
+    }
+    BOOST_REQUIRE(received);
+    uint8_t *data;
+    BOOST_REQUIRE_EQUAL(hub.receive(&data), sizeof(content));
+    for (uint16_t i = 0; i < sizeof(content); i++) BOOST_REQUIRE_EQUAL(data[i], static_cast<uint8_t>(i));
+    BOOST_CHECK_EQUAL(device.getDroppedPackages(), 0);
+    BOOST_CHECK(device.send(0, next, sizeof(next)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
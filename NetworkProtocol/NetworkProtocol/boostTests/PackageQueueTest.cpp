@@ -0,0 +1,98 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PackageQueueTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../packageQueue.h"
+
+
+BOOST_AUTO_TEST_SUITE(PackageQueueTest)
+
+BOOST_AUTO_TEST_CASE(PushPopTest) {
+    PackageQueue<4> queue;
+    uint8_t package[PACKAGE_SIZE];
+
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+
+    // wrap around the ring several times
+    uint8_t nextIn = 0;
+    uint8_t nextOut = 0;
+    for (int round = 0; round < 300; ++round) {
+        while (!queue.full()) {
+            memset(package, nextIn, PACKAGE_SIZE);
+            BOOST_CHECK(queue.push(package, nextIn));
+            nextIn++;
+        }
+        BOOST_CHECK_EQUAL(queue.size(), 4);
+        BOOST_CHECK(!queue.push(package, 0));
+
+        for (int i = 0; i < 3; ++i) {
+            QueuedPackage &front = queue.front();
+            BOOST_CHECK_EQUAL(front.link, nextOut);
+            BOOST_CHECK_EQUAL(front.package[0], nextOut);
+            BOOST_CHECK_EQUAL(front.package[PACKAGE_SIZE - 1], nextOut);
+            BOOST_CHECK_EQUAL(front.attempts, 0);
+            queue.pop();
+            nextOut++;
+        }
+        BOOST_CHECK_EQUAL(queue.size(), 1);
+    }
+    BOOST_CHECK_EQUAL(queue.getDroppedCount(), 300);
+}
+
+BOOST_AUTO_TEST_CASE(ReserveTest) {
+    PackageQueue<2> queue;
+
+    QueuedPackage *slot = queue.reserve();
+    BOOST_REQUIRE(slot != nullptr);
+    slot->package[0] = 7;
+    slot->link = 3;
+    // a reserved slot is not part of the queue until it is committed
+    BOOST_CHECK(queue.empty());
+    queue.commit();
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+
+    queue.reserve();
+    queue.commit();
+    BOOST_CHECK(queue.reserve() == nullptr);
+
+    BOOST_CHECK_EQUAL(queue.front().package[0], 7);
+    BOOST_CHECK_EQUAL(queue.front().link, 3);
+}
+
+BOOST_AUTO_TEST_CASE(RotateTest) {
+    PackageQueue<4> queue;
+    uint8_t package[PACKAGE_SIZE];
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(package, i, PACKAGE_SIZE);
+        queue.push(package, i);
+    }
+
+    // the first package goes behind the last one
+    queue.rotate();
+    BOOST_CHECK_EQUAL(queue.size(), 3);
+    uint8_t expected[] = {1, 2, 0};
+    for (uint8_t link : expected) {
+        BOOST_CHECK_EQUAL(queue.front().link, link);
+        BOOST_CHECK_EQUAL(queue.front().package[PACKAGE_SIZE - 1], link);
+        queue.pop();
+    }
+
+    // in a full queue the package stays in its slot
+    for (uint8_t i = 0; i < 4; i++) {
+        memset(package, i, PACKAGE_SIZE);
+        queue.push(package, i);
+    }
+    queue.rotate();
+    BOOST_CHECK(queue.full());
+    for (uint8_t link : {1, 2, 3, 0}) {
+        BOOST_CHECK_EQUAL(queue.front().link, link);
+        BOOST_CHECK_EQUAL(queue.front().package[0], link);
+        queue.pop();
+    }
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
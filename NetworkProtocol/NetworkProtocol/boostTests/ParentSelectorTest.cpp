@@ -0,0 +1,82 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ParentSelectorTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../parentSelector.h"
+
+
+BOOST_AUTO_TEST_SUITE(ParentSelectorTest)
+
+BOOST_AUTO_TEST_CASE(CostTest) {
+    // unknown round trip time, level 0, all slots free
+    ParentCandidate candidate = {1, 0, 4, UINT16_MAX, 100, 0};
+    BOOST_CHECK_EQUAL(ParentSelector::cost(candidate), PARENT_UNKNOWN_RTT + PARENT_HOP_COST);
+
+    // each hop and each taken slot add to the cost
+    candidate = {1, 2, 1, 20, 100, 0};
+    BOOST_CHECK_EQUAL(ParentSelector::cost(candidate), 20 + 3 * PARENT_HOP_COST + 3 * PARENT_SLOT_COST);
+
+    // lost packages are repeated, so the round trip time is divided by the delivery ratio
+    candidate = {1, 0, 4, 20, 50, 0};
+    BOOST_CHECK_EQUAL(ParentSelector::cost(candidate), 40 + PARENT_HOP_COST);
+
+    candidate.deliveryRatio = 0;
+    BOOST_CHECK(ParentSelector::cost(candidate) > 40 + PARENT_HOP_COST);
+}
+
+BOOST_AUTO_TEST_CASE(AcceptableTest) {
+    ParentCandidate candidate = {1, 0, 4, UINT16_MAX, 100, 0};
+    BOOST_CHECK(ParentSelector::acceptable(candidate));
+    candidate.rtt = PARENT_MAX_RTT;
+    BOOST_CHECK(ParentSelector::acceptable(candidate));
+    candidate.rtt = PARENT_MAX_RTT + 1;
+    BOOST_CHECK(!ParentSelector::acceptable(candidate));
+    candidate.rtt = 10;
+    candidate.deliveryRatio = PARENT_MIN_DELIVERY - 1;
+    BOOST_CHECK(!ParentSelector::acceptable(candidate));
+}
+
+BOOST_AUTO_TEST_CASE(OrderTest) {
+    ParentSelector selector;
+    ParentCandidate candidate;
+    BOOST_CHECK(!selector.next(&candidate));
+
+    // deep, but fast link
+    selector.add(1, 3, 4, 2, 100);
+    // shallow, but slow link
+    selector.add(2, 0, 4, 80, 100);
+    // shallow and fast, but lossy link
+    selector.add(3, 0, 4, 2, 50);
+    // shallow and fast, but full
+    selector.add(4, 1, 1, 5, 100);
+    // lowest cost, but too slow
+    selector.add(5, 0, 4, PARENT_MAX_RTT + 1, 100);
+    BOOST_CHECK_EQUAL(selector.size(), 5);
+
+    // candidates are tried from the lowest cost on, the ones below the thresholds last
+    uint8_t expected[] = {4, 1, 2, 3, 5};
+    for (uint8_t id : expected) {
+        BOOST_REQUIRE(selector.next(&candidate));
+        BOOST_CHECK_EQUAL(candidate.id, id);
+    }
+    BOOST_CHECK(!selector.next(&candidate));
+    BOOST_CHECK_EQUAL(selector.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TieTest) {
+    ParentSelector selector;
+    // same cost, the device closer to the hub is preferred
+    selector.add(1, 1, 4, 10, 100);
+    selector.add(2, 0, 4, 20, 100);
+    ParentCandidate candidate;
+    BOOST_REQUIRE(selector.next(&candidate));
+    BOOST_CHECK_EQUAL(candidate.id, 2);
+    BOOST_CHECK_EQUAL(candidate.cost, 20 + PARENT_HOP_COST);
+
+    selector.clear();
+    BOOST_CHECK(!selector.next(&candidate));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,215 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ReliableLinkTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../reliableLink.h"
+
+
+/**
+ * Sends numberPackages packages from the sender to the receiver. Every lossEvery-th package and acknowledgement is lost.
+ * @return Time needed until all packages have been acknowledged.
+ */
+static uint32_t transfer(ReliableLink &sender, ReliableLink &receiver, uint16_t numberPackages, uint16_t lossEvery,
+    uint32_t latency, bool *received) {
+    uint8_t package[PACKAGE_SIZE];
+    uint16_t nextPackage = 0;
+    uint32_t sent = 0;
+    uint32_t time = 0;
+
+    auto deliver = [&](const uint8_t *rawPackage) {
+        if (lossEvery > 0 && ++sent % lossEvery == 0) return;
+        uint8_t transmission = Message::transmissionOf(rawPackage);
+        BOOST_REQUIRE(transmission & RELIABLE_FLAG);
+        uint16_t number = rawPackage[3] | rawPackage[4] << 8;
+        bool isNew = receiver.receive(transmission & SEQUENCE_MASK);
+        // each package is handed over exactly once
+        BOOST_CHECK_EQUAL(isNew, !received[number]);
+        received[number] = true;
+    };
+
+    while (nextPackage < numberPackages || sender.inFlight() > 0) {
+        while (nextPackage < numberPackages && sender.canSend()) {
+            memset(package, 0, PACKAGE_SIZE);
+            package[3] = nextPackage;
+            package[4] = nextPackage >> 8;
+            deliver(sender.send(package, time));
+            nextPackage++;
+        }
+
+        time += latency;
+        uint8_t cumulativeAck;
+        uint32_t selectiveAcks;
+        if (receiver.takeAck(&cumulativeAck, &selectiveAcks) && !(lossEvery > 0 && ++sent % lossEvery == 0)) {
+            sender.acknowledge(cumulativeAck, selectiveAcks, time);
+        }
+
+        const uint8_t *retransmission;
+        while ((retransmission = sender.pollRetransmission(time)) != nullptr) {
+            deliver(retransmission);
+        }
+        BOOST_REQUIRE(time < 1000000);
+    }
+    return time;
+}
+
+BOOST_AUTO_TEST_SUITE(ReliableLinkTest)
+
+BOOST_AUTO_TEST_CASE(ReceiveTest) {
+    ReliableLink link;
+    uint8_t cumulativeAck;
+    uint32_t selectiveAcks;
+
+    BOOST_CHECK(!link.takeAck(&cumulativeAck, &selectiveAcks));
+
+    // the first package synchronizes the link
+    BOOST_CHECK(link.receive(120));
+    BOOST_CHECK(link.receive(122));
+    BOOST_CHECK(link.receive(124));
+    BOOST_CHECK(!link.receive(122));
+    BOOST_CHECK(link.takeAck(&cumulativeAck, &selectiveAcks));
+    BOOST_CHECK_EQUAL(cumulativeAck, 121);
+    BOOST_CHECK_EQUAL(selectiveAcks, 0b101);
+    BOOST_CHECK(!link.takeAck(&cumulativeAck, &selectiveAcks));
+
+    // the hole is filled, so the cumulative acknowledgement moves behind all packages received in a row
+    BOOST_CHECK(link.receive(121));
+    BOOST_CHECK(!link.receive(120));
+    BOOST_CHECK(link.takeAck(&cumulativeAck, &selectiveAcks));
+    BOOST_CHECK_EQUAL(cumulativeAck, 123);
+    BOOST_CHECK_EQUAL(selectiveAcks, 0b1);
+
+    // sequence numbers wrap around
+    BOOST_CHECK(link.receive(123));
+    for (uint8_t sequence = 125; sequence != 3; sequence = (sequence + 1) & SEQUENCE_MASK) {
+        BOOST_CHECK(link.receive(sequence));
+    }
+    BOOST_CHECK(link.takeAck(&cumulativeAck, &selectiveAcks));
+    BOOST_CHECK_EQUAL(cumulativeAck, 3);
+    BOOST_CHECK_EQUAL(selectiveAcks, 0);
+
+    // a neighbour that lost the state of the link starts again
+    BOOST_CHECK(link.receive(60));
+    BOOST_CHECK(link.takeAck(&cumulativeAck, &selectiveAcks));
+    BOOST_CHECK_EQUAL(cumulativeAck, 61);
+}
+
+BOOST_AUTO_TEST_CASE(UnsendTest) {
+    ReliableLink link;
+    uint8_t package[PACKAGE_SIZE] = {};
+
+    // a package that could not be written is sent again right away instead of after the timeout
+    const uint8_t *sent = link.send(package, 0);
+    BOOST_CHECK(link.pollRetransmission(0) == nullptr);
+    link.unsend(sent);
+    BOOST_CHECK(link.pollRetransmission(0) == sent);
+    BOOST_CHECK(link.pollRetransmission(0) == nullptr);
+    BOOST_CHECK_EQUAL(link.inFlight(), 1);
+
+    // the same for a retransmission, which is then not counted
+    uint32_t retransmissions = link.retransmissions;
+    const uint8_t *retransmission = link.pollRetransmission(ARQ_INITIAL_RTO + 1);
+    BOOST_REQUIRE(retransmission == sent);
+    link.unsend(retransmission);
+    BOOST_CHECK_EQUAL(link.retransmissions, retransmissions);
+    BOOST_CHECK(link.pollRetransmission(ARQ_INITIAL_RTO + 1) == sent);
+}
+
+BOOST_AUTO_TEST_CASE(SelectiveRepeatTest) {
+    ReliableLink link;
+    uint8_t package[PACKAGE_SIZE] = {};
+
+    // a hole in front of an acknowledged package is sent again right away
+    const uint8_t *lost = link.send(package, 0);
+    link.send(package, 10);
+    link.acknowledge(0, 0b1, 20);
+    BOOST_CHECK(link.pollRetransmission(20) == lost);
+    BOOST_CHECK(link.pollRetransmission(20) == nullptr);
+
+    // also if the retransmission is lost, once a package sent after it is acknowledged
+    link.send(package, 30);
+    link.acknowledge(0, 0b10, 40);
+    BOOST_CHECK(link.pollRetransmission(40) == lost);
+
+    // but not for a package sent before the retransmission
+    link.acknowledge(0, 0b10, 50);
+    BOOST_CHECK(link.pollRetransmission(50) == nullptr);
+    BOOST_CHECK(!link.idle());
+}
+
+BOOST_AUTO_TEST_CASE(NextRetransmissionTest) {
+    ReliableLink link;
+    uint8_t package[PACKAGE_SIZE] = {};
+    uint32_t delay;
+
+    BOOST_CHECK(!link.nextRetransmission(0, &delay));
+
+    // the oldest package is sent again once its timeout is exceeded
+    link.send(package, 0);
+    link.send(package, 100);
+    BOOST_REQUIRE(link.nextRetransmission(150, &delay));
+    BOOST_CHECK_EQUAL(delay, ARQ_INITIAL_RTO + 1 - 150);
+    BOOST_CHECK(link.pollRetransmission(150 + delay - 1) == nullptr);
+    BOOST_CHECK(link.pollRetransmission(150 + delay) != nullptr);
+
+    // a received package has to be acknowledged right away
+    ReliableLink receiver;
+    receiver.receive(0);
+    BOOST_REQUIRE(receiver.nextRetransmission(0, &delay));
+    BOOST_CHECK_EQUAL(delay, 0);
+}
+
+BOOST_AUTO_TEST_CASE(LosslessTransferTest) {
+    ReliableLink sender;
+    ReliableLink receiver;
+    bool received[300] = {};
+
+    transfer(sender, receiver, 300, 0, 10, received);
+
+    for (bool packageReceived : received) {
+        BOOST_CHECK(packageReceived);
+    }
+    BOOST_CHECK_EQUAL(sender.retransmissions, 0);
+    BOOST_CHECK_EQUAL(sender.failures, 0);
+    // the timeout adapts to the round trip time
+    BOOST_CHECK_EQUAL(sender.getSmoothedRtt(), 10);
+    BOOST_CHECK_EQUAL(sender.getRto(), ARQ_MIN_RTO);
+}
+
+BOOST_AUTO_TEST_CASE(LossyTransferTest) {
+    ReliableLink sender;
+    ReliableLink receiver;
+    bool received[300] = {};
+
+    uint32_t time = transfer(sender, receiver, 300, 7, 10, received);
+
+    for (bool packageReceived : received) {
+        BOOST_CHECK(packageReceived);
+    }
+    BOOST_CHECK(sender.retransmissions > 0);
+    BOOST_CHECK_EQUAL(sender.failures, 0);
+    // the window keeps several packages in flight, so it is much faster than stop-and-wait with one package per round trip
+    BOOST_CHECK(time < 300 * 10);
+}
+
+BOOST_AUTO_TEST_CASE(LinkTableTest) {
+    ReliableLinks links;
+
+    BOOST_CHECK(links.find(5) == nullptr);
+    ReliableLink *link = links.get(5, 0);
+    BOOST_CHECK(links.find(5) == link);
+    BOOST_CHECK(links.get(5, 1) == link);
+
+    // the least recently used link is replaced
+    for (uint8_t neighbour = 10; neighbour < 10 + ARQ_LINKS - 1; neighbour++) {
+        links.get(neighbour, neighbour);
+    }
+    links.get(5, 100);
+    links.get(100, 101);
+    BOOST_CHECK(links.find(5) != nullptr);
+    BOOST_CHECK(links.find(10) == nullptr);
+    BOOST_CHECK(links.find(100) != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
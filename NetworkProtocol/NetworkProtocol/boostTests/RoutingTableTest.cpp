@@ -0,0 +1,158 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE RoutingTableTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "../routingTable.h"
+#include "../tempRoutingTable.h"
+
+
+BOOST_AUTO_TEST_SUITE(RoutingTableTest)
+
+BOOST_AUTO_TEST_CASE(LookupTest) {
+    RoutingTable table;
+
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    for (int id = 0; id < 256; ++id) {
+        BOOST_CHECK(!table.contains(id));
+        BOOST_CHECK_EQUAL(table.nextHop(id, 7), 7);
+    }
+
+    table.set(0, 3);
+    table.set(31, 4);
+    table.set(32, 5);
+    table.set(255, 6);
+    BOOST_CHECK_EQUAL(table.size(), 4);
+    BOOST_CHECK_EQUAL(table.nextHop(0, 7), 3);
+    BOOST_CHECK_EQUAL(table.nextHop(31, 7), 4);
+    BOOST_CHECK_EQUAL(table.nextHop(32, 7), 5);
+    BOOST_CHECK_EQUAL(table.nextHop(255, 7), 6);
+    BOOST_CHECK_EQUAL(table.nextHop(1, 7), 7);
+
+    // overwriting does not add an entry
+    table.set(31, 8);
+    BOOST_CHECK_EQUAL(table.size(), 4);
+    BOOST_CHECK_EQUAL(table.nextHop(31, 7), 8);
+
+    table.erase(31);
+    table.erase(31);
+    BOOST_CHECK_EQUAL(table.size(), 3);
+    BOOST_CHECK(!table.contains(31));
+    BOOST_CHECK_EQUAL(table.nextHop(31, 7), 7);
+
+    table.clear();
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    BOOST_CHECK(!table.contains(0));
+}
+
+BOOST_AUTO_TEST_CASE(FindFreeTest) {
+    RoutingTable table;
+    uint8_t id = 0;
+
+    BOOST_CHECK(table.findFree(&id));
+    BOOST_CHECK_EQUAL(id, 0);
+
+    for (int i = 0; i < 40; ++i) {
+        table.set(i, 1);
+    }
+    BOOST_CHECK(table.findFree(&id));
+    BOOST_CHECK_EQUAL(id, 40);
+
+    table.erase(17);
+    BOOST_CHECK(table.findFree(&id));
+    BOOST_CHECK_EQUAL(id, 17);
+
+    BOOST_CHECK(table.findFree(&id, 18));
+    BOOST_CHECK_EQUAL(id, 40);
+    BOOST_CHECK(table.findFree(&id, 100));
+    BOOST_CHECK_EQUAL(id, 100);
+
+    for (int i = 0; i < 256; ++i) {
+        table.set(i, 1);
+    }
+    BOOST_CHECK_EQUAL(table.size(), 256);
+    BOOST_CHECK(!table.findFree(&id));
+}
+
+BOOST_AUTO_TEST_CASE(NextTest) {
+    RoutingTable table;
+    uint8_t id = 0;
+
+    BOOST_CHECK(!table.next(&id));
+
+    table.set(3, 1);
+    table.set(70, 1);
+    table.set(255, 1);
+    BOOST_CHECK(table.next(&id));
+    BOOST_CHECK_EQUAL(id, 3);
+    BOOST_CHECK(table.next(&id, 4));
+    BOOST_CHECK_EQUAL(id, 70);
+    BOOST_CHECK(table.next(&id, 71));
+    BOOST_CHECK_EQUAL(id, 255);
+
+    table.erase(255);
+    BOOST_CHECK(!table.next(&id, 71));
+}
+
+BOOST_AUTO_TEST_CASE(TempRoutingTableTest) {
+    TempRoutingTable table(100);
+    uint8_t nextHop = 0;
+
+    BOOST_CHECK(!table.get(1234, &nextHop));
+
+    // consecutive temporary IDs like timestamps of devices registering at the same time
+    for (uint32_t i = 0; i < TEMP_ROUTING_SLOTS; ++i) {
+        BOOST_CHECK(table.set(5000 + i, i, 0));
+    }
+    BOOST_CHECK_EQUAL(table.size(), TEMP_ROUTING_SLOTS);
+    BOOST_CHECK(!table.set(9999, 1, 0));
+    BOOST_CHECK_EQUAL(table.getRejectedCount(), 1);
+
+    // updating an existing route does not need a free slot
+    BOOST_CHECK(table.set(5003, 42, 0));
+    for (uint32_t i = 0; i < TEMP_ROUTING_SLOTS; ++i) {
+        BOOST_CHECK(table.get(5000 + i, &nextHop));
+        BOOST_CHECK_EQUAL(nextHop, i == 3 ? 42 : i);
+    }
+    BOOST_CHECK_EQUAL(table.count(42), 1);
+    BOOST_CHECK_EQUAL(table.count(3), 0);
+
+    // all other routes are still found after removing from the middle of probe sequences
+    for (uint32_t i = 0; i < TEMP_ROUTING_SLOTS; i += 2) {
+        BOOST_CHECK(table.erase(5000 + i));
+    }
+    BOOST_CHECK(!table.erase(5000));
+    BOOST_CHECK_EQUAL(table.size(), TEMP_ROUTING_SLOTS / 2);
+    for (uint32_t i = 1; i < TEMP_ROUTING_SLOTS; i += 2) {
+        BOOST_CHECK(table.get(5000 + i, &nextHop));
+        BOOST_CHECK(!table.get(5000 + i - 1, &nextHop));
+    }
+    BOOST_CHECK_EQUAL(table.getPeakSize(), TEMP_ROUTING_SLOTS);
+}
+
+BOOST_AUTO_TEST_CASE(TempRoutingTableExpiryTest) {
+    TempRoutingTable table(100);
+    uint8_t nextHop = 0;
+
+    for (uint32_t i = 0; i < TEMP_ROUTING_SLOTS - 1; ++i) {
+        BOOST_CHECK(table.set(1000 + i * 7919, 1, 0));
+    }
+    BOOST_CHECK(table.set(77, 2, 0));
+
+    // refreshed routes stay
+    table.set(77, 3, 60);
+    table.update(100);
+    BOOST_CHECK_EQUAL(table.size(), TEMP_ROUTING_SLOTS);
+    table.update(101);
+    BOOST_CHECK_EQUAL(table.size(), 1);
+    BOOST_CHECK_EQUAL(table.getExpiredCount(), TEMP_ROUTING_SLOTS - 1);
+    BOOST_CHECK(table.get(77, &nextHop));
+    BOOST_CHECK_EQUAL(nextHop, 3);
+
+    table.update(161);
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    BOOST_CHECK(!table.get(77, &nextHop));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TimerWheelTest
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#include "../timerWheel.h"
+
+
+BOOST_AUTO_TEST_SUITE(TimerWheelTest)
+
+BOOST_AUTO_TEST_CASE(ExpiryTest) {
+    TimerWheel wheel;
+    WheelTimer first(1);
+    WheelTimer second(2);
+    wheel.schedule(&first, 1000, 10);
+    wheel.schedule(&second, 1000, 5000);
+    BOOST_CHECK_EQUAL(wheel.size(), 2);
+    BOOST_CHECK(first.scheduled());
+
+    // timers expire after their delay, not before
+    BOOST_CHECK(wheel.poll(1009) == nullptr);
+    BOOST_CHECK(wheel.poll(1010) == &first);
+    BOOST_CHECK(!first.scheduled());
+    BOOST_CHECK(wheel.poll(5999) == nullptr);
+    BOOST_CHECK(wheel.poll(6000) == &second);
+    BOOST_CHECK(wheel.poll(6000) == nullptr);
+    BOOST_CHECK(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(CancelTest) {
+    TimerWheel wheel;
+    WheelTimer timers[3];
+    for (WheelTimer &timer : timers) {
+        wheel.schedule(&timer, 0, 100);
+    }
+    wheel.cancel(&timers[1]);
+    wheel.cancel(&timers[1]);
+    BOOST_CHECK_EQUAL(wheel.size(), 2);
+
+    // scheduling again moves the timer
+    wheel.schedule(&timers[0], 50, 100);
+
+    BOOST_CHECK(wheel.poll(100) == &timers[2]);
+    BOOST_CHECK(wheel.poll(100) == nullptr);
+    BOOST_CHECK(wheel.poll(150) == &timers[0]);
+    BOOST_CHECK(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(NextExpiryTest) {
+    TimerWheel wheel;
+    uint32_t time;
+    BOOST_CHECK(!wheel.nextExpiry(&time));
+
+    WheelTimer near;
+    WheelTimer far;
+    wheel.schedule(&near, 100, 20);
+    wheel.schedule(&far, 100, 100000);
+    BOOST_REQUIRE(wheel.nextExpiry(&time));
+    BOOST_CHECK_EQUAL(time, 120);
+
+    BOOST_CHECK(wheel.poll(120) == &near);
+    // the far timer is on an upper level, so the next poll is due when its slot is reached
+    BOOST_REQUIRE(wheel.nextExpiry(&time));
+    BOOST_CHECK_LE(time, 100100);
+    BOOST_CHECK_GT(time, 120);
+}
+
+BOOST_AUTO_TEST_CASE(RandomTest) {
+    std::srand(7);
+    TimerWheel wheel;
+    std::vector<WheelTimer> timers(500);
+    for (uint32_t i = 0; i < timers.size(); i++) {
+        timers[i].key = i;
+        // delays on all levels and beyond the range of the wheel
+        uint32_t delay = i == 0 ? WHEEL_RANGE + 5 : std::rand() % (1 << (std::rand() % 24 + 1)) + 1;
+        wheel.schedule(&timers[i], 0xFFFFFF00, delay);
+    }
+
+    uint32_t time = 0xFFFFFF00;
+    uint32_t expiredCount = 0;
+    while (!wheel.empty()) {
+        uint32_t next;
+        BOOST_REQUIRE(wheel.nextExpiry(&next));
+        time = next;
+        WheelTimer *timer;
+        while ((timer = wheel.poll(time)) != nullptr) {
+            // each timer expires exactly at its time, also when the clock overflows
+            BOOST_CHECK_EQUAL(timer->expiry, time);
+            expiredCount++;
+        }
+    }
+    BOOST_CHECK_EQUAL(expiredCount, timers.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+#include "groupSet.h"
+
+#include <cstring>
+
+GroupSet::GroupSet() {
+    this->clear();
+}
+
+void GroupSet::add(const GroupSet &other) {
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        this->words[i] |= other.words[i];
+    }
+}
+
+void GroupSet::remove(const GroupSet &other) {
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        this->words[i] &= ~other.words[i];
+    }
+}
+
+void GroupSet::retain(const GroupSet &other) {
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        this->words[i] &= other.words[i];
+    }
+}
+
+void GroupSet::clear() {
+    memset(this->words, 0, sizeof(this->words));
+}
+
+bool GroupSet::intersects(const GroupSet &other) const {
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        if (this->words[i] & other.words[i]) return true;
+    }
+    return false;
+}
+
+bool GroupSet::empty() const {
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        if (this->words[i] != 0) return false;
+    }
+    return true;
+}
+
+uint16_t GroupSet::size() const {
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < GROUP_SET_WORDS; i++) {
+        // clear the lowest set bit until the word is empty
+        for (uint32_t word = this->words[i]; word != 0; word &= word - 1) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool GroupSet::next(uint8_t *group, uint8_t first) const {
+    for (uint8_t word = first / 32; word < GROUP_SET_WORDS; word++) {
+        uint32_t bits = this->words[word];
+        // ignore the groups below the first one
+        if (word == first / 32) bits &= UINT32_C(0xFFFFFFFF) << (first % 32);
+        // skip words without a group
+        if (bits == 0) continue;
+
+        uint8_t bit = 0;
+        while (!((bits >> bit) & 1)) bit++;
+        *group = word * 32 + bit;
+        return true;
+    }
+    return false;
+}
+
+void GroupSet::toBytes(uint8_t *bytes, uint8_t first, uint8_t count) const {
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t byte = first + i;
+        bytes[i] = this->words[byte / 4] >> (8 * (byte % 4));
+    }
+}
+
+void GroupSet::fromBytes(const uint8_t *bytes, uint8_t first, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t byte = first + i;
+        uint8_t shift = 8 * (byte % 4);
+        this->words[byte / 4] = (this->words[byte / 4] & ~(UINT32_C(0xFF) << shift))
+            | static_cast<uint32_t>(bytes[i]) << shift;
+    }
+}
+
+bool GroupSet::operator==(const GroupSet &other) const {
+    return memcmp(this->words, other.words, sizeof(this->words)) == 0;
+}
@@ -0,0 +1,131 @@
+#ifndef NETWORKPROTOCOL_GROUPSET_H
+#define NETWORKPROTOCOL_GROUPSET_H
+#include <cstdint>
+
+#define GROUP_SET_SIZE 256
+#define GROUP_SET_WORDS (GROUP_SET_SIZE / 32)
+#define GROUP_SET_BYTES (GROUP_SET_SIZE / 8)
+
+/**
+ * Set of group IDs. Since group IDs are one byte, each group is a bit of a 256-bit bitmap,
+ * so testing, adding and removing a group take constant time and no memory is allocated.
+ */
+class GroupSet {
+
+    /**
+     * Bitmap of the groups in the set.
+     */
+    uint32_t words[GROUP_SET_WORDS];
+
+public:
+    /**
+     * Creates an empty set.
+     */
+    GroupSet();
+
+    /**
+     * Checks if the given group is in the set.
+     * @param group ID of the group.
+     * @return True if the group is in the set.
+     */
+    bool contains(uint8_t group) const {
+        return (this->words[group >> 5] >> (group & 31)) & 1;
+    }
+
+    /**
+     * Adds the given group to the set.
+     * @param group ID of the group.
+     * @return False if the group was in the set already.
+     */
+    bool add(uint8_t group) {
+        if (this->contains(group)) return false;
+        this->words[group >> 5] |= 1UL << (group & 31);
+        return true;
+    }
+
+    /**
+     * Removes the given group from the set.
+     * @param group ID of the group.
+     * @return False if the group was not in the set.
+     */
+    bool remove(uint8_t group) {
+        if (!this->contains(group)) return false;
+        this->words[group >> 5] &= ~(1UL << (group & 31));
+        return true;
+    }
+
+    /**
+     * Adds all groups of the given set.
+     * @param other The groups to be added.
+     */
+    void add(const GroupSet &other);
+
+    /**
+     * Removes all groups of the given set.
+     * @param other The groups to be removed.
+     */
+    void remove(const GroupSet &other);
+
+    /**
+     * Removes all groups, that are not in the given set.
+     * @param other The groups to be kept.
+     */
+    void retain(const GroupSet &other);
+
+    /**
+     * Removes all groups.
+     */
+    void clear();
+
+    /**
+     * Checks if a group is in both sets.
+     * @param other The other set.
+     * @return True if the sets have a common group.
+     */
+    bool intersects(const GroupSet &other) const;
+
+    /**
+     * @return True if no group is in the set.
+     */
+    bool empty() const;
+
+    /**
+     * @return Number of groups in the set.
+     */
+    uint16_t size() const;
+
+    /**
+     * Searches the lowest group in the set from the given one on, e.g. to iterate over the groups.
+     * @param group The found group is written into this.
+     * @param first Lowest group to be considered.
+     * @return False if there is no group from the first one on.
+     */
+    bool next(uint8_t *group, uint8_t first = 0) const;
+
+    /**
+     * Writes the set as a bitmap of GROUP_SET_BYTES bytes. Group g is bit g % 8 of byte g / 8,
+     * so the bitmap does not depend on the byte order of the device.
+     * @param bytes Buffer of count bytes.
+     * @param first First byte of the bitmap to be written, so only a part of the groups can be sent.
+     * @param count Number of bytes to be written.
+     */
+    void toBytes(uint8_t *bytes, uint8_t first = 0, uint8_t count = GROUP_SET_BYTES) const;
+
+    /**
+     * Replaces the groups of a part of the bitmap by a bitmap written by toBytes.
+     * The groups outside of the part are kept.
+     * @param bytes Buffer of count bytes.
+     * @param first First byte of the bitmap to be replaced.
+     * @param count Number of bytes to be replaced.
+     */
+    void fromBytes(const uint8_t *bytes, uint8_t first = 0, uint8_t count = GROUP_SET_BYTES);
+
+    bool operator==(const GroupSet &other) const;
+
+    bool operator!=(const GroupSet &other) const {
+        return !(*this == other);
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_GROUPSET_H
@@ -0,0 +1,98 @@
+#include "loopbackTransport.h"
+
+#include <cstring>
+
+bool LoopbackTransport::write(const uint8_t *package, uint8_t nextHop) {
+    return this->medium->transmit(this, package, nextHop);
+}
+
+uint8_t LoopbackTransport::read(uint8_t *package) {
+    auto first = this->inbox.begin();
+    memcpy(package, first->second.package, PACKAGE_SIZE);
+    uint8_t sender = first->second.sender;
+    this->inbox.erase(first);
+    this->medium->countDelivered();
+    return sender;
+}
+
+bool LoopbackTransport::messageAvailable() {
+    return !this->inbox.empty() && this->inbox.begin()->first <= this->medium->getTime();
+}
+
+uint32_t LoopbackTransport::getTime() {
+    return this->medium->getTime() + this->clockOffset;
+}
+
+LoopbackMedium::~LoopbackMedium() {
+    for (LoopbackTransport *transport : this->transports) {
+        delete transport;
+    }
+}
+
+LoopbackTransport* LoopbackMedium::createTransport(uint8_t address) {
+    auto *transport = new LoopbackTransport(this, this->transports.size(), address);
+    this->transports.push_back(transport);
+    return transport;
+}
+
+void LoopbackMedium::connect(const LoopbackTransport *first, const LoopbackTransport *second, LinkConfig config) {
+    this->connectOneWay(first, second, config);
+    this->connectOneWay(second, first, config);
+}
+
+void LoopbackMedium::connectOneWay(const LoopbackTransport *sender, const LoopbackTransport *receiver,
+    LinkConfig config) {
+    this->links[std::make_pair(sender->index, receiver->index)] = {config, 0};
+}
+
+void LoopbackMedium::disconnect(const LoopbackTransport *first, const LoopbackTransport *second) {
+    this->links.erase(std::make_pair(first->index, second->index));
+    this->links.erase(std::make_pair(second->index, first->index));
+}
+
+bool LoopbackMedium::nextArrival(uint32_t *time) const {
+    bool found = false;
+    for (const LoopbackTransport *transport : this->transports) {
+        if (transport->inbox.empty()) continue;
+        uint32_t arrival = transport->inbox.begin()->first;
+        if (!found || arrival < *time) *time = arrival;
+        found = true;
+    }
+    return found;
+}
+
+bool LoopbackMedium::transmit(const LoopbackTransport *sender, const uint8_t *package, uint8_t nextHop) {
+    this->sentCount++;
+    bool reachable = false;
+    std::uniform_real_distribution<double> loss(0, 1);
+
+    // the links of the sender are consecutive in the map
+    auto link = this->links.lower_bound(std::make_pair(sender->index, static_cast<uint16_t>(0)));
+    for (; link != this->links.end() && link->first.first == sender->index; ++link) {
+        LoopbackTransport *receiver = this->transports[link->first.second];
+        if (receiver->address != nextHop && nextHop != BROADCAST_ADDRESS) continue;
+        reachable = true;
+
+        // the transmission starts when the previous packages on the link have been transmitted
+        LoopbackLink &state = link->second;
+        uint64_t now = static_cast<uint64_t>(this->time) * 1000;
+        if (state.busyUntil < now) state.busyUntil = now;
+        if (state.config.bandwidth > 0) {
+            state.busyUntil += static_cast<uint64_t>(PACKAGE_SIZE) * 8 * 1000000 / state.config.bandwidth;
+        }
+
+        if (state.config.lossRate > 0 && loss(this->random) < state.config.lossRate) {
+            this->lostCount++;
+            continue;
+        }
+
+        // round up to the next millisecond, so a package never arrives before it has been transmitted
+        uint32_t arrival = static_cast<uint32_t>((state.busyUntil + 999) / 1000) + state.config.latency;
+        LoopbackFrame frame;
+        frame.sender = sender->address;
+        memcpy(frame.package, package, PACKAGE_SIZE);
+        // packages arriving at the same time keep their order
+        receiver->inbox.insert(receiver->inbox.upper_bound(arrival), std::make_pair(arrival, frame));
+    }
+    return reachable;
+}
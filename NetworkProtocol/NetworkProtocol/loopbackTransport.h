@@ -0,0 +1,282 @@
+#ifndef NETWORKPROTOCOL_LOOPBACKTRANSPORT_H
+#define NETWORKPROTOCOL_LOOPBACKTRANSPORT_H
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "transport.h"
+#include "Messages/messageObjects.h"
+
+#define BROADCAST_ADDRESS 255
+
+class LoopbackMedium;
+
+/**
+ * Properties of a simulated link in one direction.
+ */
+typedef struct LinkConfig {
+    /**
+     * Time in milliseconds a package needs from the sender to the receiver.
+     */
+    uint32_t latency;
+
+    /**
+     * Probability between 0 and 1 that a package is lost.
+     */
+    double lossRate;
+
+    /**
+     * Bits per second the link transmits. 0 for unlimited bandwidth.
+     */
+    uint32_t bandwidth;
+} LinkConfig;
+
+/**
+ * Package on its way to a receiver.
+ */
+typedef struct LoopbackFrame {
+    /**
+     * Address of the sender at the time it has been sent.
+     */
+    uint8_t sender;
+
+    /**
+     * The raw package.
+     */
+    uint8_t package[PACKAGE_SIZE];
+} LoopbackFrame;
+
+/**
+ * Transport of one device on a loopback medium.
+ */
+class LoopbackTransport : public Transport {
+    friend class LoopbackMedium;
+
+    /**
+     * Medium the transport is attached to.
+     */
+    LoopbackMedium *medium;
+
+    /**
+     * Index of the transport on its medium.
+     */
+    uint16_t index;
+
+    /**
+     * ID packages are received for.
+     */
+    uint8_t address;
+
+    /**
+     * Packages on their way to this transport. Key: Time the package arrives.
+     */
+    std::multimap<uint32_t, LoopbackFrame> inbox;
+
+    /**
+     * Time added to the clock of the medium, so devices do not start at the same time.
+     */
+    uint32_t clockOffset = 0;
+
+    LoopbackTransport(LoopbackMedium *medium, uint16_t index, uint8_t address)
+        : medium(medium), index(index), address(address) {}
+
+public:
+    bool write(const uint8_t *package, uint8_t nextHop) override;
+
+    uint8_t read(uint8_t *package) override;
+
+    bool messageAvailable() override;
+
+    uint32_t getTime() override;
+
+    void setAddress(uint8_t id) override {
+        this->address = id;
+    }
+
+    /**
+     * @return ID packages are received for.
+     */
+    uint8_t getAddress() const {
+        return this->address;
+    }
+
+    /**
+     * Sets the time added to the clock of the medium, e.g. so devices without ID get different temporary IDs.
+     * @param offset The offset in milliseconds.
+     */
+    void setClockOffset(uint32_t offset) {
+        this->clockOffset = offset;
+    }
+
+    /**
+     * @return Index of the transport on its medium.
+     */
+    uint16_t getIndex() const {
+        return this->index;
+    }
+};
+
+/**
+ * State of a simulated link in one direction.
+ */
+typedef struct LoopbackLink {
+    /**
+     * Properties of the link.
+     */
+    LinkConfig config;
+
+    /**
+     * Time in microseconds until the link has finished the transmission of the previous packages.
+     */
+    uint64_t busyUntil;
+} LoopbackLink;
+
+/**
+ * Simulated medium that connects the transports of many devices in one process.
+ * A package written to an ID is delivered to all transports in range, that have this ID, after the latency
+ * of the link and the transmission time given by its bandwidth. Packages written to the discovery channel
+ * are delivered to all transports in range.
+ * The medium has its own clock, so simulations do not depend on the real time.
+ */
+class LoopbackMedium {
+
+    /**
+     * All transports on the medium.
+     */
+    std::vector<LoopbackTransport*> transports;
+
+    /**
+     * Links between the transports. Key: Indices of the sender and receiver.
+     */
+    std::map<std::pair<uint16_t, uint16_t>, LoopbackLink> links;
+
+    /**
+     * Random numbers for the losses.
+     */
+    std::mt19937 random;
+
+    /**
+     * Current time in milliseconds.
+     */
+    uint32_t time = 0;
+
+    /**
+     * Number of packages written to the medium.
+     */
+    uint64_t sentCount = 0;
+
+    /**
+     * Number of packages lost on a link.
+     */
+    uint64_t lostCount = 0;
+
+    /**
+     * Number of packages read by a transport.
+     */
+    uint64_t deliveredCount = 0;
+
+public:
+    /**
+     * Creates an empty medium.
+     * @param seed Seed of the random losses, so simulations can be repeated.
+     */
+    explicit LoopbackMedium(uint32_t seed = 1) : random(seed) {}
+
+    ~LoopbackMedium();
+
+    LoopbackMedium(const LoopbackMedium&) = delete;
+    LoopbackMedium& operator=(const LoopbackMedium&) = delete;
+
+    /**
+     * Creates a new transport on this medium. It is deleted with the medium.
+     * @param address ID packages are received for.
+     * @return The transport.
+     */
+    LoopbackTransport* createTransport(uint8_t address = 0);
+
+    /**
+     * Connects two transports in both directions. Replaces existing links between them.
+     * @param first The first transport.
+     * @param second The second transport.
+     * @param config Properties of the links.
+     */
+    void connect(const LoopbackTransport *first, const LoopbackTransport *second, LinkConfig config);
+
+    /**
+     * Connects a transport to another one in one direction. Replaces an existing link.
+     * @param sender The sending transport.
+     * @param receiver The receiving transport.
+     * @param config Properties of the link.
+     */
+    void connectOneWay(const LoopbackTransport *sender, const LoopbackTransport *receiver, LinkConfig config);
+
+    /**
+     * Removes the links between two transports in both directions. Packages on their way are still delivered.
+     * @param first The first transport.
+     * @param second The second transport.
+     */
+    void disconnect(const LoopbackTransport *first, const LoopbackTransport *second);
+
+    /**
+     * Puts a package on the links of the sender to all transports with the given ID.
+     * @param sender The sending transport.
+     * @param package The raw package.
+     * @param nextHop ID of the receiver.
+     * @return True if a transport with the ID is in range.
+     */
+    bool transmit(const LoopbackTransport *sender, const uint8_t *package, uint8_t nextHop);
+
+    /**
+     * Counts a package read by a transport.
+     */
+    void countDelivered() {
+        this->deliveredCount++;
+    }
+
+    /**
+     * @return Current time in milliseconds.
+     */
+    uint32_t getTime() const {
+        return this->time;
+    }
+
+    /**
+     * Moves the clock forward.
+     * @param milliseconds Time to move forward.
+     */
+    void advance(uint32_t milliseconds) {
+        this->time += milliseconds;
+    }
+
+    /**
+     * Moves the clock forward to the given time. Earlier times are ignored.
+     * @param time The new time in milliseconds.
+     */
+    void advanceTo(uint32_t time) {
+        if (time > this->time) this->time = time;
+    }
+
+    /**
+     * Searches the earliest time a package on its way arrives, so simulations can skip the time in between.
+     * @param time The arrival time in milliseconds is written into this.
+     * @return False if no package is on its way.
+     */
+    bool nextArrival(uint32_t *time) const;
+
+    uint64_t getSentCount() const {
+        return this->sentCount;
+    }
+
+    uint64_t getLostCount() const {
+        return this->lostCount;
+    }
+
+    uint64_t getDeliveredCount() const {
+        return this->deliveredCount;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_LOOPBACKTRANSPORT_H
@@ -0,0 +1,63 @@
+#include "neighborCache.h"
+
+#include "timer.h"
+
+uint8_t NeighborCache::_find(uint8_t id) const {
+    for (uint8_t index = 0; index < NEIGHBOR_CACHE_SLOTS; index++) {
+        if (this->slots[index].used && this->slots[index].id == id) return index;
+    }
+    return NEIGHBOR_CACHE_SLOTS;
+}
+
+void NeighborCache::seen(uint8_t id, uint8_t level, uint32_t time) {
+    uint8_t index = this->_find(id);
+    if (index == NEIGHBOR_CACHE_SLOTS) {
+        // take a free slot or replace the neighbour heard least recently
+        index = 0;
+        for (uint8_t candidate = 0; candidate < NEIGHBOR_CACHE_SLOTS; candidate++) {
+            const Neighbor &neighbor = this->slots[candidate];
+            if (!neighbor.used) {
+                index = candidate;
+                break;
+            }
+            if (Timer::elapsed(neighbor.lastSeen, time) > Timer::elapsed(this->slots[index].lastSeen, time)) {
+                index = candidate;
+            }
+        }
+        if (!this->slots[index].used) this->entries++;
+        this->slots[index] = {true, id, level, 0, time};
+        return;
+    }
+    this->slots[index].level = level;
+    this->slots[index].lastSeen = time;
+}
+
+bool NeighborCache::setRtt(uint8_t id, uint16_t rtt, uint32_t time) {
+    uint8_t index = this->_find(id);
+    if (index == NEIGHBOR_CACHE_SLOTS) return false;
+    this->slots[index].rtt = rtt;
+    this->slots[index].lastSeen = time;
+    return true;
+}
+
+const Neighbor* NeighborCache::get(uint8_t id) const {
+    uint8_t index = this->_find(id);
+    if (index == NEIGHBOR_CACHE_SLOTS) return nullptr;
+    return &this->slots[index];
+}
+
+bool NeighborCache::erase(uint8_t id) {
+    uint8_t index = this->_find(id);
+    if (index == NEIGHBOR_CACHE_SLOTS) return false;
+    this->slots[index].used = false;
+    this->entries--;
+    return true;
+}
+
+uint8_t NeighborCache::fresh(uint32_t time, uint8_t *ids) const {
+    uint8_t count = 0;
+    for (const Neighbor &neighbor : this->slots) {
+        if (neighbor.used && Timer::elapsed(neighbor.lastSeen, time) <= this->timeout) ids[count++] = neighbor.id;
+    }
+    return count;
+}
@@ -0,0 +1,122 @@
+#ifndef NETWORKPROTOCOL_NEIGHBORCACHE_H
+#define NETWORKPROTOCOL_NEIGHBORCACHE_H
+#include <cstdint>
+
+#define NEIGHBOR_CACHE_SLOTS 8
+#define NEIGHBOR_TIMEOUT 60000
+
+/**
+ * A device in range, that has answered a discovery.
+ */
+typedef struct Neighbor {
+    /**
+     * True if this slot holds a neighbour.
+     */
+    bool used;
+
+    /**
+     * ID of the neighbour.
+     */
+    uint8_t id;
+
+    /**
+     * Level of the neighbour in the hierarchy, as given in its last answer.
+     */
+    uint8_t level;
+
+    /**
+     * Last round trip time to the neighbour in milliseconds. 0 if it has not been measured yet.
+     */
+    uint16_t rtt;
+
+    /**
+     * Time the neighbour has been heard the last time.
+     */
+    uint32_t lastSeen;
+} Neighbor;
+
+/**
+ * Cache of the devices in range, so a rediscovery only has to ask them instead of all devices.
+ * The cache has a fixed number of slots, if it is full the neighbour heard least recently is replaced.
+ * Neighbours not heard within the timeout are stale and are not asked anymore.
+ */
+class NeighborCache {
+
+    /**
+     * Slots of the cache.
+     */
+    Neighbor slots[NEIGHBOR_CACHE_SLOTS] = {};
+
+    /**
+     * Time after which a neighbour is stale.
+     */
+    uint32_t timeout;
+
+    /**
+     * Number of used slots.
+     */
+    uint8_t entries = 0;
+
+    /**
+     * Searches the slot of the given neighbour.
+     * @param id ID of the neighbour.
+     * @return Index of the slot or NEIGHBOR_CACHE_SLOTS if the neighbour is not cached.
+     */
+    uint8_t _find(uint8_t id) const;
+
+public:
+    /**
+     * Creates an empty cache.
+     * @param timeout Time after which a neighbour is stale.
+     */
+    explicit NeighborCache(uint32_t timeout = NEIGHBOR_TIMEOUT) : timeout(timeout) {}
+
+    /**
+     * Adds or updates a neighbour, that has been heard.
+     * @param id ID of the neighbour.
+     * @param level Level of the neighbour in the hierarchy.
+     * @param time The current time.
+     */
+    void seen(uint8_t id, uint8_t level, uint32_t time);
+
+    /**
+     * Saves a round trip time measured to a cached neighbour.
+     * @param id ID of the neighbour.
+     * @param rtt The round trip time in milliseconds.
+     * @param time The current time.
+     * @return False if the neighbour is not cached.
+     */
+    bool setRtt(uint8_t id, uint16_t rtt, uint32_t time);
+
+    /**
+     * Looks up a neighbour.
+     * @param id ID of the neighbour.
+     * @return The neighbour or nullptr if it is not cached.
+     */
+    const Neighbor* get(uint8_t id) const;
+
+    /**
+     * Removes a neighbour, if it is cached.
+     * @param id ID of the neighbour.
+     * @return True if the neighbour has been removed.
+     */
+    bool erase(uint8_t id);
+
+    /**
+     * Collects the IDs of the neighbours, that are not stale.
+     * @param time The current time.
+     * @param ids The IDs are written into this. Must have space for NEIGHBOR_CACHE_SLOTS IDs.
+     * @return Number of IDs written.
+     */
+    uint8_t fresh(uint32_t time, uint8_t *ids) const;
+
+    /**
+     * @return Number of cached neighbours, including the stale ones.
+     */
+    uint8_t size() const {
+        return this->entries;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_NEIGHBORCACHE_H
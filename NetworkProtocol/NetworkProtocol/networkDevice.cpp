@@ -1,145 +1,334 @@
 #include "networkDevice.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "Messages/messageObjects.h"
 
-#define DISCOVERY_CHANNEL 255
-
 bool NetworkDevice::_assembleAndSend(uint8_t receiver, bool group, uint8_t *data, uint16_t dataSize) {
-    auto message = DataMessage(receiver, group, this->_getMessageID(),
-        this->id, data, dataSize);
+    // the package count is one byte, and an empty message could not be told apart from a corrupted one
+    if (dataSize == 0 || dataSize > MAX_DATA_SIZE) return false;
+    // the packages of the previous message are queued first, so a message is never sent in parts
+    if (this->outgoing != nullptr) return false;
+
+    // the data belongs to the caller, who may free it before all packages are queued
+    auto *content = new uint8_t[dataSize];
+    memcpy(content, data, dataSize);
+    this->outgoing = new DataMessage(receiver, group, this->_getMessageID(), this->id, content, dataSize);
+    this->outgoingPackages = 0;
+    this->_feedOutgoing();
+    return true;
+}
+
+bool NetworkDevice::_outgoingFits(uint8_t *package) const {
+    this->outgoing->writeRawPackage(package, this->outgoingPackages);
+    uint8_t nextHops = 1;
+    if (Message::isGroupPackage(package)) {
+        uint8_t receiver = Message::receiverOf(package);
+        nextHops = this->_isHub() ? 0 : 1;
+        for (uint8_t i = 0; i < 4; i++) {
+            if (this->children[i] != 0 && (receiver == 0 || this->childGroups[i].contains(receiver))) ++nextHops;
+        }
+    }
+    return TX_QUEUE_SIZE - this->txQueue.size() >= nextHops;
+}
 
-    return this->_sendInternal(&message);
+void NetworkDevice::_feedOutgoing() {
+    uint8_t package[PACKAGE_SIZE];
+    while (this->outgoing != nullptr && this->_outgoingFits(package)) {
+        this->_forward(package);
+        if (++this->outgoingPackages == this->outgoing->getNumberPackages()) {
+            delete this->outgoing;
+            this->outgoing = nullptr;
+        }
+    }
 }
 
 bool NetworkDevice::_sendInternal(Message *message, uint8_t sender) {
 
-    if (!message->group) {
-        uint8_t nextHop = 0;
-        if (this->routingTable.count(message->receiver) > 0) {
-            nextHop = this->routingTable.at(message->receiver);
-        } else {
-            nextHop = this->parent;
+    uint8_t package[PACKAGE_SIZE];
+    uint8_t numberPackages = message->getNumberPackages();
+    bool sendingSuccessful = true;
+
+    for (uint8_t i = 0; i < numberPackages; i++) {
+        message->writeRawPackage(package, i);
+        if (!this->_forward(package, sender)) {
+            sendingSuccessful = false;
+        }
+    }
+    return sendingSuccessful;
+}
+
+bool NetworkDevice::_sendDirect(Message *message, uint8_t link) {
+    uint8_t package[PACKAGE_SIZE];
+    message->writeRawPackage(package, 0);
+    return this->_enqueue(package, link, false);
+}
+
+bool NetworkDevice::_enqueue(const uint8_t *package, uint8_t nextHop, bool reliable) {
+    if (reliable && this->_aggregate(package, nextHop)) return true;
+    return this->_queue(package, nextHop, reliable);
+}
+
+bool NetworkDevice::_queue(const uint8_t *package, uint8_t nextHop, bool reliable) {
+    // nothing is written here, so routing never waits for the data link layer
+    return this->txQueue.push(package, nextHop, reliable);
+}
+
+bool NetworkDevice::_aggregate(const uint8_t *package, uint8_t nextHop) {
+    int8_t index = -1;
+    for (uint8_t i = 0; i < AGGREGATE_LINKS; i++) {
+        if (this->aggregates[i].count > 0 && this->aggregates[i].receiver == nextHop) index = i;
+    }
+
+    // frames are acknowledged by the neighbour, so they are not sent to devices without ID
+    bool packable = this->aggregationWindow > 0 && nextHop != DISCOVERY_CHANNEL &&
+        this->_address() != DISCOVERY_CHANNEL && AggregateMessage::entrySize(package) > 0;
+    if (!packable) {
+        if (index >= 0) this->_flushAggregate(index);
+        return false;
+    }
+    if (index >= 0) {
+        if (this->aggregates[index].add(package)) return true;
+        // the frame is full
+        this->_flushAggregate(index);
+    } else {
+        // take a free frame or send the oldest one
+        uint32_t time = this->_getTime();
+        index = 0;
+        for (uint8_t i = 0; i < AGGREGATE_LINKS; i++) {
+            if (this->aggregates[i].count == 0) {
+                index = i;
+                break;
+            }
+            if (Timer::elapsed(this->aggregateTimers[i].startTime, time) >
+                Timer::elapsed(this->aggregateTimers[index].startTime, time)) {
+                index = i;
+            }
+        }
+        if (this->aggregates[index].count > 0) this->_flushAggregate(index);
+    }
+
+    this->aggregates[index] = AggregateMessage(nextHop);
+    this->aggregateTimers[index] = Timer(this->aggregationWindow).start(this->_getTime());
+    return this->aggregates[index].add(package);
+}
+
+void NetworkDevice::_flushAggregate(uint8_t index) {
+    AggregateMessage &aggregate = this->aggregates[index];
+    uint8_t frame[PACKAGE_SIZE];
+    uint8_t package[PACKAGE_SIZE];
+    uint8_t offset = 0;
+    aggregate.writeRawPackage(frame);
+
+    // a frame with a single package would only add its length byte
+    const uint8_t *queued = frame;
+    if (aggregate.count == 1 && AggregateMessage::unpack(frame, &offset, package)) queued = package;
+    this->_queue(queued, aggregate.receiver, true);
+    aggregate = AggregateMessage();
+}
+
+void NetworkDevice::_drainTx(uint8_t budget) {
+    uint32_t time = this->_getTime();
+    uint8_t written = 0;
+    // each package is looked at once per call
+    for (uint8_t remaining = this->txQueue.size(); remaining > 0 && written < budget; remaining--) {
+        QueuedPackage &queued = this->txQueue.front();
+
+        // discoveries are not addressed to a neighbour and devices without ID cannot be acknowledged
+        if (queued.reliable && queued.link != DISCOVERY_CHANNEL && this->_address() != DISCOVERY_CHANNEL) {
+            ReliableLink *link = this->reliableLinks.get(queued.link, time);
+            // the window waits for acknowledgements, so the packages to other neighbours go first,
+            // the order of the packages to one neighbour is kept
+            if (!link->canSend()) {
+                this->txQueue.rotate();
+                continue;
+            }
+            const uint8_t *sent = link->send(queued.package, time);
+            // the link sends the package again with the next retransmissions instead of after the timeout
+            if (!this->_write(sent, queued.link)) link->unsend(sent);
+            this->txQueue.pop();
+            ++written;
+            continue;
+        }
+
+        // the transmission ID of the previous hop is not valid for the next one
+        Message::setTransmission(queued.package, 0);
+        // direct packages are written once, most IDs pinged by a discovery do not exist
+        if (!this->_write(queued.package, queued.link) && queued.reliable) {
+            // the link is busy, so retry the package on the next call
+            if (++queued.attempts < MAX_WRITE_ATTEMPTS) return;
+            ++this->failedWrites;
+        }
+        this->txQueue.pop();
+        ++written;
+    }
+}
+
+void NetworkDevice::_serviceLinks(uint8_t budget) {
+    uint8_t package[PACKAGE_SIZE];
+    uint8_t neighbour;
+    uint8_t cumulativeAck;
+    uint32_t selectiveAcks;
+
+    // acknowledgements are written directly, so the window of the neighbour opens as soon as possible
+    while (this->reliableLinks.takeAck(&neighbour, &cumulativeAck, &selectiveAcks)) {
+        AckMessage ack = AckMessage(neighbour, cumulativeAck, selectiveAcks);
+        ack.writeRawPackage(package);
+        this->_write(package, neighbour);
+    }
+
+    uint32_t time = this->_getTime();
+    const uint8_t *retransmission;
+    for (uint8_t i = 0; i < budget; i++) {
+        retransmission = this->reliableLinks.pollRetransmission(time, &neighbour);
+        if (retransmission == nullptr) break;
+        // the data link layer is busy, so the package is taken first on the next call
+        if (!this->_write(retransmission, neighbour)) {
+            this->reliableLinks.find(neighbour)->unsend(retransmission);
+            break;
         }
-        return this->_write(message, nextHop);
     }
+}
+
+bool NetworkDevice::_forward(const uint8_t *package, uint8_t sender) {
 
+    uint8_t receiver = Message::receiverOf(package);
+
+    if (!Message::isGroupPackage(package)) {
+        return this->_enqueue(package, this->routingTable.nextHop(receiver, this->parent));
+    }
 
     bool sendingSuccessful = true;
 
-    // group messages are sent to all children and parent, that is not the sender
-    for (const uint8_t i : this->children) {
-        if (i != 0 && i != sender && !_write(message, i)) {
+    // group messages are sent up to the hub and down to all children, that are not the sender and whose subtree
+    // contains a member of the group. Every device is in group 0, so it is sent to children that did not report yet.
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t child = this->children[i];
+        if (child == 0 || child == sender) continue;
+        if (receiver != 0 && !this->childGroups[i].contains(receiver)) continue;
+        if (!this->_enqueue(package, child)) {
             sendingSuccessful = false;
         }
     }
-    if (this->parent != sender && !_write(message, this->parent)) {
+    if (!this->_isHub() && this->parent != sender && !this->_enqueue(package, this->parent)) {
         sendingSuccessful = false;
     }
     return sendingSuccessful;
 }
 
-bool NetworkDevice::_processMessage(Message *message, uint8_t sender) {
+bool NetworkDevice::_processMessage(const uint8_t *package, uint8_t sender) {
     // TODO commands must set members got by receive method
 
-    switch (message->getType()) {
+    switch (Message::typeOf(package)) {
         case 0: {   // data message
-            auto *dataMessage = dynamic_cast<DataMessage *>(message);
+            DataMessage dataMessage;
+            uint32_t time = this->_getTime();
+            // all incomplete messages have expired when the timeout has passed since the last package
+            this->timers.schedule(&this->reassemblyTimer, time, this->messageBuilder.getTimeout() + 1);
+            if (!this->messageBuilder.newDataMessage(package, &dataMessage, time)) {
+                return false;
+            }
 
-            // delete previous params and save the new
-            delete this->lastData;
-            this->lastData = new uint8_t[dataMessage->contentSize];
-            memcpy(this->lastData, dataMessage->content, dataMessage->contentSize);
-            this->lastDataSize = dataMessage->contentSize;
+            // delete previous params and take over the content of the assembled message
+            delete[] this->lastData;
+            this->lastData = dataMessage.content;
+            this->lastDataSize = dataMessage.contentSize;
+            dataMessage.content = nullptr;
             return true;
         }
         case 1: {   // registration message
-            auto *registrationMsg = dynamic_cast<RegistrationMessage *>(message);
+            RegistrationMessage registration = RegistrationMessage(package);
+            auto *registrationMsg = &registration;
             switch (registrationMsg->registrationType) {
                 case 0: {   // discovery
                     if (registrationMsg->extraField != 255) {
+                        // answers are sent on the discovery channel, so also the answers to other devices are cached
+                        uint32_t time = this->_getTime();
+                        this->neighbors.seen(registrationMsg->newDeviceID, registrationMsg->extraField, time);
                         // Got an answer to own discovery
-                        this->discovery->newAnswer(registrationMsg->newDeviceID, registrationMsg->extraField);
+                        if (this->discovery != nullptr) {
+                            // the answer echoes the send time of the request, answers to other devices
+                            // or to an earlier discovery are not trusted
+                            uint32_t rtt = Timer::elapsed(registrationMsg->tempID, time);
+                            if (registrationMsg->requester == this->tempID && rtt <= this->timeout) {
+                                this->neighbors.setRtt(registrationMsg->newDeviceID, rtt, time);
+                            } else {
+                                rtt = UINT16_MAX;
+                            }
+                            this->discovery->newAnswer(registrationMsg->newDeviceID, registrationMsg->extraField,
+                                registrationMsg->freeSlots, rtt);
+                        }
                         return false;
                     }
-                    // Other device discovers
-                    uint8_t childSlot = 4;
-                    for (int i = 0; i < 4; ++i) {
-                        if (this->children[i] == 0) {
-                            childSlot = i;
-                            break;
+                    // Other device discovers, only registered devices with a free child slot can become its parent
+                    if (!this->registered || this->_freeChildSlots() == 0) return false;
+
+                    if (registrationMsg->receiver == DISCOVERY_CHANNEL) {
+                        // all devices in range received the broadcast, so they answer after a random back-off
+                        // a pending answer also answers repeated requests and other discovering devices
+                        if (!this->discoveryAnswerTimer.scheduled()) {
+                            this->discoveryRequester = registrationMsg->requester;
+                            this->discoveryEcho = registrationMsg->tempID;
+                            this->discoveryEchoTime = this->_getTime();
+                            this->timers.schedule(&this->discoveryAnswerTimer, this->_getTime(),
+                                this->_random() % (DISCOVERY_BACKOFF + 1));
                         }
+                        return false;
                     }
-                    // cannot accept more children
-                    if (childSlot == 4) return false;
-
-                    // TODO figure out how to address discoveries
-                    registrationMsg->receiver = DISCOVERY_CHANNEL;
-                    registrationMsg->extraField = this->hierarchyLevel;
-                    this->_sendInternal(registrationMsg);
+                    this->_answerDiscovery(registrationMsg->requester, registrationMsg->tempID);
                     break;
                 }
                 case 1: {   // registration request
                     // new device wants to register with this as a parent
-                    if (registrationMsg->receiver != this->id) return false;
-                    this->tempRoutingTable[registrationMsg->tempID] = 0;
+                    if (!this->registered || registrationMsg->receiver != this->id) return false;
+                    // other devices might have taken the free slots since the discovery
+                    if (this->_freeChildSlots() == 0) return false;
                     registrationMsg->receiver = 0;
                     registrationMsg->registrationType = 2;
-                    this->_sendInternal(registrationMsg);
-
+                    this->_createRoute(registrationMsg, sender);
                     break;
                 }
                 case 2: {   // route creation
                     // new device as a descendant node
-                    if (this->id == 0) {
-                        if (registrationMsg->newDeviceID == 0 || this->routingTable.count(registrationMsg->newDeviceID) == 0) {
-                            // if the device id is not set, assign first free ID
-                            RegistrationMessage answerMsg = RegistrationMessage(0, 0, registrationMsg->tempID, 3, false);
-                            for (uint8_t i = 0; true; ++i) {
-                                if (this->routingTable.count(i) < 1) {
-                                    answerMsg.receiver = i;
-                                    answerMsg.newDeviceID = i;
-                                    answerMsg.extraField = true;
-                                    break;
-                                }
-                                if (i == 255) break;
-                            }
-                            this->_sendInternal(&answerMsg);
-                        } else {
-
-                            // if the device ID is set and there is a device with the ID already in the routing table,
-                            // the hub has to ping id and wait for timeout, then accept
-                            uint32_t time = this->_getTime();
-                            this->registrationPings.push_back({registrationMsg->newDeviceID, Timer(this->timeout).start(time), registrationMsg->tempID});
-                            PingMessage pingMsg = PingMessage(registrationMsg->newDeviceID, time % 256, this->id, false, time);
-                            this->_sendInternal(&pingMsg);
-                        }
-                        this->tempRoutingTable[registrationMsg->tempID] = sender;
-                    } else {
-                        this->tempRoutingTable[registrationMsg->tempID] = sender;
-                        this->_sendInternal(registrationMsg);
-                    }
+                    if (!this->registered) return false;
+                    this->_createRoute(registrationMsg, sender);
                     break;
                 }
                 case 3: {   // registration response
                     // registration of a device has been accepted or rejected
-                    if (this->tempID == registrationMsg->tempID) {
+                    if (!this->registered) {
                         // this device is accepted/rejected
+                        if (!this->registering || this->tempID != registrationMsg->tempID) return false;
+                        // a late response to an earlier request through another parent, only the current parent
+                        // has a route to this device
+                        if (sender != this->parent) return false;
+                        this->registering = false;
                         if (!registrationMsg->extraField) {
+                            // the next candidate may still accept it, otherwise discover the parents again
+                            if (!this->_registerWithNextCandidate()) this->_startDiscovery();
                             return false;
                         }
+                        this->parentCandidates.clear();
                         this->registered = true;
                         this->id = registrationMsg->newDeviceID;
+                        if (this->transport != nullptr) this->transport->setAddress(this->_address());
+                        // the new parent does not know the groups of this subtree yet
+                        this->reportedGroups.clear();
+                        this->_reportGroups();
                         return false;
                     }
 
+                    // the route has expired, so the registration has been abandoned
+                    uint8_t tempNextHop;
+                    if (!this->tempRoutingTable.get(registrationMsg->tempID, &tempNextHop)) return false;
+
                     // temporarily update the routing table to the new path
                     uint8_t originalNextHop = 0;
-                    bool routeExists = this->routingTable.find(registrationMsg->newDeviceID) != this->routingTable.end();
-                    if (routeExists) originalNextHop = this->routingTable[registrationMsg->newDeviceID];
+                    bool routeExists = this->routingTable.contains(registrationMsg->newDeviceID);
+                    if (routeExists) originalNextHop = this->routingTable.nextHop(registrationMsg->newDeviceID, 0);
 
-                    this->routingTable[registrationMsg->newDeviceID] = this->tempRoutingTable[registrationMsg->tempID];
+                    this->routingTable.set(registrationMsg->newDeviceID, tempNextHop);
                     this->tempRoutingTable.erase(registrationMsg->tempID);
 
                     this->_sendInternal(registrationMsg);
@@ -147,10 +336,13 @@ bool NetworkDevice::_processMessage(Message *message, uint8_t sender) {
                     // if the device was rejected, restore the old path
                     if (!registrationMsg->extraField) {
                         if (routeExists) {
-                            this->routingTable[registrationMsg->newDeviceID] = originalNextHop;
+                            this->routingTable.set(registrationMsg->newDeviceID, originalNextHop);
                         } else {
                             this->routingTable.erase(registrationMsg->newDeviceID);
                         }
+                    } else if (tempNextHop == DISCOVERY_CHANNEL || tempNextHop == registrationMsg->newDeviceID) {
+                        // the device registered with this one, from now on it is reached by its new ID
+                        this->_addChild(registrationMsg->newDeviceID);
                     }
                     break;
                 }
@@ -158,66 +350,121 @@ bool NetworkDevice::_processMessage(Message *message, uint8_t sender) {
             break;
         }
         case 2: {   // ping message
-            if (message->receiver != this->id) return false;
-            auto *pingMsg = dynamic_cast<PingMessage *>(message);
+            PingMessage ping = PingMessage(package);
+            auto *pingMsg = &ping;
+            if (pingMsg->receiver != this->id) {
+                // a direct ping is only meant for the neighbour
+                if (!pingMsg->isDirect) this->_forward(package, sender);
+                return false;
+            }
             if (!pingMsg->isResponse) {
                 pingMsg->isResponse = true;
                 pingMsg->receiver = pingMsg->senderId;
                 pingMsg->senderId = this->id;
-                this->_sendInternal(pingMsg);
+                // a direct ping measures the link, so it is answered over the same link
+                if (pingMsg->isDirect) {
+                    this->_sendDirect(pingMsg, sender);
+                } else {
+                    this->_sendInternal(pingMsg);
+                }
+                return false;
+            }
+
+            // the device answers with its ID, so its registration is complete and the ID is not given again
+            this->_forgetAssignedID(pingMsg->senderId);
+
+            // answers to the periodic pings of the hub are not fetched by checkPing
+            // a late answer still shows that the device is alive, so it resets the misses as well
+            auto liveness = this->livenessPings.find(pingMsg->senderId);
+            if (liveness != this->livenessPings.end() && liveness->second.pingID == pingMsg->pingId) {
+                this->timers.cancel(&liveness->second.timer);
+                liveness->second.misses = 0;
                 return false;
             }
 
-            this->pings[pingMsg->pingId].responseTime = Timer::elapsed(pingMsg->timestamp, this->_getTime());
+            uint32_t rtt = Timer::elapsed(pingMsg->timestamp, this->_getTime());
+            // a routed answer measures the whole path, so only direct answers give the round trip time to a neighbour
+            if (pingMsg->isDirect) {
+                this->neighbors.setRtt(pingMsg->senderId, rtt > UINT16_MAX ? UINT16_MAX : rtt, this->_getTime());
+            }
+            // answers to the pings of a benchmark estimate the quality of the connection and are not fetched by checkPing
+            if (pingMsg->isDirect && this->benchmark_wrapper != nullptr &&
+                this->benchmark_wrapper->newAnswer(pingMsg->senderId, pingMsg->pingId, this->_getTime())) {
+                return false;
+            }
+            this->pings[pingMsg->pingId].responseTime = rtt;
 
 
             break;
         }
         case 3: {   // add/remove to group message
-            if (message->receiver != this->id) return false;
-            auto *groupMsg = dynamic_cast<AddRemoveToGroupMessage *>(message);
-            if (groupMsg->isAddToGroup) {
-                this->groups.push_back(groupMsg->groupId);
+            if (Message::receiverOf(package) != this->id) {
+                this->_forward(package, sender);
                 return false;
             }
-            this->groups.erase(std::remove(this->groups.begin(), this->groups.end(), groupMsg->groupId),
-                this->groups.end());
+            AddRemoveToGroupMessage group = AddRemoveToGroupMessage(package);
+            auto *groupMsg = &group;
+            bool changed;
+            if (groupMsg->isAddToGroup) {
+                changed = this->groups.add(groupMsg->groupId);
+            } else {
+                // every device stays in group 0
+                changed = groupMsg->groupId != 0 && this->groups.remove(groupMsg->groupId);
+            }
+            if (changed) this->_reportGroups();
 
             break;
         }
         case 4: {   // error message
+            ErrorMessage errMsg = ErrorMessage(package);
             if (this->id == 1) {
-                auto *errMsg = dynamic_cast<ErrorMessage *>(message);
-                this->_printError(errMsg->errorCode, errMsg->erroneousMessage);
+                this->_printError(errMsg.errorCode, errMsg.erroneousMessage);
                 return false;
             }
 
-            _sendInternal(message);
+            _sendInternal(&errMsg);
             break;
         }
         case 5: {   // disconnect message
-            auto *connectionMsg = dynamic_cast<ReDisconnectMessage *>(message);
+            ReDisconnectMessage connection = ReDisconnectMessage(package);
+            auto *connectionMsg = &connection;
             if (connectionMsg->receiver == this->id) {
-                if (connectionMsg->isDisconnect) {
+                if (connectionMsg->isDisconnect && this->registered) {
+                    // the hub considers this device lost, so it registers again with its ID
                     this->registered = false;
+                    this->_startDiscovery();
                 }
                 return false;
             }
 
             if (connectionMsg->isDisconnect) {
-                this->routingTable.erase(connectionMsg->receiver);
+                // the disconnect follows the route to the device, so the route is only removed behind it
                 this->_sendInternal(connectionMsg);
+                this->routingTable.erase(connectionMsg->receiver);
+                this->_removeChild(connectionMsg->receiver);
                 return false;
             }
 
             // Reconnect message
-            if (this->routingTable.count(connectionMsg->receiver) > 0) {
+            if (this->routingTable.contains(connectionMsg->receiver)) {
                 // there is a path from this node to the reconnecting node, so deconstruct this path
                 connectionMsg->isDisconnect = true;
             }
             // send the message on the old path, before updating the path
             this->_sendInternal(connectionMsg);
-            this->routingTable[connectionMsg->receiver] = sender;
+            this->routingTable.set(connectionMsg->receiver, sender);
+            break;
+        }
+        case 7: {   // group summary message
+            if (Message::receiverOf(package) != this->id) return false;
+            GroupSummaryMessage summary = GroupSummaryMessage(package);
+            if (summary.half > 1) return false;
+            for (uint8_t i = 0; i < 4; i++) {
+                if (this->children[i] != sender || sender == 0) continue;
+                this->childGroups[i].fromBytes(summary.groups, summary.half * GROUP_SUMMARY_SLOTS, GROUP_SUMMARY_SLOTS);
+                this->_reportGroups();
+                break;
+            }
             break;
         }
     }
@@ -228,134 +475,634 @@ uint8_t NetworkDevice::_getMessageID() {
     return this->nextID++;
 }
 
-bool NetworkDevice::isInGroup(uint8_t group) {
-    for (uint8_t i : groups) {
-        if (i == group) {
-            return true;
+void NetworkDevice::_createRoute(RegistrationMessage *registrationMsg, uint8_t sender) {
+    uint32_t time = this->_getTime();
+    this->tempRoutingTable.set(registrationMsg->tempID, sender, time);
+    if (this->id != 0) {
+        this->_sendInternal(registrationMsg);
+        return;
+    }
+
+    uint8_t requestedID = registrationMsg->newDeviceID;
+    // temporary IDs are only the boot time of the devices, so the remembered ID might belong to another device
+    // it is only given again, if no other device is reached by it
+    auto assigned = this->assignedIDs.find(registrationMsg->tempID);
+    if (assigned != this->assignedIDs.end() && this->routingTable.contains(assigned->second.id) &&
+        this->routingTable.nextHop(assigned->second.id, 0) != sender) {
+        this->assignedIDs.erase(assigned);
+        assigned = this->assignedIDs.end();
+    }
+    // a device keeps its temporary ID when it registers again, so only another device with the same ID is pinged
+    bool sameDevice = assigned != this->assignedIDs.end() && assigned->second.id == requestedID;
+    if (requestedID != 0 && !sameDevice && this->routingTable.contains(requestedID)) {
+        // if the device ID is set and there is a device with the ID already in the routing table,
+        // the hub has to ping id and wait for timeout, then accept
+        RegistrationPing &registrationPing = this->registrationPings[registrationMsg->tempID];
+        registrationPing.newDeviceID = requestedID;
+        registrationPing.tempID = registrationMsg->tempID;
+        registrationPing.timer.kind = REGISTRATION_PING_TIMER;
+        registrationPing.timer.key = registrationMsg->tempID;
+        this->timers.schedule(&registrationPing.timer, time, this->timeout + 1);
+        PingMessage pingMsg = PingMessage(requestedID, time % 256, this->id, false, time);
+        this->_sendInternal(&pingMsg);
+        return;
+    }
+
+    // keep the requested ID if it is free, otherwise assign the first free ID
+    // 0 is the hub and 255 the discovery channel, so they are never assigned
+    uint8_t newID = requestedID;
+    if (assigned != this->assignedIDs.end()) {
+        // the response to an earlier request of the device has been lost
+        newID = assigned->second.id;
+    } else if (newID == 0 || newID == DISCOVERY_CHANNEL) {
+        if (!this->routingTable.findFree(&newID, 1) || newID == DISCOVERY_CHANNEL) {
+            // the network is full, the device discovers again when its registration times out
+            this->tempRoutingTable.erase(registrationMsg->tempID);
+            return;
         }
     }
-    return false;
+    this->_rememberAssignedID(registrationMsg->tempID, newID, time);
+
+    this->routingTable.set(newID, sender);
+    this->tempRoutingTable.erase(registrationMsg->tempID);
+    RegistrationMessage answerMsg = RegistrationMessage(newID, newID, registrationMsg->tempID, 3, true);
+    this->_sendInternal(&answerMsg);
+    if (sender == DISCOVERY_CHANNEL || sender == newID) this->_addChild(newID);
 }
 
-bool NetworkDevice::registerDevice() {
-    uint8_t lowestLevel = 255;
-    uint8_t foundParent = 255;
-    for (auto pair: this->discovery->foundDevices) {
-        if (pair.second < lowestLevel) {
-            lowestLevel = pair.second;
-            foundParent = pair.first;
+void NetworkDevice::_rememberAssignedID(uint32_t tempID, uint8_t newID, uint32_t time) {
+    if (this->assignedIDs.size() >= ASSIGNED_IDS && this->assignedIDs.find(tempID) == this->assignedIDs.end()) {
+        auto oldest = this->assignedIDs.begin();
+        for (auto it = this->assignedIDs.begin(); it != this->assignedIDs.end(); ++it) {
+            if (Timer::elapsed(it->second.time, time) > Timer::elapsed(oldest->second.time, time)) oldest = it;
         }
+        this->assignedIDs.erase(oldest);
     }
-    if (foundParent == 255) return false;
+    this->assignedIDs[tempID] = {newID, time};
+}
 
-    this->tempID = this->_getTime();
+void NetworkDevice::_forgetAssignedID(uint8_t deviceID) {
+    for (auto it = this->assignedIDs.begin(); it != this->assignedIDs.end(); ++it) {
+        if (it->second.id == deviceID) {
+            this->assignedIDs.erase(it);
+            return;
+        }
+    }
+}
 
-    auto msg = new RegistrationMessage(foundParent, this->id, this->tempID, 1);
-    this->_sendInternal(msg);
-    delete msg;
+void NetworkDevice::_addChild(uint8_t childID) {
+    this->routingTable.set(childID, childID);
+    for (uint8_t &child : this->children) {
+        if (child == childID) return;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        if (this->children[i] == 0) {
+            this->children[i] = childID;
+            // the groups of the new child are unknown until it reports them
+            this->childGroups[i].clear();
+            return;
+        }
+    }
+}
+
+GroupSet NetworkDevice::getSubtreeGroups() const {
+    GroupSet subtree = this->groups;
+    for (const GroupSet &child : this->childGroups) {
+        subtree.add(child);
+    }
+    return subtree;
+}
+
+void NetworkDevice::_reportGroups() {
+    if (!this->registered || this->_isHub()) return;
+
+    this->groupsPending = false;
+    GroupSet subtree = this->getSubtreeGroups();
+    uint8_t current[GROUP_SUMMARY_SLOTS];
+    uint8_t reported[GROUP_SUMMARY_SLOTS];
+    for (uint8_t half = 0; half < 2; half++) {
+        subtree.toBytes(current, half * GROUP_SUMMARY_SLOTS, GROUP_SUMMARY_SLOTS);
+        this->reportedGroups.toBytes(reported, half * GROUP_SUMMARY_SLOTS, GROUP_SUMMARY_SLOTS);
+        if (memcmp(current, reported, GROUP_SUMMARY_SLOTS) == 0) continue;
+
+        GroupSummaryMessage summary = GroupSummaryMessage(this->parent, half, current);
+        // the send queue is full, so the half is reported again on the next update
+        if (!this->_sendInternal(&summary)) {
+            this->groupsPending = true;
+            continue;
+        }
+        this->reportedGroups.fromBytes(current, half * GROUP_SUMMARY_SLOTS, GROUP_SUMMARY_SLOTS);
+    }
+}
+
+void NetworkDevice::_removeChild(uint8_t childID) {
+    for (uint8_t i = 0; i < 4; i++) {
+        if (this->children[i] == childID) {
+            this->children[i] = 0;
+            this->childGroups[i].clear();
+            return;
+        }
+    }
+}
+
+void NetworkDevice::_timerExpired(WheelTimer *timer, uint32_t time) {
+    switch (timer->kind) {
+        case REGISTRATION_PING_TIMER: {
+            auto ping = this->registrationPings.find(timer->key);
+            if (ping == this->registrationPings.end()) return;
+            RegistrationPing expired = ping->second;
+            this->registrationPings.erase(ping);
+            this->_registrationPingExpired(expired);
+            break;
+        }
+        case LIVENESS_TIMER: {
+            this->_sendLivenessPing(time);
+            break;
+        }
+        case LIVENESS_PING_TIMER: {
+            this->_livenessPingExpired(timer->key);
+            break;
+        }
+        case REASSEMBLY_TIMER: {
+            // drop data messages of which a package has been lost
+            this->messageBuilder.update(time);
+            break;
+        }
+        case DISCOVERY_ANSWER_TIMER: {
+            // the back-off is not part of the round trip time
+            this->_answerDiscovery(this->discoveryRequester,
+                this->discoveryEcho + Timer::elapsed(this->discoveryEchoTime, time));
+            break;
+        }
+    }
+}
+
+void NetworkDevice::_registrationPingExpired(const RegistrationPing &ping) {
+    // the route to the registering device has expired, so the registration has been abandoned
+    uint8_t tempNextHop;
+    if (!this->tempRoutingTable.get(ping.tempID, &tempNextHop)) return;
+
+    // The ping for an ID a device is trying to register with has timed out, so send a disconnect message on the old path
+    ReDisconnectMessage msg = ReDisconnectMessage(ping.newDeviceID, true);
+    this->_sendInternal(&msg);
+    // then update the routing table
+    this->routingTable.set(ping.newDeviceID, tempNextHop);
+    this->tempRoutingTable.erase(ping.tempID);
+    // and accept the registration request
+    RegistrationMessage answerMsg = RegistrationMessage(ping.newDeviceID, ping.newDeviceID, ping.tempID, 3, true);
+    this->_sendInternal(&answerMsg);
+    if (tempNextHop == DISCOVERY_CHANNEL || tempNextHop == ping.newDeviceID) this->_addChild(ping.newDeviceID);
+}
+
+void NetworkDevice::_setLivenessInterval(uint32_t interval) {
+    this->livenessInterval = interval;
+    if (interval == 0) {
+        this->timers.cancel(&this->livenessTimer);
+        return;
+    }
+    if (!this->livenessTimer.scheduled()) this->timers.schedule(&this->livenessTimer, this->_getTime(), interval);
+}
+
+void NetworkDevice::_sendLivenessPing(uint32_t time) {
+    if (this->livenessInterval == 0) return;
+
+    // each device is pinged once per interval
+    uint16_t devices = this->routingTable.size();
+    uint32_t delay = this->livenessInterval / (devices > 0 ? devices : 1);
+    this->timers.schedule(&this->livenessTimer, time, delay > 0 ? delay : 1);
+
+    uint8_t deviceID;
+    if (!this->routingTable.next(&deviceID, this->nextLivenessDevice) && !this->routingTable.next(&deviceID, 1)) {
+        return;
+    }
+    this->nextLivenessDevice = deviceID + 1;
+    // the hub and the discovery channel are never pinged
+    if (deviceID == 0 || deviceID == DISCOVERY_CHANNEL) return;
+
+    LivenessPing &liveness = this->livenessPings[deviceID];
+    // the answer to the previous ping is overdue, since the device is pinged once per interval
+    if (liveness.timer.scheduled()) {
+        this->timers.cancel(&liveness.timer);
+        if (this->_livenessPingExpired(deviceID)) return;
+    }
+
+    liveness.pingID = this->_getMessageID();
+    liveness.timer.kind = LIVENESS_PING_TIMER;
+    liveness.timer.key = deviceID;
+    // the ping and its answer may be sent again on each hop, so the answer is awaited until the next ping
+    uint32_t pingTimeout = this->livenessInterval > this->timeout ? this->livenessInterval : this->timeout + 1;
+    this->timers.schedule(&liveness.timer, time, pingTimeout);
+    PingMessage pingMsg = PingMessage(deviceID, liveness.pingID, this->id, false, time);
+    this->_sendInternal(&pingMsg);
+}
+
+bool NetworkDevice::_livenessPingExpired(uint8_t deviceID) {
+    auto liveness = this->livenessPings.find(deviceID);
+    if (liveness == this->livenessPings.end()) return false;
+    if (++liveness->second.misses < LIVENESS_ATTEMPTS) return false;
+    this->_disconnect(deviceID);
     return true;
 }
 
-void NetworkDevice::startBenchmark() {
-    // Check for a better connection with benchmarks
+void NetworkDevice::_disconnect(uint8_t deviceID) {
+    ReDisconnectMessage msg = ReDisconnectMessage(deviceID, true);
+    this->_sendInternal(&msg);
+    this->routingTable.erase(deviceID);
+    this->_removeChild(deviceID);
+    this->_forgetAssignedID(deviceID);
 
-    uint8_t numberDevices = this->discovery->foundDevices.size();
+    auto liveness = this->livenessPings.find(deviceID);
+    if (liveness != this->livenessPings.end()) {
+        this->timers.cancel(&liveness->second.timer);
+        this->livenessPings.erase(liveness);
+    }
+}
 
-    auto *devices = new uint8_t[numberDevices];
+bool NetworkDevice::nextTimer(uint32_t *delay) {
+    uint32_t time = this->_getTime();
+    bool scheduled = false;
+    auto schedule = [&](uint32_t wait) {
+        if (!scheduled || wait < *delay) *delay = wait;
+        scheduled = true;
+    };
 
-    for (uint8_t i = 0; i < numberDevices; ++i) {
-        devices[i] = this->discovery->foundDevices[i].first;
+    uint32_t expiry;
+    if (this->timers.nextExpiry(&expiry)) {
+        schedule(static_cast<int32_t>(expiry - time) > 0 ? expiry - time : 0);
+    }
+    if (this->discovery != nullptr) schedule(this->discovery->nextUpdate(time));
+    if (this->registering) schedule(this->registrationTimer.remaining(time));
+
+    uint32_t wait;
+    if (this->benchmark_wrapper != nullptr && this->benchmark_wrapper->nextUpdate(time, &wait)) schedule(wait);
+    if (this->reliableLinks.nextRetransmission(time, &wait)) schedule(wait);
+    for (uint8_t i = 0; i < AGGREGATE_LINKS; i++) {
+        if (this->aggregates[i].count > 0) schedule(this->aggregateTimers[i].remaining(time));
+    }
+
+    if (!this->rxQueue.empty()) schedule(0);
+    uint8_t package[PACKAGE_SIZE];
+    if (this->outgoing != nullptr && this->_outgoingFits(package)) schedule(0);
+    if (this->groupsPending && !this->txQueue.full()) schedule(0);
+    // packages waiting for the window of their neighbour are sent after its acknowledgement arrived
+    for (uint8_t i = 0; i < this->txQueue.size(); i++) {
+        const QueuedPackage &queued = this->txQueue.at(i);
+        ReliableLink *link = this->reliableLinks.find(queued.link);
+        if (!queued.reliable || link == nullptr || link->canSend()) {
+            schedule(0);
+            break;
+        }
     }
+    return scheduled;
+}
 
-    this->benchmark_wrapper = new ConnectionBenchmarkWrapper(&devices, numberDevices, 50, 1000, this->_getTime(), this->id);
+/**
+ * @param package A raw package.
+ * @return False if the package is a ping or a frame of pings, so it only belongs to the periodic checks.
+ */
+static bool carriesData(const uint8_t *package) {
+    uint8_t type = Message::typeOf(package);
+    if (type == 2) return false;
+    if (type != 8) return true;
 
+    uint8_t packed[PACKAGE_SIZE];
+    uint8_t offset = 0;
+    while (AggregateMessage::unpack(package, &offset, packed)) {
+        if (carriesData(packed)) return true;
+    }
+    return false;
 }
 
-bool NetworkDevice::update() {
+bool NetworkDevice::isQuiet() const {
+    if (this->discovery != nullptr || this->registering ||
+        (this->benchmark_wrapper != nullptr && !this->benchmark_wrapper->finished()) || this->outgoing != nullptr) {
+        return false;
+    }
+    for (uint8_t i = 0; i < this->rxQueue.size(); i++) {
+        if (carriesData(this->rxQueue.at(i).package)) return false;
+    }
+    for (uint8_t i = 0; i < this->txQueue.size(); i++) {
+        if (carriesData(this->txQueue.at(i).package)) return false;
+    }
+    uint8_t frame[PACKAGE_SIZE] = {};
+    for (const AggregateMessage &aggregate : this->aggregates) {
+        if (aggregate.count == 0) continue;
+        memcpy(frame + HEADER_SLOTS, aggregate.entries, AGGREGATE_SLOTS);
+        if (carriesData(frame)) return false;
+    }
+    return !this->reliableLinks.anyInFlight(carriesData);
+}
+
+uint8_t NetworkDevice::_freeChildSlots() const {
+    uint8_t free = 0;
+    for (const uint8_t child : this->children) {
+        if (child == 0) ++free;
+    }
+    // devices without ID, that are registering with this one, take a slot as soon as they are accepted
+    uint8_t pending = this->tempRoutingTable.count(DISCOVERY_CHANNEL);
+    return free > pending ? free - pending : 0;
+}
 
-    if (this->discovery != nullptr) {
+void NetworkDevice::_startDiscovery() {
+    delete this->discovery;
+    uint8_t targets[NEIGHBOR_CACHE_SLOTS];
+    uint8_t targetCount = this->neighbors.fresh(this->_getTime(), targets);
+    if (targetCount > 0) {
+        this->discovery = new Discovery(this->timeout, this->id, targets, targetCount);
+    } else {
+        this->discovery = new Discovery(this->timeout, this->id, this->broadcastDiscovery);
+    }
+}
 
+void NetworkDevice::_updateDiscovery(uint32_t time) {
+    for (uint8_t i = 0; i < DISCOVERY_BURST && this->discovery != nullptr; i++) {
         Message* messageAddress[1];
         *messageAddress = nullptr;
-        bool finished = this->discovery->update(this->_getTime(), messageAddress);
+        // the temporary ID tells the answers to the requests of this device apart from the answers to other devices
+        if (this->tempID == 0) this->tempID = time;
+        bool finished = this->discovery->update(time, this->tempID, messageAddress);
+        if (finished && !this->discovery->getTargets().empty()) {
+            // cached neighbours that did not answer are gone or have no free child slot anymore
+            for (uint8_t target : this->discovery->getTargets()) {
+                if (!this->discovery->answered(target)) this->neighbors.erase(target);
+            }
+            // without answers all cached neighbours are dropped, so all devices are asked now
+            if (this->discovery->foundDevices.empty()) {
+                this->_startDiscovery();
+                continue;
+            }
+        }
         if (finished) {
+            bool parentFound = true;
             if (this->registered) this->startBenchmark();
-            else this->registerDevice();
+            else parentFound = this->registerDevice();
 
             delete this->discovery;
             this->discovery = nullptr;
-        } else if (*messageAddress != nullptr) {
-            this->_sendInternal(*messageAddress);
-            delete *messageAddress;
+            // no device answered, so try again
+            if (!parentFound) this->_startDiscovery();
+            return;
         }
+        // waiting for answers
+        if (*messageAddress == nullptr) return;
+
+        // discoveries are sent directly to the pinged ID or the discovery channel,
+        // the device might not be in the routing table
+        this->_sendDirect(*messageAddress, (*messageAddress)->receiver);
+        delete *messageAddress;
+    }
+}
+
+void NetworkDevice::_answerDiscovery(uint32_t requester, uint32_t echo) {
+    // the slots might have been taken during the back-off
+    uint8_t freeSlots = this->_freeChildSlots();
+    if (!this->registered || freeSlots == 0) return;
+
+    // the discovering device may not have an ID yet, so the answer is sent on the discovery channel
+    RegistrationMessage answer = RegistrationMessage(DISCOVERY_CHANNEL, this->id, echo, 0, this->hierarchyLevel);
+    answer.freeSlots = freeSlots;
+    answer.requester = requester;
+    this->_sendDirect(&answer, DISCOVERY_CHANNEL);
+}
+
+uint32_t NetworkDevice::_random() {
+    if (this->randomState == 0) {
+        this->randomState = (this->id + 1) * UINT32_C(2654435761) ^ this->_getTime();
+        if (this->randomState == 0) this->randomState = 1;
     }
+    // xorshift
+    this->randomState ^= this->randomState << 13;
+    this->randomState ^= this->randomState >> 17;
+    this->randomState ^= this->randomState << 5;
+    return this->randomState;
+}
+
+void NetworkDevice::_initHub() {
+    this->registered = true;
+    this->hierarchyLevel = 0;
+    delete this->discovery;
+    this->discovery = nullptr;
+    if (this->transport != nullptr) this->transport->setAddress(this->_address());
+}
+
+bool NetworkDevice::isIdle() const {
+    // the timers of the timer wheel are not checked, see nextTimer
+    return this->discovery == nullptr &&
+        (this->benchmark_wrapper == nullptr || this->benchmark_wrapper->finished()) && !this->registering &&
+        this->rxQueue.empty() && this->txQueue.empty() && this->outgoing == nullptr && !this->groupsPending &&
+        this->reliableLinks.idle() && std::all_of(this->aggregates, this->aggregates + AGGREGATE_LINKS,
+            [](const AggregateMessage &aggregate) { return aggregate.count == 0; });
+}
 
-    if (this->benchmark_wrapper != nullptr) {
+bool NetworkDevice::_registerWithNextCandidate() {
+    ParentCandidate candidate;
+    if (!this->parentCandidates.next(&candidate)) return false;
+
+    uint32_t time = this->_getTime();
+    // repeated requests keep the temporary ID, so the hub assigns the same ID again
+    if (this->tempID == 0) this->tempID = time;
+    this->parent = candidate.id;
+    this->hierarchyLevel = candidate.level + 1;
+    this->registering = true;
+    this->registrationTimer = Timer(this->timeout).start(time);
+
+    auto msg = new RegistrationMessage(candidate.id, this->id, this->tempID, 1);
+    this->_sendInternal(msg);
+    delete msg;
+    return true;
+}
+
+bool NetworkDevice::registerDevice() {
+    this->parentCandidates.clear();
+    for (const DiscoveredDevice &device : this->discovery->foundDevices) {
+        uint16_t rtt = device.rtt;
+        uint8_t deliveryRatio = 100;
+        // a benchmark measures the link better than the single answer of the discovery
+        const LinkEstimator *estimate = this->benchmark_wrapper != nullptr ?
+            this->benchmark_wrapper->getEstimator(device.id) : nullptr;
+        if (estimate != nullptr && estimate->getSentCount() > 0) {
+            deliveryRatio = estimate->deliveryRatio();
+            if (estimate->getReceivedCount() > 0) rtt = estimate->getRtt();
+        }
+        const Neighbor *neighbor = this->neighbors.get(device.id);
+        if (rtt == UINT16_MAX && neighbor != nullptr && neighbor->rtt != 0) rtt = neighbor->rtt;
+        this->parentCandidates.add(device.id, device.level, device.freeSlots, rtt, deliveryRatio);
+    }
+    return this->_registerWithNextCandidate();
+}
+
+void NetworkDevice::startBenchmark() {
+    // Check for a better connection with benchmarks
+
+    uint8_t numberDevices = this->discovery->foundDevices.size();
+
+    uint8_t devices[256];
+
+    for (uint8_t i = 0; i < numberDevices; ++i) {
+        devices[i] = this->discovery->foundDevices[i].id;
+    }
+
+    delete this->benchmark_wrapper;
+    this->benchmark_wrapper = new ConnectionBenchmarkWrapper(devices, numberDevices, BENCHMARK_PINGS, BENCHMARK_TIMEOUT,
+        this->benchmarkWindow, this->id);
+}
+
+bool NetworkDevice::rediscover() {
+    if (!this->registered || this->_isHub() || this->discovery != nullptr ||
+        (this->benchmark_wrapper != nullptr && !this->benchmark_wrapper->finished())) {
+        return false;
+    }
+    this->_startDiscovery();
+    return true;
+}
+
+bool NetworkDevice::update() {
+
+    this->_updateDiscovery(this->_getTime());
+
+    // the response to the registration request has been lost, the parent might be out of range or its slots taken,
+    // so try the next candidate and then discover the parents again
+    if (this->registering && this->registrationTimer.expired(this->_getTime())) {
+        this->registering = false;
+        if (!this->_registerWithNextCandidate()) this->_startDiscovery();
+    }
+
+    // the benchmark keeps its window of pings in flight until the best connection is clear
+    for (uint8_t i = 0; i < BENCHMARK_MAX_WINDOW && this->benchmark_wrapper != nullptr; i++) {
         Message* messageAddress[1];
         *messageAddress = nullptr;
-        bool finished = this->benchmark_wrapper->update(this->_getTime(), messageAddress);
-        if (finished) {
-
-            delete this->benchmark_wrapper;
-            this->benchmark_wrapper = nullptr;
-        } else if (*messageAddress != nullptr) {
-            this->_sendInternal(*messageAddress);
-            delete *messageAddress;
+        // the ping takes the next message ID, which is only used up if a ping is created
+        if (this->benchmark_wrapper->update(this->_getTime(), this->nextID, messageAddress) ||
+            *messageAddress == nullptr) {
+            break;
         }
+        this->_getMessageID();
+        this->_sendDirect(*messageAddress, (*messageAddress)->receiver);
+        delete *messageAddress;
     }
 
     auto time = this->_getTime();
 
-    // hub checks pending registration pings for timeouts
-    // other devices do not add elements to the vector, so an if clause is not needed
-    for (uint8_t i = 0; i < this->registrationPings.size(); ++i) {
-        auto ping = this->registrationPings[i];
-        if (!ping.timer.expired(time)) continue;
+    // drop routes of registrations that have been abandoned
+    this->tempRoutingTable.update(time);
+
+    // registration pings, periodic pings of the hub, reassemblies and discovery answers
+    WheelTimer *expired;
+    while ((expired = this->timers.poll(time)) != nullptr) {
+        this->_timerExpired(expired, time);
+    }
+
+    // move the received packages from the data link layer into the receive queue
+    for (uint8_t i = 0; i < this->updateBudget && !this->rxQueue.full() && this->_messageAvailable(); i++) {
+        QueuedPackage *slot = this->rxQueue.reserve();
+        slot->link = this->_read(slot->package);
+        this->rxQueue.commit();
+    }
+
+    // process the queued packages, but stop at a completed data message, so it is not overwritten
+    bool dataCompleted = false;
+    for (uint8_t i = 0; i < this->updateBudget && !this->rxQueue.empty() && !dataCompleted; i++) {
+        QueuedPackage &received = this->rxQueue.front();
+        dataCompleted = this->_receivePackage(received.package, received.link);
+        this->rxQueue.pop();
+    }
+
+    // send the frames whose coalescing window has expired
+    time = this->_getTime();
+    for (uint8_t i = 0; i < AGGREGATE_LINKS; i++) {
+        if (this->aggregates[i].count > 0 && this->aggregateTimers[i].expired(time)) this->_flushAggregate(i);
+    }
 
-        this->registrationPings.erase(find(this->registrationPings.begin(), this->registrationPings.end(), ping));
+    this->_serviceLinks(this->updateBudget);
+    // the packages written in the last update made room for the group summaries and the outgoing message
+    if (this->groupsPending) this->_reportGroups();
+    this->_feedOutgoing();
+    this->_drainTx(this->updateBudget);
+    return dataCompleted;
+}
 
-        // The ping for an ID a device is trying to register with has timed out, so send a disconnect message on the old path
-        ReDisconnectMessage msg = ReDisconnectMessage(ping.newDeviceID, true);
-        this->_sendInternal(&msg);
-        // then update the routing table
-        this->routingTable[ping.newDeviceID] = this->tempRoutingTable[ping.tempID];
-        this->tempRoutingTable.erase(ping.tempID);
-        // and accept the registration request
-        RegistrationMessage answerMsg = RegistrationMessage(ping.newDeviceID, ping.newDeviceID, ping.tempID, 3, true);
-        this->_sendInternal(&answerMsg);
+bool NetworkDevice::_receivePackage(const uint8_t *package, uint8_t sender) {
+    // drop packages that have been corrupted on the way, so they cannot change routes
+    if (!Message::verifyChecksum(package)) {
+        ++this->corruptPackages;
+        return false;
+    }
 
-        // index is changed after erase, so decrement i
-        --i;
+    // acknowledgements are only meant for the neighbour and never forwarded
+    if (Message::typeOf(package) == 6) {
+        AckMessage ack = AckMessage(package);
+        ReliableLink *link = this->reliableLinks.find(sender);
+        if (ack.receiver == this->id && link != nullptr) {
+            link->acknowledge(ack.cumulativeAck, ack.selectiveAcks, this->_getTime());
+        }
+        return false;
     }
 
-    if (!_messageAvailable()) return false;
+    // devices that are not part of the network only take part in the registration
+    if (!this->registered && Message::typeOf(package) != 1) return false;
 
-    Message* messageAddress[1];
-    uint8_t sender = this->_read(messageAddress);
-    Message* message = *messageAddress;
+    // drop packages that have been received already, because the acknowledgement has been lost
+    uint8_t transmission = Message::transmissionOf(package);
+    if (transmission & RELIABLE_FLAG &&
+        !this->reliableLinks.get(sender, this->_getTime())->receive(transmission & SEQUENCE_MASK)) {
+        return false;
+    }
 
-    if (message->group) {
+    if (Message::typeOf(package) == 8) {
+        // split the frame into the packed packages, none of them completes a data message
+        uint8_t packed[PACKAGE_SIZE];
+        uint8_t offset = 0;
+        bool dataCompleted = false;
+        while (AggregateMessage::unpack(package, &offset, packed)) {
+            dataCompleted = this->_handlePackage(packed, sender) || dataCompleted;
+        }
+        return dataCompleted;
+    }
+    return this->_handlePackage(package, sender);
+}
+
+bool NetworkDevice::_handlePackage(const uint8_t *package, uint8_t sender) {
+    uint8_t receiver = Message::receiverOf(package);
+
+    if (Message::isGroupPackage(package)) {
         // group messages are always broadcasted
-        this->_sendInternal(message, sender);
+        this->_forward(package, sender);
         // group message cannot contain messages that hops on the way need to process
-        if (this->isInGroup(message->receiver)) {
-            return this->_processMessage(message, sender);
+        if (this->isInGroup(receiver)) {
+            return this->_processMessage(package, sender);
         }
     } else {
         // forward data messages if this is not the receiver (including broadcasts)
-        if (message->getType() == 0 && message->receiver != this->id) {
-            this->_sendInternal(message, sender);
+        if (Message::typeOf(package) == 0 && receiver != this->id) {
+            this->_forward(package, sender);
             return false;
         }
         // message might contain info this device needs even if device is not the receiver
-        return this->_processMessage(message, sender);
+        return this->_processMessage(package, sender);
     }
 
-    delete message;
-
     return false;
 }
 
+bool NetworkDevice::_write(const uint8_t *package, uint8_t nextHop) {
+    return this->transport != nullptr && this->transport->write(package, nextHop);
+}
+
+uint8_t NetworkDevice::_read(uint8_t *package) {
+    return this->transport->read(package);
+}
+
+bool NetworkDevice::_messageAvailable() {
+    return this->transport != nullptr && this->transport->messageAvailable();
+}
+
+uint32_t NetworkDevice::_getTime() {
+    return this->transport != nullptr ? this->transport->getTime() : 0;
+}
+
+void NetworkDevice::_printError(uint8_t errCode, const uint8_t *msg) {
+}
+
 bool NetworkDevice::send(uint8_t receiver, uint8_t *data, uint16_t dataSize) {
     return this->_assembleAndSend(receiver, false, data, dataSize);
 }
@@ -1,24 +1,83 @@
 #ifndef NETWORKDEVICE_H
 #define NETWORKDEVICE_H
+#include <cstddef>
 #include <cstdint>
 #include <map>
-#include <vector>
 
 #include "ConnectionBenchmark/ConnectionBenchmarkWrapper.h"
 #include "Discovery.h"
+#include "groupSet.h"
+#include "neighborCache.h"
+#include "packageQueue.h"
+#include "parentSelector.h"
+#include "reliableLink.h"
+#include "routingTable.h"
+#include "tempRoutingTable.h"
 #include "timer.h"
+#include "timerWheel.h"
+#include "transport.h"
+#include "Messages/messageBuilder.h"
 #include "Messages/messageObjects.h"
 
+#define RX_QUEUE_SIZE 8
+#define TX_QUEUE_SIZE 16
+#define UPDATE_BUDGET 8
+#define MAX_WRITE_ATTEMPTS 3
+#define AGGREGATE_LINKS 4
+#define LIVENESS_ATTEMPTS 3
+#define BENCHMARK_PINGS 50
+#define BENCHMARK_TIMEOUT 250
+#define BENCHMARK_WINDOW 4
+#define DISCOVERY_BURST 8
+#define ASSIGNED_IDS 16
+
+#define REGISTRATION_PING_TIMER 1
+#define LIVENESS_TIMER 2
+#define LIVENESS_PING_TIMER 3
+#define REASSEMBLY_TIMER 4
+#define DISCOVERY_ANSWER_TIMER 5
+
 typedef struct RegistrationPing {
     uint8_t newDeviceID;
-    Timer timer;
+    WheelTimer timer;
     uint32_t tempID;
-
-    bool operator==(const RegistrationPing &other) const {
-        return this->tempID == other.tempID && this->newDeviceID == other.newDeviceID;
-    }
 } RegistrationPing;
 
+/**
+ * State of the periodic pings of the hub to a device.
+ */
+typedef struct LivenessPing {
+    /**
+     * ID of the pending ping.
+     */
+    uint8_t pingID;
+
+    /**
+     * Number of pings in a row, that have not been answered.
+     */
+    uint8_t misses;
+
+    /**
+     * Timeout of the pending ping. Not scheduled while no ping is pending.
+     */
+    WheelTimer timer;
+} LivenessPing;
+
+/**
+ * ID the hub has assigned to a registering device without ID.
+ */
+typedef struct AssignedID {
+    /**
+     * The assigned ID.
+     */
+    uint8_t id;
+
+    /**
+     * Time of the assignment, the oldest one is dropped when the hub remembers ASSIGNED_IDS IDs.
+     */
+    uint32_t time;
+} AssignedID;
+
 typedef struct Ping {
     Timer timer;
     uint32_t responseTime;
@@ -50,20 +109,33 @@ class NetworkDevice {
      */
     uint8_t children[4] = {};
 
+    /**
+     * Groups of the devices in the subtree of each child, as reported by the child. Parallel to the children.
+     * Group messages are only forwarded to children, whose subtree contains a member of the group.
+     */
+    GroupSet childGroups[4];
+
+    /**
+     * Groups of the subtree of this device, that have been reported to the parent last.
+     */
+    GroupSet reportedGroups;
+
+    /**
+     * True if a summary of the groups could not be queued. It is sent again on the next update.
+     */
+    bool groupsPending = false;
+
     /**
      * The routing table holds the next hop for all descendant nodes. If an ID is not in the routing table,
      * the node can be reached over the parent.
-     * Key: ID of the descendant node.
-     * Value: ID of the children over which the node can be reached.
      */
-    std::map<uint8_t, uint8_t> routingTable;
+    RoutingTable routingTable;
 
     /**
      * The temporary routing table holds the next hop for all descendant nodes that only have a temporary ID.
-     * Key: Temporary ID of the descendant node.
-     * Value: ID of the children over which the node can be reached.
+     * Routes of registrations, that are not completed, expire.
      */
-    std::map<uint32_t, uint8_t> tempRoutingTable;
+    TempRoutingTable tempRoutingTable;
 
     /**
      * This map holds the starting times of all active pings, that not have been queried yet.
@@ -73,14 +145,86 @@ class NetworkDevice {
     std::map<uint8_t, Ping> pings;
 
     /**
-     * Vector of all registration pings sent by this device.
+     * IDs assigned by the hub, so a device repeating its registration gets the same ID again.
+     * Entries are dropped once the device answers a ping with its ID or is disconnected.
+     * Key: Temporary ID of the device.
+     * Value: Assigned ID.
+     */
+    std::map<uint32_t, AssignedID> assignedIDs;
+
+    /**
+     * Registration pings sent by the hub, that have not timed out yet.
+     * Key: Temporary ID of the registering device.
+     * Value: Registration ping. Its timer is scheduled on the timer wheel, so it must stay in place.
+     */
+    std::map<uint32_t, RegistrationPing> registrationPings;
+
+    /**
+     * Periodic pings of the hub to each device in its routing table.
+     * Key: ID of the device.
+     * Value: Ping state. Its timer is scheduled on the timer wheel, so it must stay in place.
+     */
+    std::map<uint8_t, LivenessPing> livenessPings;
+
+    /**
+     * Time in milliseconds in which the hub pings each device once. 0 disables the pings.
+     */
+    uint32_t livenessInterval = 0;
+
+    /**
+     * Device pinged next by the hub.
      */
-    std::vector<RegistrationPing> registrationPings;
+    uint8_t nextLivenessDevice = 1;
+
+    /**
+     * Timer for the next periodic ping of the hub.
+     */
+    WheelTimer livenessTimer{LIVENESS_TIMER};
+
+    /**
+     * Timer that drops the incomplete data messages. Restarted with every received data package.
+     */
+    WheelTimer reassemblyTimer{REASSEMBLY_TIMER};
+
+    /**
+     * Back-off of the answer to a broadcast discovery, so the devices in range do not answer at the same time.
+     */
+    WheelTimer discoveryAnswerTimer{DISCOVERY_ANSWER_TIMER};
+
+    /**
+     * Temporary ID of the device whose broadcast discovery is answered after the back-off.
+     */
+    uint32_t discoveryRequester = 0;
+
+    /**
+     * Send time of the broadcast discovery answered after the back-off, echoed in the answer.
+     */
+    uint32_t discoveryEcho = 0;
+
+    /**
+     * Time the back-off of the discovery answer has been started.
+     */
+    uint32_t discoveryEchoTime = 0;
+
+    /**
+     * True if discoveries are broadcast on the discovery channel, false if each ID is pinged.
+     */
+    bool broadcastDiscovery = true;
+
+    /**
+     * State of the random numbers for the back-offs. 0 until the first number is drawn.
+     */
+    uint32_t randomState = 0;
+
+    /**
+     * Protocol timers, so each update only handles the expired timers instead of checking all pending ones.
+     */
+    TimerWheel timers;
 
     /**
      * IDs of the groups this device is part of.
      */
-    std::vector<uint8_t> groups;
+    GroupSet groups;
 
     /**
      * Size of the data array of the last message received.
@@ -102,46 +246,325 @@ class NetworkDevice {
      */
     uint8_t *lastData {};
 
+    /**
+     * Assembles data messages that consist of multiple packages.
+     */
+    MessageBuilder messageBuilder;
+
     /**
      * Represents an ongoing discovery.
      */
     Discovery* discovery{};
 
     /**
-     * Wrapper for ongoing benchmarks.
+     * Devices in range heard in discoveries, so rediscoveries ask them first.
+     */
+    NeighborCache neighbors;
+
+    /**
+     * Discovered devices, that have not been tried as parent yet.
+     */
+    ParentSelector parentCandidates;
+
+    /**
+     * Wrapper for the ongoing or last benchmarks.
      */
     ConnectionBenchmarkWrapper* benchmark_wrapper;
 
+    /**
+     * Maximum number of benchmark pings in flight.
+     */
+    uint8_t benchmarkWindow = BENCHMARK_WINDOW;
+
     /**
      * Timeout for timers.
      */
     uint16_t timeout;
 
     /**
-     * Assembles a data message object and sends it.
+     * Number of received packages dropped, because their checksum was wrong.
+     */
+    uint32_t corruptPackages = 0;
+
+    /**
+     * Packages read from the data link layer, that have not been processed yet.
+     */
+    PackageQueue<RX_QUEUE_SIZE> rxQueue;
+
+    /**
+     * Packages waiting to be written to the data link layer.
+     */
+    PackageQueue<TX_QUEUE_SIZE> txQueue;
+
+    /**
+     * Data message sent by this device, whose packages do not fit into the send queue at once, nullptr if there is
+     * none. It owns a copy of the data, so the caller of send can free it.
+     */
+    DataMessage *outgoing = nullptr;
+
+    /**
+     * Number of packages of the outgoing message, that have been queued already.
+     */
+    uint8_t outgoingPackages = 0;
+
+    /**
+     * Maximum number of packages read, processed and written in each update.
+     */
+    uint8_t updateBudget = UPDATE_BUDGET;
+
+    /**
+     * Number of packages dropped, because writing them failed MAX_WRITE_ATTEMPTS times.
+     */
+    uint32_t failedWrites = 0;
+
+    /**
+     * Acknowledgements and retransmissions of the packages exchanged with each neighbour.
+     */
+    ReliableLinks reliableLinks;
+
+    /**
+     * Data link layer used by the default implementations of the data link methods. Not owned by this device.
+     */
+    Transport *transport = nullptr;
+
+    /**
+     * True while a registration request is waiting for its response.
+     */
+    bool registering = false;
+
+    /**
+     * Timer for the response to the registration request. The discovery is started again when it expires.
+     */
+    Timer registrationTimer;
+
+    /**
+     * Frames of small messages waiting for more messages to the same neighbour. Empty frames are free.
+     */
+    AggregateMessage aggregates[AGGREGATE_LINKS];
+
+    /**
+     * Coalescing windows of the frames. A frame is sent when its window expires.
+     */
+    Timer aggregateTimers[AGGREGATE_LINKS];
+
+    /**
+     * Time in milliseconds small messages wait for other messages to the same neighbour. 0 disables the aggregation.
+     */
+    uint16_t aggregationWindow = 0;
+
+    /**
+     * Assembles a data message object and sends it. The packages that do not fit into the send queue are queued by the
+     * next updates, so the message is sent completely or not at all.
      * @param receiver ID of the message's receiver/receiving group.
      * @param group True if the receiver is a group.
-     * @param data Data of the message.
-     * @param dataSize Size of the data.
-     * @return True if the message has been sent successfully.
+     * @param data Data of the message. It is copied.
+     * @param dataSize Size of the data, 1 to MAX_DATA_SIZE bytes.
+     * @return False if the size is invalid or the previous message has not been queued completely yet,
+     * so this one is not sent.
      */
     bool _assembleAndSend(uint8_t receiver, bool group, uint8_t* data, uint16_t dataSize);
 
     /**
-     * Sends the given message.
+     * Sends the given message. Each package is serialized into a buffer on the stack and copied into the send queue,
+     * so no memory is allocated.
      * @param message The message to be sent.
      * @param sender Sender of the message, if it has been received.
-     * @return True if the message has been sent successfully.
+     * @return True if all packages of the message have been queued.
      */
     bool _sendInternal(Message *message, uint8_t sender = 0);
 
     /**
-     * Processes the received message.
-     * @param message Received message.
+     * Sends a message of one package directly to a neighbour, without routing and acknowledgements.
+     * @param message The message to be sent.
+     * @param link The neighbour or the discovery channel.
+     * @return True if the package has been queued.
+     */
+    bool _sendDirect(Message *message, uint8_t link);
+
+    /**
+     * Adds a raw package to the send queue. If the aggregation is enabled, small packages are packed into
+     * the frame of their next hop instead.
+     * @param package Raw package to be sent.
+     * @param nextHop The next hop on the route.
+     * @param reliable False if the package must not be sent over the reliable link, e.g. for discoveries.
+     * @return False if the package has been dropped, because the queue is full.
+     */
+    bool _enqueue(const uint8_t *package, uint8_t nextHop, bool reliable = true);
+
+    /**
+     * Adds a raw package to the send queue. The queue is only drained by update(), so a full queue drops the package.
+     * @param package Raw package to be sent.
+     * @param nextHop The next hop on the route.
+     * @param reliable False if the package must not be sent over the reliable link.
+     * @return False if the package has been dropped, because the queue is full.
+     */
+    bool _queue(const uint8_t *package, uint8_t nextHop, bool reliable);
+
+    /**
+     * Packs a raw package into the frame of its next hop. The frame of the next hop is sent first, if the package
+     * cannot be packed, so the packages to a neighbour keep their order.
+     * @param package Raw package to be sent.
+     * @param nextHop The next hop on the route.
+     * @return True if the package has been packed.
+     */
+    bool _aggregate(const uint8_t *package, uint8_t nextHop);
+
+    /**
+     * Moves a frame into the send queue. A frame with a single package is sent as that package.
+     * @param index Index of the frame.
+     */
+    void _flushAggregate(uint8_t index);
+
+    /**
+     * @return True if this device is the registered hub, which has no parent.
+     */
+    bool _isHub() const {
+        return this->registered && this->id == 0;
+    }
+
+    /**
+     * @return The ID this device receives packages for. Devices without ID listen on the discovery channel.
+     */
+    uint8_t _address() const {
+        return this->registered || this->id != 0 ? this->id : DISCOVERY_CHANNEL;
+    }
+
+    /**
+     * Creates the route to a registering device and passes the request on to the hub.
+     * The hub assigns the ID and answers.
+     * @param registrationMsg The route creation message.
+     * @param sender Next hop towards the registering device.
+     */
+    void _createRoute(RegistrationMessage *registrationMsg, uint8_t sender);
+
+    /**
+     * Remembers the ID assigned to a registering device. If ASSIGNED_IDS IDs are remembered, the oldest is dropped.
+     * @param tempID Temporary ID of the device.
+     * @param newID The assigned ID.
+     * @param time The current time.
+     */
+    void _rememberAssignedID(uint32_t tempID, uint8_t newID, uint32_t time);
+
+    /**
+     * Drops the remembered assignment of an ID, because the registration is complete or the device has gone.
+     * @param deviceID The assigned ID.
+     */
+    void _forgetAssignedID(uint8_t deviceID);
+
+    /**
+     * @return Number of children that can still register with this device.
+     */
+    uint8_t _freeChildSlots() const;
+
+    /**
+     * Adds a device, that registered with this device as its parent, to the children and the routing table.
+     * @param childID ID of the child.
+     */
+    void _addChild(uint8_t childID);
+
+    /**
+     * Removes a device from the children, e.g. because it has been disconnected.
+     * @param childID ID of the child. Does nothing if it is no child.
+     */
+    void _removeChild(uint8_t childID);
+
+    /**
+     * Handles an expired timer of the timer wheel.
+     * @param timer The timer.
+     * @param time The current time.
+     */
+    void _timerExpired(WheelTimer *timer, uint32_t time);
+
+    /**
+     * Accepts the registration of a device, whose ID has not answered the registration ping in time.
+     * @param ping The registration ping.
+     */
+    void _registrationPingExpired(const RegistrationPing &ping);
+
+    /**
+     * Sends the periodic ping of the hub to the next device in its routing table and schedules the next one.
+     * @param time The current time.
+     */
+    void _sendLivenessPing(uint32_t time);
+
+    /**
+     * Counts a periodic ping, that has not been answered, and disconnects the device after LIVENESS_ATTEMPTS misses.
+     * @param deviceID ID of the device.
+     * @return True if the device has been disconnected.
+     */
+    bool _livenessPingExpired(uint8_t deviceID);
+
+    /**
+     * Sends a disconnect message down the path to the device and removes it from the routing table.
+     * @param deviceID ID of the device.
+     */
+    void _disconnect(uint8_t deviceID);
+
+    /**
+     * Sends the halves of the subtree's groups, that have changed since the last report, to the parent.
+     */
+    void _reportGroups();
+
+    /**
+     * Writes packages of the send queue to the data link layer. Packages to neighbours are sent over their reliable
+     * link. While its window is full, they are moved behind the other packages, so one neighbour cannot stall the
+     * others. If writing any other package fails, it is retried on the next call, until it failed MAX_WRITE_ATTEMPTS
+     * times. Direct packages are only written once.
+     * @param budget Maximum number of packages to be written.
+     */
+    void _drainTx(uint8_t budget);
+
+    /**
+     * Queues the next packages of the outgoing message, as long as the send queue has room for all next hops.
+     */
+    void _feedOutgoing();
+
+    /**
+     * Encodes the next package of the outgoing message.
+     * @param package Buffer of PACKAGE_SIZE bytes the package is written into.
+     * @return True if the send queue has room for the package for all of its next hops.
+     */
+    bool _outgoingFits(uint8_t *package) const;
+
+    /**
+     * Writes the pending acknowledgements and the packages the reliable links have to send again.
+     * A retransmission that cannot be written is taken back and tried first on the next call.
+     * @param budget Maximum number of packages to be sent again.
+     */
+    void _serviceLinks(uint8_t budget);
+
+    /**
+     * Checks, forwards and processes a received raw package.
+     * @param package The raw package.
+     * @param sender Sender of the package.
+     * @return True if a data message has been completed.
+     */
+    bool _receivePackage(const uint8_t *package, uint8_t sender);
+
+    /**
+     * Forwards and processes a received raw package, that has been checked by the link or unpacked from a frame.
+     * @param package The raw package.
+     * @param sender Sender of the package.
+     * @return True if a data message has been completed.
+     */
+    bool _handlePackage(const uint8_t *package, uint8_t sender);
+
+    /**
+     * Routes a raw package only by its receiver and group flag and queues it unchanged for the next hop(s).
+     * Used to forward packages without decoding and encoding them again.
+     * @param package Raw package to be sent.
+     * @param sender Sender of the package, if it has been received.
+     * @return True if the package has been queued for all next hops.
+     */
+    bool _forward(const uint8_t *package, uint8_t sender = 0);
+
+    /**
+     * Processes the received message. The message is decoded on the stack depending on its type.
+     * @param package Raw package of the received message.
      * @param sender Sender of the message.
-     * @return True if it is a data message.
+     * @return True if a data message has been completed.
      */
-    bool _processMessage(Message *message, uint8_t sender);
+    bool _processMessage(const uint8_t *package, uint8_t sender);
 
     /**
      * @return An ID for a new message.
@@ -153,11 +576,44 @@ class NetworkDevice {
      * @param group Group to be checked.
      * @return True if this device is in the given group.
      */
-    bool isInGroup(uint8_t group);
+    bool isInGroup(uint8_t group) const {
+        return this->groups.contains(group);
+    }
 
     /**
-     * Registers the device with the discovered device at the lowest hierarchy level.
-     * Discovery pointer must not be null.
+     * Starts a new discovery of the devices in range.
+     */
+    void _startDiscovery();
+
+    /**
+     * Sends up to DISCOVERY_BURST requests of the ongoing discovery and registers or benchmarks when it is finished.
+     * @param time The current time.
+     */
+    void _updateDiscovery(uint32_t time);
+
+    /**
+     * Answers a discovery on the discovery channel, if this device can still become a parent.
+     * @param requester Temporary ID of the discovering device, so only it measures the round trip time with the echo.
+     * @param echo Send time of the request, corrected by the back-off, so the discovering device can measure
+     * the round trip time.
+     */
+    void _answerDiscovery(uint32_t requester, uint32_t echo);
+
+    /**
+     * Draws a pseudo random number, e.g. for back-offs. The generator is seeded with the ID and the time.
+     * @return The number.
+     */
+    uint32_t _random();
+
+    /**
+     * Sends a registration request to the candidate with the lowest cost, that has not been tried yet.
+     * @return True, if a candidate has been left, false if not.
+     */
+    bool _registerWithNextCandidate();
+
+    /**
+     * Ranks the discovered devices by the cost of their depth, link quality and free child slots
+     * and registers the device with the best one. Discovery pointer must not be null.
      * @return True, if a parent has been found, false if not.
      */
     bool registerDevice();
@@ -170,79 +626,150 @@ class NetworkDevice {
 
 protected:
     /**
-     * This method passes the message to the data link layer.
-     * @param msg Message to be sent.
+     * Makes this device the hub: it is registered at the hierarchy level 0 and does not discover.
+     */
+    void _initHub();
+
+    /**
+     * Sets the time in which the hub pings each device once. A device that does not answer LIVENESS_ATTEMPTS pings
+     * in a row is disconnected. Each answer is awaited until the next ping, but at least for the timeout.
+     * @param interval The time in milliseconds. 0 disables the pings.
+     */
+    void _setLivenessInterval(uint32_t interval);
+
+    /**
+     * This method passes a raw package to the data link layer. By default it is written to the transport.
+     * @param package Raw package of PACKAGE_SIZE bytes to be sent. Only valid during the call.
      * @param nextHop The next hop on the route.
-     * @return True if the message has been sent successfully.
+     * @return True if the package has been sent successfully.
      */
-    virtual bool _write(Message *msg, uint8_t nextHop);
+    virtual bool _write(const uint8_t *package, uint8_t nextHop);
 
     /**
-     * This method gets the message from the data link layer. Creates the message object on the heap
-     * and writes the address of it into the pointer given.
-     * @param msg Message received.
+     * This method gets the next raw package from the data link layer. By default it is read from the transport.
+     * @param package Buffer of PACKAGE_SIZE bytes the received package is written into.
      * @return The sender of the message.
      */
-    virtual uint8_t _read(Message **msg);
+    virtual uint8_t _read(uint8_t *package);
 
     /**
-     * This method checks at the data link layer if there is a new message.
+     * This method checks at the data link layer if there is a new message. By default the transport is checked.
      * @return True if a new message is available.
      */
     virtual bool _messageAvailable();
 
     /**
-     * This method returns the current time.
+     * This method returns the current time. By default it is the time of the transport.
      * @return The current time.
      */
     virtual uint32_t _getTime();
 
     /**
-     * This method prints an error caused by the given message on a terminal.
+     * This method prints an error caused by the given message on a terminal. By default errors are ignored.
      * @param errCode Error code.
      * @param msg Erroneous message.
      */
     virtual void _printError(uint8_t errCode, const uint8_t *msg);
 
 public:
-    virtual ~NetworkDevice() = default;
+    virtual ~NetworkDevice() {
+        delete[] this->lastData;
+        delete this->outgoing;
+        delete this->discovery;
+        delete this->benchmark_wrapper;
+    }
+
+    NetworkDevice(const NetworkDevice&) = delete;
+    NetworkDevice& operator=(const NetworkDevice&) = delete;
 
     /**
      * Initializes the data needed for a connection with the network.
      * Has to wait for a response before being able to send a message.
      * @param id ID of this device. If 0 it gets assigned an ID by the hub. If 1 this device is the hub.
      * @param discoveryTimeout Timeout for discoveries of other devices.
+     * @param reassemblyMemory Maximum memory in bytes for reassembling received data messages, at least one message
+     * is reassembled at a time. Devices that only receive short messages can save most of it.
      */
-    explicit NetworkDevice(const uint8_t id, uint16_t discoveryTimeout = 1000) : id(id), parent(0), nextID(0),
+    explicit NetworkDevice(const uint8_t id, uint16_t discoveryTimeout = 1000,
+        size_t reassemblyMemory = REASSEMBLY_MEMORY) : id(id), parent(0), nextID(0),
         registered(false), hierarchyLevel(0), benchmark_wrapper(nullptr),
-        lastDataSize(0), tempID(0) {
+        lastDataSize(0), tempID(0), messageBuilder(MessageBuilder::slotsForMemory(reassemblyMemory)),
+        timeout(discoveryTimeout) {
         this->children[0] = this->children[1] = this->children[2] = this->children[3] = 0;
-        this->discovery = new Discovery(discoveryTimeout, id);
+        this->discovery = new Discovery(discoveryTimeout, id, this->broadcastDiscovery);
         this->lastData = new uint8_t[0];
-        this->groups.push_back(0);
+        this->groups.add(0);
+    }
+
+    /**
+     * Sets the data link layer used by the default implementations of the data link methods.
+     * @param transport The transport. Must outlive this device.
+     */
+    void setTransport(Transport *transport) {
+        this->transport = transport;
+        if (transport != nullptr) transport->setAddress(this->_address());
     }
 
     /**
      * Checks if a new message is available and handles all background stuff of the network device.
+     * Reads, processes and writes up to the update budget of packages each. Processing stops after a
+     * data message has been completed, so it can be fetched by receive() before the next update.
      * @return True if a new message is available.
      */
     bool update();
 
+    /**
+     * Sets the maximum number of packages read, processed and written in each update.
+     * @param budget The budget. At least 1.
+     */
+    void setUpdateBudget(uint8_t budget) {
+        this->updateBudget = budget > 0 ? budget : 1;
+    }
+
+    /**
+     * Chooses how devices in range are discovered. Broadcasts need a data link layer that delivers packages
+     * to the discovery channel to all neighbours. An ongoing discovery is started again in the new mode.
+     * @param broadcast True to broadcast the requests, false to ping each ID.
+     */
+    void setBroadcastDiscovery(bool broadcast) {
+        this->broadcastDiscovery = broadcast;
+        if (this->discovery != nullptr) this->_startDiscovery();
+    }
+
+    /**
+     * Sets how many benchmark pings may be in flight at the same time. Takes effect with the next benchmark.
+     * @param window The number of pings, at most BENCHMARK_MAX_WINDOW.
+     */
+    void setBenchmarkWindow(uint8_t window) {
+        this->benchmarkWindow = window;
+    }
+
+    /**
+     * Sets the time small messages wait for other messages to the same neighbour, so they are sent in one frame.
+     * Pending frames are sent with their current window.
+     * @param window The window in milliseconds. 0 disables the aggregation.
+     */
+    void setAggregationWindow(uint16_t window) {
+        this->aggregationWindow = window;
+    }
+
     /**
      * Sends a data message.
      * @param receiver ID of the message's receiver. 0 is broadcast.
-     * @param data Data of the message.
-     * @param dataSize Size of the data.
-     * @return True if the message has been sent successfully.
+     * @param data Data of the message. It is copied, so it can be freed right away.
+     * @param dataSize Size of the data, 1 to MAX_DATA_SIZE bytes.
+     * @return True if the message is sent. False if the size is invalid or the previous message is still being
+     * queued, then nothing is sent.
      */
     bool send(uint8_t receiver, uint8_t* data, uint16_t dataSize);
 
     /**
      * Sends a data message.
      * @param group ID of the message's receiving group.
-     * @param data Data of the message.
-     * @param dataSize Size of the data.
-     * @return True if the message has been sent successfully.
+     * @param data Data of the message. It is copied, so it can be freed right away.
+     * @param dataSize Size of the data, 1 to MAX_DATA_SIZE bytes.
+     * @return True if the message is sent. False if the size is invalid or the previous message is still being
+     * queued, then nothing is sent.
      */
     bool sendToGroup(uint8_t group, uint8_t* data, uint16_t dataSize);
 
@@ -267,6 +794,149 @@ public:
      */
     uint32_t checkPing(uint8_t pingID);
 
+    /**
+     * Looks for a better parent by discovering the devices in range and benchmarking them.
+     * Only the cached neighbours are asked, unless none of them answers or all of them are stale.
+     * @return False if a discovery or benchmark is ongoing or this device is not registered or is the hub.
+     */
+    bool rediscover();
+
+    /**
+     * @return Number of received packages dropped, because their checksum was wrong.
+     */
+    uint32_t getCorruptPackages() const {
+        return this->corruptPackages;
+    }
+
+    /**
+     * @return The acknowledgement state of the links to all neighbours, e.g. for its statistics.
+     */
+    const ReliableLinks& getReliableLinks() const {
+        return this->reliableLinks;
+    }
+
+    /**
+     * @return Number of packages dropped, because the send queue was full or writing them failed.
+     */
+    uint32_t getDroppedPackages() const {
+        return this->txQueue.getDroppedCount() + this->failedWrites;
+    }
+
+    /**
+     * @return Number of incomplete data messages dropped, because a package has not arrived in time.
+     */
+    uint32_t getExpiredMessages() const {
+        return this->messageBuilder.getExpiredCount();
+    }
+
+    /**
+     * @return Number of incomplete data messages dropped, because all reassembly slots were in use.
+     */
+    uint32_t getEvictedMessages() const {
+        return this->messageBuilder.getEvictedCount();
+    }
+
+    /**
+     * @return ID of this device. 0 as long as a device without static ID is not registered.
+     */
+    uint8_t getID() const {
+        return this->id;
+    }
+
+    /**
+     * @return ID of this device's parent.
+     */
+    uint8_t getParent() const {
+        return this->parent;
+    }
+
+    /**
+     * @return True, if this device has been registered in the network.
+     */
+    bool isRegistered() const {
+        return this->registered;
+    }
+
+    /**
+     * @return Level of the hierarchy this device is at. Hub is zero.
+     */
+    uint8_t getHierarchyLevel() const {
+        return this->hierarchyLevel;
+    }
+
+    /**
+     * Checks if the device only waits for packages, so updates can be skipped until the next package arrives.
+     * @return True if no discovery, registration, benchmark or transmission is in progress.
+     */
+    bool isIdle() const;
+
+    /**
+     * Checks if no data is waiting to be sent or acknowledged. Unlike isIdle, pings and their responses are not
+     * counted, so a network whose hub pings the devices periodically becomes quiet as well.
+     * @return True if no discovery, registration or benchmark is in progress and only pings are queued or in flight.
+     */
+    bool isQuiet() const;
+
+    /**
+     * Calculates when the device has to be updated next: the next protocol timer, retransmission, acknowledgement,
+     * coalescing window, discovery or benchmark step. So a simulation or an idle device can sleep until then or
+     * until the next package arrives.
+     * @param delay The time in milliseconds until then is written into this, 0 if the device has work right now.
+     * @return False if nothing is scheduled.
+     */
+    bool nextTimer(uint32_t *delay);
+
+    /**
+     * @return IDs of the groups this device is part of.
+     */
+    const GroupSet& getGroups() const {
+        return this->groups;
+    }
+
+    /**
+     * Replaces the groups this device is part of. Every device stays in group 0.
+     * @param groups IDs of the groups.
+     */
+    void setGroups(const GroupSet &groups) {
+        this->groups = groups;
+        this->groups.add(0);
+        this->_reportGroups();
+    }
+
+    /**
+     * @return IDs of the groups this device or any of its descendants is part of.
+     */
+    GroupSet getSubtreeGroups() const;
+
+    /**
+     * @return The next hops to the descendant nodes.
+     */
+    const RoutingTable& getRoutingTable() const {
+        return this->routingTable;
+    }
+
+    /**
+     * @return The devices in range heard in discoveries.
+     */
+    const NeighborCache& getNeighbors() const {
+        return this->neighbors;
+    }
+
+    /**
+     * @return The last benchmark or nullptr, e.g. for the estimated quality of the connections.
+     * It is kept until the next benchmark starts.
+     */
+    const ConnectionBenchmarkWrapper* getBenchmark() const {
+        return this->benchmark_wrapper;
+    }
+
+    /**
+     * @return The routes of descendant nodes that only have a temporary ID, e.g. for its occupancy statistics.
+     */
+    const TempRoutingTable& getTempRoutingTable() const {
+        return this->tempRoutingTable;
+    }
+
 };
 
 
@@ -3,14 +3,30 @@
 #include "networkDevice.h"
 
 
-class NetworkHub : NetworkDevice {
+class NetworkHub : public NetworkDevice {
     public:
 
     /**
      * Initializes the hub of the network.
      * @param pingTimeout Timeout for ping of other devices while registration of a new device.
+     * @param pingTime Time in milliseconds in which the hub pings each device once to detect disconnected devices.
+     * 0 disables the pings.
+     * @param reassemblyMemory Maximum memory in bytes for reassembling received data messages.
      */
-    explicit NetworkHub(uint16_t pingTimeout) : NetworkDevice(0, pingTimeout) {}
+    explicit NetworkHub(uint16_t pingTimeout, uint32_t pingTime = 0, size_t reassemblyMemory = REASSEMBLY_MEMORY)
+        : NetworkDevice(0, pingTimeout, reassemblyMemory) {
+        this->_initHub();
+        this->_setLivenessInterval(pingTime);
+    }
+
+    /**
+     * Sets the time in which the hub pings each device once. A device that does not answer LIVENESS_ATTEMPTS pings
+     * in a row is disconnected. Each answer is awaited until the next ping, but at least for the timeout.
+     * @param pingTime The time in milliseconds. 0 disables the pings.
+     */
+    void setPingTime(uint32_t pingTime) {
+        this->_setLivenessInterval(pingTime);
+    }
 };
 
 
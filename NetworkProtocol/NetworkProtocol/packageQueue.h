@@ -0,0 +1,160 @@
+#ifndef NETWORKPROTOCOL_PACKAGEQUEUE_H
+#define NETWORKPROTOCOL_PACKAGEQUEUE_H
+#include <cstdint>
+#include <cstring>
+
+#include "Messages/messageObjects.h"
+
+/**
+ * Raw package waiting in a queue.
+ */
+typedef struct QueuedPackage {
+    /**
+     * The raw package.
+     */
+    uint8_t package[PACKAGE_SIZE];
+
+    /**
+     * Neighbour the package has been received from or is sent to.
+     */
+    uint8_t link;
+
+    /**
+     * Number of times writing the package has failed.
+     */
+    uint8_t attempts;
+
+    /**
+     * True if the package is sent over the reliable link to the neighbour.
+     */
+    bool reliable;
+} QueuedPackage;
+
+/**
+ * Bounded ring buffer of raw packages. The packages are stored in place, so the queue never allocates memory.
+ * @tparam Capacity Maximum number of packages. Must be a power of two.
+ */
+template<uint8_t Capacity>
+class PackageQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(Capacity <= 128, "Capacity must be distinguishable from an empty queue with one byte counters");
+
+    /**
+     * Storage of the packages.
+     */
+    QueuedPackage packages[Capacity];
+
+    /**
+     * Number of packages removed so far. Index of the first package modulo the capacity.
+     */
+    uint8_t head = 0;
+
+    /**
+     * Number of packages added so far. Index behind the last package modulo the capacity.
+     */
+    uint8_t tail = 0;
+
+    /**
+     * Number of packages, that could not be added, because the queue was full.
+     */
+    uint32_t droppedCount = 0;
+
+public:
+    /**
+     * @return Number of packages in the queue.
+     */
+    uint8_t size() const {
+        return static_cast<uint8_t>(this->tail - this->head);
+    }
+
+    bool empty() const {
+        return this->head == this->tail;
+    }
+
+    bool full() const {
+        return this->size() == Capacity;
+    }
+
+    /**
+     * Reserves the slot behind the last package, so a package can be written into the queue directly.
+     * The package is only added by commit().
+     * @return The free slot or nullptr if the queue is full.
+     */
+    QueuedPackage* reserve() {
+        if (this->full()) return nullptr;
+        return &this->packages[this->tail & (Capacity - 1)];
+    }
+
+    /**
+     * Adds the package in the slot returned by reserve().
+     */
+    void commit() {
+        this->tail++;
+    }
+
+    /**
+     * Copies a package to the end of the queue.
+     * @param package Raw package of PACKAGE_SIZE bytes.
+     * @param link Neighbour the package has been received from or is sent to.
+     * @param reliable True if the package is sent over the reliable link to the neighbour.
+     * @return False if the queue is full, then the package is dropped.
+     */
+    bool push(const uint8_t *package, uint8_t link, bool reliable = true) {
+        QueuedPackage *slot = this->reserve();
+        if (slot == nullptr) {
+            this->droppedCount++;
+            return false;
+        }
+        memcpy(slot->package, package, PACKAGE_SIZE);
+        slot->link = link;
+        slot->attempts = 0;
+        slot->reliable = reliable;
+        this->commit();
+        return true;
+    }
+
+    /**
+     * @return The first package. The queue must not be empty.
+     */
+    QueuedPackage& front() {
+        return this->packages[this->head & (Capacity - 1)];
+    }
+
+    /**
+     * @param index Position of the package in the queue, 0 is the first one. Must be less than size().
+     * @return The package at the position.
+     */
+    const QueuedPackage& at(uint8_t index) const {
+        return this->packages[(this->head + index) & (Capacity - 1)];
+    }
+
+    /**
+     * Removes the first package. The queue must not be empty.
+     */
+    void pop() {
+        this->head++;
+    }
+
+    /**
+     * Moves the first package to the end of the queue, so the packages behind it are taken first.
+     * The queue must not be empty.
+     */
+    void rotate() {
+        QueuedPackage &first = this->front();
+        QueuedPackage &last = this->packages[this->tail & (Capacity - 1)];
+        // in a full queue the slot behind the last package is the slot of the first one
+        if (&first != &last) last = first;
+        this->head++;
+        this->tail++;
+    }
+
+    /**
+     * @return Number of packages, that could not be added, because the queue was full.
+     */
+    uint32_t getDroppedCount() const {
+        return this->droppedCount;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_PACKAGEQUEUE_H
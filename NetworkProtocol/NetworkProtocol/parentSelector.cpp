@@ -0,0 +1,40 @@
+#include "parentSelector.h"
+
+uint32_t ParentSelector::cost(const ParentCandidate &candidate) {
+    uint32_t rtt = candidate.rtt == UINT16_MAX ? PARENT_UNKNOWN_RTT : candidate.rtt;
+    uint32_t delivery = candidate.deliveryRatio > 0 ? candidate.deliveryRatio : 1;
+    uint32_t link = rtt * 100 / delivery;
+    uint32_t depth = (static_cast<uint32_t>(candidate.level) + 1) * PARENT_HOP_COST;
+    uint8_t takenSlots = candidate.freeSlots < PARENT_CHILD_SLOTS ? PARENT_CHILD_SLOTS - candidate.freeSlots : 0;
+    return link + depth + takenSlots * PARENT_SLOT_COST;
+}
+
+bool ParentSelector::acceptable(const ParentCandidate &candidate) {
+    if (candidate.deliveryRatio < PARENT_MIN_DELIVERY) return false;
+    return candidate.rtt == UINT16_MAX || candidate.rtt <= PARENT_MAX_RTT;
+}
+
+void ParentSelector::add(uint8_t id, uint8_t level, uint8_t freeSlots, uint16_t rtt, uint8_t deliveryRatio) {
+    ParentCandidate candidate = {id, level, freeSlots, rtt, deliveryRatio, 0};
+    candidate.cost = cost(candidate);
+    this->candidates.push_back(candidate);
+}
+
+bool ParentSelector::next(ParentCandidate *candidate) {
+    if (this->candidates.empty()) return false;
+
+    // acceptable candidates first, the one with the lowest cost and then the lowest level among them
+    auto best = this->candidates.begin();
+    for (auto it = this->candidates.begin() + 1; it != this->candidates.end(); ++it) {
+        bool itAcceptable = acceptable(*it);
+        bool bestAcceptable = acceptable(*best);
+        if (itAcceptable != bestAcceptable) {
+            if (itAcceptable) best = it;
+            continue;
+        }
+        if (it->cost < best->cost || (it->cost == best->cost && it->level < best->level)) best = it;
+    }
+    *candidate = *best;
+    this->candidates.erase(best);
+    return true;
+}
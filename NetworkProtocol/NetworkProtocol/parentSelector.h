@@ -0,0 +1,113 @@
+#ifndef NETWORKPROTOCOL_PARENTSELECTOR_H
+#define NETWORKPROTOCOL_PARENTSELECTOR_H
+#include <cstdint>
+#include <vector>
+
+#define PARENT_HOP_COST 10
+#define PARENT_SLOT_COST 2
+#define PARENT_CHILD_SLOTS 4
+#define PARENT_UNKNOWN_RTT 10
+#define PARENT_MAX_RTT 200
+#define PARENT_MIN_DELIVERY 70
+
+/**
+ * A device that can become the parent of this device.
+ */
+typedef struct ParentCandidate {
+    /**
+     * ID of the device.
+     */
+    uint8_t id;
+
+    /**
+     * Level of the device in the hierarchy.
+     */
+    uint8_t level;
+
+    /**
+     * Number of free child slots of the device.
+     */
+    uint8_t freeSlots;
+
+    /**
+     * Round trip time to the device in milliseconds. UINT16_MAX if it is not known.
+     */
+    uint16_t rtt;
+
+    /**
+     * Percentage of the pings to the device that have been answered. 100 if it is not known.
+     */
+    uint8_t deliveryRatio;
+
+    /**
+     * Cost of the device as parent, lower is better.
+     */
+    uint32_t cost;
+} ParentCandidate;
+
+/**
+ * Ranks the devices that answered a discovery as parents. The cost of a candidate estimates the time a message needs
+ * to the hub over it in milliseconds:
+ * - the round trip time of the link, PARENT_UNKNOWN_RTT if it has not been measured, divided by the delivery ratio,
+ *   since lost packages are repeated,
+ * - PARENT_HOP_COST for each hop from the candidate to the hub,
+ * - PARENT_SLOT_COST for each taken child slot of the candidate, so the tree grows evenly.
+ * Candidates with a round trip time above PARENT_MAX_RTT or a delivery ratio below PARENT_MIN_DELIVERY only are
+ * chosen after all others have been tried.
+ */
+class ParentSelector {
+
+    /**
+     * Candidates that have not been tried yet.
+     */
+    std::vector<ParentCandidate> candidates;
+
+public:
+    /**
+     * Calculates the cost of a candidate.
+     * @param candidate The candidate. Its cost is ignored.
+     * @return The cost, lower is better.
+     */
+    static uint32_t cost(const ParentCandidate &candidate);
+
+    /**
+     * @param candidate A candidate.
+     * @return True if the link to the candidate meets the quality thresholds.
+     */
+    static bool acceptable(const ParentCandidate &candidate);
+
+    /**
+     * Adds a candidate and calculates its cost.
+     * @param id ID of the device.
+     * @param level Level of the device in the hierarchy.
+     * @param freeSlots Number of free child slots of the device.
+     * @param rtt Round trip time to the device in milliseconds, UINT16_MAX if it is not known.
+     * @param deliveryRatio Percentage of the answered pings to the device, 100 if it is not known.
+     */
+    void add(uint8_t id, uint8_t level, uint8_t freeSlots, uint16_t rtt, uint8_t deliveryRatio);
+
+    /**
+     * Takes the candidate with the lowest cost, that meets the quality thresholds. If there is none,
+     * the candidate with the lowest cost is taken anyway.
+     * @param candidate The candidate is written into this.
+     * @return False if all candidates have been tried.
+     */
+    bool next(ParentCandidate *candidate);
+
+    /**
+     * Removes all candidates.
+     */
+    void clear() {
+        this->candidates.clear();
+    }
+
+    /**
+     * @return Number of candidates that have not been tried yet.
+     */
+    uint8_t size() const {
+        return this->candidates.size();
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_PARENTSELECTOR_H
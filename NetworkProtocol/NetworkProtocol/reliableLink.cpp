@@ -0,0 +1,288 @@
+#include "reliableLink.h"
+
+#include <cstring>
+
+#include "timer.h"
+
+void ReliableLink::_measure(uint32_t rtt) {
+    // Jacobson/Karels: smoothed round trip time with gain 1/8 and deviation with gain 1/4
+    if (this->smoothedRtt == 0) {
+        this->smoothedRtt = rtt > 0 ? rtt : 1;
+        this->rttVariance = rtt / 2;
+    } else {
+        uint32_t deviation = rtt > this->smoothedRtt ? rtt - this->smoothedRtt : this->smoothedRtt - rtt;
+        this->rttVariance = (3 * this->rttVariance + deviation) / 4;
+        this->smoothedRtt = (7 * this->smoothedRtt + rtt) / 8;
+    }
+
+    this->rto = this->smoothedRtt + 4 * this->rttVariance;
+    if (this->rto < ARQ_MIN_RTO) this->rto = ARQ_MIN_RTO;
+    if (this->rto > ARQ_MAX_RTO) this->rto = ARQ_MAX_RTO;
+}
+
+void ReliableLink::_advance() {
+    while (this->oldestUnacked != this->nextSequence && !this->window[this->oldestUnacked % ARQ_WINDOW].used) {
+        this->oldestUnacked = (this->oldestUnacked + 1) & SEQUENCE_MASK;
+    }
+}
+
+const uint8_t* ReliableLink::send(const uint8_t* package, uint32_t time) {
+    UnackedPackage &slot = this->window[this->nextSequence % ARQ_WINDOW];
+    slot.used = true;
+    slot.retransmitted = false;
+    slot.retransmitNow = false;
+    slot.attempts = 1;
+    slot.sentTime = time;
+    memcpy(slot.package, package, PACKAGE_SIZE);
+    Message::setTransmission(slot.package, RELIABLE_FLAG | this->nextSequence);
+
+    this->nextSequence = (this->nextSequence + 1) & SEQUENCE_MASK;
+    return slot.package;
+}
+
+void ReliableLink::unsend(const uint8_t* package) {
+    for (UnackedPackage &slot : this->window) {
+        if (!slot.used || slot.package != package) continue;
+        if (slot.attempts > 1) this->retransmissions--;
+        if (slot.attempts > 0) slot.attempts--;
+        slot.retransmitNow = true;
+        return;
+    }
+}
+
+void ReliableLink::acknowledge(uint8_t cumulativeAck, uint32_t selectiveAcks, uint32_t time) {
+    uint8_t inFlight = this->inFlight();
+    // ignore the cumulative part if it does not lie within the packages in flight, e.g. an outdated acknowledgement
+    bool cumulativeValid = ((cumulativeAck - this->oldestUnacked) & SEQUENCE_MASK) <= inFlight;
+
+    // position of the newest package acknowledged, packages before it that are still missing have been lost
+    int16_t newestAcked = -1;
+    uint32_t newestAckedSent = 0;
+
+    for (uint8_t i = 0; i < inFlight; i++) {
+        uint8_t sequence = (this->oldestUnacked + i) & SEQUENCE_MASK;
+        UnackedPackage &slot = this->window[sequence % ARQ_WINDOW];
+        if (!slot.used) continue;
+
+        bool acked = false;
+        if (cumulativeValid && ((cumulativeAck - this->oldestUnacked) & SEQUENCE_MASK) > i) {
+            acked = true;
+        } else {
+            uint8_t bit = (sequence - cumulativeAck - 1) & SEQUENCE_MASK;
+            acked = bit < ARQ_RECEIVE_WINDOW && (selectiveAcks >> bit) & 1;
+            if (acked) {
+                newestAcked = i;
+                newestAckedSent = slot.sentTime;
+            }
+        }
+        if (!acked) continue;
+
+        // Karn's algorithm: the acknowledgement of a retransmitted package cannot be assigned to one of its sendings
+        if (!slot.retransmitted) this->_measure(Timer::elapsed(slot.sentTime, time));
+        slot.used = false;
+    }
+
+    // selective repeat of the holes in front of the newest acknowledged package, that have been sent before it,
+    // so a lost retransmission is repeated as well instead of waiting for the backed off timeout
+    for (int16_t i = 0; i < newestAcked; i++) {
+        UnackedPackage &slot = this->window[((this->oldestUnacked + i) & SEQUENCE_MASK) % ARQ_WINDOW];
+        if (slot.used && static_cast<int32_t>(newestAckedSent - slot.sentTime) >= 0) slot.retransmitNow = true;
+    }
+
+    this->_advance();
+}
+
+const uint8_t* ReliableLink::pollRetransmission(uint32_t time) {
+    uint8_t inFlight = this->inFlight();
+    for (uint8_t i = 0; i < inFlight; i++) {
+        UnackedPackage &slot = this->window[((this->oldestUnacked + i) & SEQUENCE_MASK) % ARQ_WINDOW];
+        if (!slot.used) continue;
+
+        bool timedOut = Timer::elapsed(slot.sentTime, time) > this->rto;
+        if (!timedOut && !slot.retransmitNow) continue;
+
+        if (slot.attempts >= ARQ_MAX_ATTEMPTS) {
+            // give up on the package, the message it belongs to expires at the receiver
+            slot.used = false;
+            this->failures++;
+            continue;
+        }
+
+        // back off exponentially once per timeout of the oldest package, since the link is congested
+        // or the timeout is too short
+        if (timedOut && i == 0) {
+            this->rto = this->rto * 2 > ARQ_MAX_RTO ? ARQ_MAX_RTO : this->rto * 2;
+        }
+        slot.attempts++;
+        slot.retransmitted = true;
+        slot.retransmitNow = false;
+        slot.sentTime = time;
+        this->retransmissions++;
+        return slot.package;
+    }
+
+    this->_advance();
+    return nullptr;
+}
+
+bool ReliableLink::nextRetransmission(uint32_t time, uint32_t* delay) const {
+    bool scheduled = this->ackPending;
+    *delay = 0;
+    if (scheduled) return true;
+
+    uint8_t inFlight = this->inFlight();
+    for (uint8_t i = 0; i < inFlight; i++) {
+        const UnackedPackage &slot = this->window[((this->oldestUnacked + i) & SEQUENCE_MASK) % ARQ_WINDOW];
+        if (!slot.used) continue;
+        uint32_t elapsed = Timer::elapsed(slot.sentTime, time);
+        uint32_t wait = slot.retransmitNow || elapsed > this->rto ? 0 : this->rto + 1 - elapsed;
+        if (!scheduled || wait < *delay) *delay = wait;
+        scheduled = true;
+    }
+    return scheduled;
+}
+
+bool ReliableLink::anyInFlight(bool (*predicate)(const uint8_t*)) const {
+    uint8_t inFlight = this->inFlight();
+    for (uint8_t i = 0; i < inFlight; i++) {
+        const UnackedPackage &slot = this->window[((this->oldestUnacked + i) & SEQUENCE_MASK) % ARQ_WINDOW];
+        if (slot.used && predicate(slot.package)) return true;
+    }
+    return false;
+}
+
+bool ReliableLink::receive(uint8_t sequence) {
+    this->ackPending = true;
+
+    if (!this->synchronized) {
+        this->synchronized = true;
+        this->expectedSequence = sequence;
+        this->receivedAhead = 0;
+    }
+
+    uint8_t distance = (sequence - this->expectedSequence) & SEQUENCE_MASK;
+    if (distance > ARQ_RECEIVE_WINDOW) {
+        // packages shortly before the expected one have been received already
+        if (distance >= SEQUENCE_MASK + 1 - ARQ_RECEIVE_WINDOW) return false;
+
+        // otherwise the neighbour has lost the state of the link, so start again at its sequence number
+        this->expectedSequence = sequence;
+        this->receivedAhead = 0;
+        distance = 0;
+    }
+
+    if (distance == 0) {
+        // move behind all packages received in a row
+        this->expectedSequence = (this->expectedSequence + 1) & SEQUENCE_MASK;
+        while (this->receivedAhead & 1) {
+            this->receivedAhead >>= 1;
+            this->expectedSequence = (this->expectedSequence + 1) & SEQUENCE_MASK;
+        }
+        this->receivedAhead >>= 1;
+        return true;
+    }
+
+    uint32_t bit = 1UL << (distance - 1);
+    if (this->receivedAhead & bit) return false;
+    this->receivedAhead |= bit;
+    return true;
+}
+
+bool ReliableLink::takeAck(uint8_t* cumulativeAck, uint32_t* selectiveAcks) {
+    if (!this->ackPending) return false;
+    this->ackPending = false;
+    *cumulativeAck = this->expectedSequence;
+    *selectiveAcks = this->receivedAhead;
+    return true;
+}
+
+ReliableLink* ReliableLinks::find(uint8_t neighbour) {
+    for (LinkEntry &entry : this->entries) {
+        if (entry.used && entry.neighbour == neighbour) return &entry.link;
+    }
+    return nullptr;
+}
+
+ReliableLink* ReliableLinks::get(uint8_t neighbour, uint32_t time) {
+    LinkEntry *replaced = &this->entries[0];
+    for (LinkEntry &entry : this->entries) {
+        if (entry.used && entry.neighbour == neighbour) {
+            entry.lastUsed = time;
+            return &entry.link;
+        }
+        // prefer a free entry, otherwise the least recently used one
+        if (!replaced->used) continue;
+        if (!entry.used || Timer::elapsed(entry.lastUsed, time) > Timer::elapsed(replaced->lastUsed, time)) {
+            replaced = &entry;
+        }
+    }
+
+    replaced->used = true;
+    replaced->neighbour = neighbour;
+    replaced->lastUsed = time;
+    replaced->link = ReliableLink();
+    return &replaced->link;
+}
+
+const uint8_t* ReliableLinks::pollRetransmission(uint32_t time, uint8_t* neighbour) {
+    for (LinkEntry &entry : this->entries) {
+        if (!entry.used) continue;
+        const uint8_t *package = entry.link.pollRetransmission(time);
+        if (package != nullptr) {
+            *neighbour = entry.neighbour;
+            return package;
+        }
+    }
+    return nullptr;
+}
+
+bool ReliableLinks::nextRetransmission(uint32_t time, uint32_t* delay) const {
+    bool scheduled = false;
+    uint32_t linkDelay;
+    for (const LinkEntry &entry : this->entries) {
+        if (!entry.used || !entry.link.nextRetransmission(time, &linkDelay)) continue;
+        if (!scheduled || linkDelay < *delay) *delay = linkDelay;
+        scheduled = true;
+    }
+    return scheduled;
+}
+
+bool ReliableLinks::anyInFlight(bool (*predicate)(const uint8_t*)) const {
+    for (const LinkEntry &entry : this->entries) {
+        if (entry.used && entry.link.anyInFlight(predicate)) return true;
+    }
+    return false;
+}
+
+bool ReliableLinks::takeAck(uint8_t* neighbour, uint8_t* cumulativeAck, uint32_t* selectiveAcks) {
+    for (LinkEntry &entry : this->entries) {
+        if (entry.used && entry.link.takeAck(cumulativeAck, selectiveAcks)) {
+            *neighbour = entry.neighbour;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReliableLinks::idle() const {
+    for (const LinkEntry &entry : this->entries) {
+        if (entry.used && !entry.link.idle()) return false;
+    }
+    return true;
+}
+
+uint32_t ReliableLinks::getRetransmissions() const {
+    uint32_t retransmissions = 0;
+    for (const LinkEntry &entry : this->entries) {
+        retransmissions += entry.link.retransmissions;
+    }
+    return retransmissions;
+}
+
+uint32_t ReliableLinks::getFailures() const {
+    uint32_t failures = 0;
+    for (const LinkEntry &entry : this->entries) {
+        failures += entry.link.failures;
+    }
+    return failures;
+}
@@ -0,0 +1,332 @@
+#ifndef NETWORKPROTOCOL_RELIABLELINK_H
+#define NETWORKPROTOCOL_RELIABLELINK_H
+#include <cstdint>
+
+#include "Messages/messageObjects.h"
+
+#define ARQ_WINDOW 8
+#define ARQ_RECEIVE_WINDOW 32
+#define ARQ_LINKS 6
+#define ARQ_INITIAL_RTO 250
+#define ARQ_MIN_RTO 20
+#define ARQ_MAX_RTO 4000
+#define ARQ_MAX_ATTEMPTS 8
+
+static_assert(ARQ_WINDOW <= ARQ_RECEIVE_WINDOW, "The send window must fit into the selective acknowledgements");
+static_assert(2 * ARQ_RECEIVE_WINDOW <= SEQUENCE_MASK + 1, "Old and new sequence numbers must be distinguishable");
+
+/**
+ * Package that has been sent over a link, but not acknowledged yet.
+ */
+typedef struct UnackedPackage {
+    /**
+     * True if this slot holds a package.
+     */
+    bool used;
+
+    /**
+     * True if the package has been sent more than once. Its acknowledgement is not used to measure the round trip time.
+     */
+    bool retransmitted;
+
+    /**
+     * True if a later package has been acknowledged, so the package is sent again without waiting for the timeout.
+     */
+    bool retransmitNow;
+
+    /**
+     * Number of times the package has been sent.
+     */
+    uint8_t attempts;
+
+    /**
+     * Time the package has been sent the last time.
+     */
+    uint32_t sentTime;
+
+    /**
+     * The raw package with its transmission ID.
+     */
+    uint8_t package[PACKAGE_SIZE];
+} UnackedPackage;
+
+/**
+ * State of the hop-by-hop acknowledgements between this device and one neighbour.
+ * The sender keeps up to ARQ_WINDOW packages in flight and sends them again if they are not acknowledged
+ * within the retransmission timeout, which adapts to the measured round trip times.
+ * The receiver acknowledges the packages cumulatively and selectively, so only lost packages are sent again.
+ */
+class ReliableLink {
+
+    /**
+     * Sequence number of the next package sent.
+     */
+    uint8_t nextSequence = 0;
+
+    /**
+     * Sequence number of the oldest package that has not been acknowledged.
+     */
+    uint8_t oldestUnacked = 0;
+
+    /**
+     * Packages in flight. The package with sequence number s is at s % ARQ_WINDOW.
+     */
+    UnackedPackage window[ARQ_WINDOW] = {};
+
+    /**
+     * Smoothed round trip time. 0 as long as there is no measurement.
+     */
+    uint32_t smoothedRtt = 0;
+
+    /**
+     * Smoothed deviation of the round trip time.
+     */
+    uint32_t rttVariance = 0;
+
+    /**
+     * Current retransmission timeout.
+     */
+    uint32_t rto = ARQ_INITIAL_RTO;
+
+    /**
+     * True as soon as the first package of the neighbour has been received.
+     */
+    bool synchronized = false;
+
+    /**
+     * Sequence number of the next package expected from the neighbour.
+     */
+    uint8_t expectedSequence = 0;
+
+    /**
+     * Bit i is set if the package expectedSequence + 1 + i has been received.
+     */
+    uint32_t receivedAhead = 0;
+
+    /**
+     * True if packages have been received since the last acknowledgement.
+     */
+    bool ackPending = false;
+
+    /**
+     * Updates the retransmission timeout with a new round trip time.
+     * @param rtt The measured round trip time.
+     */
+    void _measure(uint32_t rtt);
+
+    /**
+     * Moves the oldest unacknowledged sequence number behind all acknowledged or dropped packages.
+     */
+    void _advance();
+
+public:
+    /**
+     * Number of packages sent again.
+     */
+    uint32_t retransmissions = 0;
+
+    /**
+     * Number of packages dropped, because they have not been acknowledged after ARQ_MAX_ATTEMPTS attempts.
+     */
+    uint32_t failures = 0;
+
+    /**
+     * @return Number of packages in flight.
+     */
+    uint8_t inFlight() const {
+        return (this->nextSequence - this->oldestUnacked) & SEQUENCE_MASK;
+    }
+
+    /**
+     * @return True if no package is in flight and no acknowledgement is pending.
+     */
+    bool idle() const {
+        return this->inFlight() == 0 && !this->ackPending;
+    }
+
+    /**
+     * @return True if the window has room for another package.
+     */
+    bool canSend() const {
+        return this->inFlight() < ARQ_WINDOW;
+    }
+
+    /**
+     * @return The current retransmission timeout.
+     */
+    uint32_t getRto() const {
+        return this->rto;
+    }
+
+    /**
+     * @return The smoothed round trip time. 0 as long as there is no measurement.
+     */
+    uint32_t getSmoothedRtt() const {
+        return this->smoothedRtt;
+    }
+
+    /**
+     * Assigns the next sequence number to a package and keeps a copy until it is acknowledged.
+     * The window must have room for it.
+     * @param package The raw package.
+     * @param time The current time.
+     * @return The copy of the package with its transmission ID, which has to be written to the neighbour.
+     */
+    const uint8_t* send(const uint8_t* package, uint32_t time);
+
+    /**
+     * Takes back the last sending of a package, because writing it to the data link layer failed.
+     * The package is sent again by the next pollRetransmission instead of after the timeout.
+     * @param package The package returned by send or pollRetransmission.
+     */
+    void unsend(const uint8_t* package);
+
+    /**
+     * Handles an acknowledgement of the neighbour. Missing packages sent before the newest acknowledged one are sent
+     * again by the next pollRetransmission, also if they have been sent again before.
+     * @param cumulativeAck Sequence number of the next package the neighbour expects.
+     * @param selectiveAcks Bit i is set if the package cumulativeAck + 1 + i has been received.
+     * @param time The current time.
+     */
+    void acknowledge(uint8_t cumulativeAck, uint32_t selectiveAcks, uint32_t time);
+
+    /**
+     * Searches a package that has to be sent again, because it timed out or a later package has been acknowledged.
+     * Packages that failed too often are dropped.
+     * @param time The current time.
+     * @return The package to be written to the neighbour or nullptr if there is none.
+     */
+    const uint8_t* pollRetransmission(uint32_t time);
+
+    /**
+     * Calculates when the next package has to be sent again or the acknowledgement has to be written.
+     * @param time The current time.
+     * @param delay The time in milliseconds until then is written into this, 0 if it is due.
+     * @return False if the link is idle.
+     */
+    bool nextRetransmission(uint32_t time, uint32_t* delay) const;
+
+    /**
+     * Checks the packages in flight.
+     * @param predicate Function called with each raw package in flight.
+     * @return True if the predicate is true for one of the packages.
+     */
+    bool anyInFlight(bool (*predicate)(const uint8_t*)) const;
+
+    /**
+     * Registers a package received from the neighbour.
+     * @param sequence Sequence number of the package.
+     * @return True if the package is new, false if it is a duplicate. Both are acknowledged.
+     */
+    bool receive(uint8_t sequence);
+
+    /**
+     * Takes the pending acknowledgement, if packages have been received since the last one.
+     * @param cumulativeAck The sequence number of the next package expected is written into this.
+     * @param selectiveAcks The packages received after the expected one are written into this.
+     * @return False if there is nothing to acknowledge.
+     */
+    bool takeAck(uint8_t* cumulativeAck, uint32_t* selectiveAcks);
+};
+
+/**
+ * Entry of a link in the table of reliable links.
+ */
+typedef struct LinkEntry {
+    /**
+     * True if this entry holds a link.
+     */
+    bool used;
+
+    /**
+     * ID of the neighbour.
+     */
+    uint8_t neighbour;
+
+    /**
+     * Time the link has been used the last time.
+     */
+    uint32_t lastUsed;
+
+    /**
+     * State of the link.
+     */
+    ReliableLink link;
+} LinkEntry;
+
+/**
+ * Reliable links to all neighbours. The least recently used link is replaced if there are more neighbours than links.
+ */
+class ReliableLinks {
+
+    /**
+     * The links.
+     */
+    LinkEntry entries[ARQ_LINKS] = {};
+
+public:
+    /**
+     * Searches the link to the given neighbour.
+     * @param neighbour ID of the neighbour.
+     * @return The link or nullptr if there is none.
+     */
+    ReliableLink* find(uint8_t neighbour);
+
+    /**
+     * Searches the link to the given neighbour and creates it, if there is none.
+     * @param neighbour ID of the neighbour.
+     * @param time The current time.
+     * @return The link.
+     */
+    ReliableLink* get(uint8_t neighbour, uint32_t time);
+
+    /**
+     * Searches a package of any link, that has to be sent again.
+     * @param time The current time.
+     * @param neighbour The neighbour the package has to be written to is written into this.
+     * @return The package or nullptr if there is none.
+     */
+    const uint8_t* pollRetransmission(uint32_t time, uint8_t* neighbour);
+
+    /**
+     * Calculates when the next package of any link has to be sent again or an acknowledgement has to be written.
+     * @param time The current time.
+     * @param delay The time in milliseconds until then is written into this, 0 if it is due.
+     * @return False if all links are idle.
+     */
+    bool nextRetransmission(uint32_t time, uint32_t* delay) const;
+
+    /**
+     * Checks the packages in flight of all links.
+     * @param predicate Function called with each raw package in flight.
+     * @return True if the predicate is true for one of the packages.
+     */
+    bool anyInFlight(bool (*predicate)(const uint8_t*)) const;
+
+    /**
+     * Takes the pending acknowledgement of any link.
+     * @param neighbour The neighbour the acknowledgement has to be sent to is written into this.
+     * @param cumulativeAck The sequence number of the next package expected is written into this.
+     * @param selectiveAcks The packages received after the expected one are written into this.
+     * @return False if there is nothing to acknowledge.
+     */
+    bool takeAck(uint8_t* neighbour, uint8_t* cumulativeAck, uint32_t* selectiveAcks);
+
+    /**
+     * @return True if no link has a package in flight or a pending acknowledgement.
+     */
+    bool idle() const;
+
+    /**
+     * @return Number of packages sent again over all links.
+     */
+    uint32_t getRetransmissions() const;
+
+    /**
+     * @return Number of packages dropped over all links, because they have not been acknowledged.
+     */
+    uint32_t getFailures() const;
+};
+
+
+#endif //NETWORKPROTOCOL_RELIABLELINK_H
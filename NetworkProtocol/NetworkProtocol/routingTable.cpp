@@ -0,0 +1,57 @@
+#include "routingTable.h"
+
+#include <cstring>
+
+RoutingTable::RoutingTable() {
+    this->clear();
+}
+
+void RoutingTable::set(uint8_t id, uint8_t nextHop) {
+    if (!this->contains(id)) {
+        this->valid[id >> 5] |= 1UL << (id & 31);
+        this->entries++;
+    }
+    this->nextHops[id] = nextHop;
+}
+
+void RoutingTable::erase(uint8_t id) {
+    if (!this->contains(id)) return;
+    this->valid[id >> 5] &= ~(1UL << (id & 31));
+    this->entries--;
+}
+
+void RoutingTable::clear() {
+    memset(this->nextHops, 0, sizeof(this->nextHops));
+    memset(this->valid, 0, sizeof(this->valid));
+    this->entries = 0;
+}
+
+bool RoutingTable::findFree(uint8_t *id, uint8_t first) const {
+    for (uint8_t word = first / 32; word < ROUTING_TABLE_WORDS; word++) {
+        uint32_t free = ~this->valid[word];
+        // ignore the IDs below the first one
+        if (word == first / 32) free &= UINT32_C(0xFFFFFFFF) << (first % 32);
+        // skip words without a free ID
+        if (free == 0) continue;
+
+        uint8_t bit = 0;
+        while (!((free >> bit) & 1)) bit++;
+        *id = word * 32 + bit;
+        return true;
+    }
+    return false;
+}
+
+bool RoutingTable::next(uint8_t *id, uint8_t first) const {
+    for (uint8_t word = first / 32; word < ROUTING_TABLE_WORDS; word++) {
+        uint32_t used = this->valid[word];
+        if (word == first / 32) used &= UINT32_C(0xFFFFFFFF) << (first % 32);
+        if (used == 0) continue;
+
+        uint8_t bit = 0;
+        while (!((used >> bit) & 1)) bit++;
+        *id = word * 32 + bit;
+        return true;
+    }
+    return false;
+}
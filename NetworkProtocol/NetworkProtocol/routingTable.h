@@ -0,0 +1,97 @@
+#ifndef NETWORKPROTOCOL_ROUTINGTABLE_H
+#define NETWORKPROTOCOL_ROUTINGTABLE_H
+#include <cstdint>
+
+#define ROUTING_TABLE_SIZE 256
+#define ROUTING_TABLE_WORDS (ROUTING_TABLE_SIZE / 32)
+
+/**
+ * Routing table for all device IDs. Since IDs are one byte, the next hop of each ID is stored at its index,
+ * so a lookup is a bit test and a single load and no memory is allocated.
+ */
+class RoutingTable {
+
+    /**
+     * Next hop of each ID. Only meaningful if the ID's valid bit is set.
+     */
+    uint8_t nextHops[ROUTING_TABLE_SIZE];
+
+    /**
+     * Bitmap of the IDs that have an entry.
+     */
+    uint32_t valid[ROUTING_TABLE_WORDS];
+
+    /**
+     * Number of entries.
+     */
+    uint16_t entries;
+
+public:
+    /**
+     * Creates an empty routing table.
+     */
+    RoutingTable();
+
+    /**
+     * Checks if there is an entry for the given ID.
+     * @param id ID of the device.
+     * @return True if the ID has an entry.
+     */
+    bool contains(uint8_t id) const {
+        return (this->valid[id >> 5] >> (id & 31)) & 1;
+    }
+
+    /**
+     * Looks up the next hop of the given ID.
+     * @param id ID of the device.
+     * @param fallback Next hop returned if the ID has no entry.
+     * @return The next hop of the ID or the fallback.
+     */
+    uint8_t nextHop(uint8_t id, uint8_t fallback) const {
+        return this->contains(id) ? this->nextHops[id] : fallback;
+    }
+
+    /**
+     * Adds or overwrites the entry of the given ID.
+     * @param id ID of the device.
+     * @param nextHop Next hop over which the device can be reached.
+     */
+    void set(uint8_t id, uint8_t nextHop);
+
+    /**
+     * Removes the entry of the given ID, if there is one.
+     * @param id ID of the device.
+     */
+    void erase(uint8_t id);
+
+    /**
+     * Removes all entries.
+     */
+    void clear();
+
+    /**
+     * Searches the lowest ID without an entry.
+     * @param id The free ID is written into this.
+     * @param first Lowest ID to be considered.
+     * @return False if all IDs from the first one have an entry.
+     */
+    bool findFree(uint8_t *id, uint8_t first = 0) const;
+
+    /**
+     * Searches the lowest ID with an entry, e.g. to iterate over all entries.
+     * @param id The ID is written into this.
+     * @param first Lowest ID to be considered.
+     * @return False if no ID from the first one has an entry.
+     */
+    bool next(uint8_t *id, uint8_t first = 0) const;
+
+    /**
+     * @return Number of entries.
+     */
+    uint16_t size() const {
+        return this->entries;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_ROUTINGTABLE_H
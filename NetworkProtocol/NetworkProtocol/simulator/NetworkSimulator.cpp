@@ -0,0 +1,77 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Simulation.h"
+
+/**
+ * Prints a distribution of times.
+ * @param name Name of the measured times.
+ * @param statistics The distribution.
+ */
+static void print(const char *name, const TimeStatistics &statistics) {
+    printf("%-14s n=%-4u lost=%-4u mean=%8.1f ms  p50=%6u ms  p95=%6u ms  max=%6u ms\n", name, statistics.count,
+        statistics.lost, statistics.mean, statistics.median, statistics.p95, statistics.max);
+}
+
+/**
+ * Simulates the registration of a network and the data messages between the hub and all devices.
+ * Usage: NetworkSimulator [nodes] [seed] [area radius] [radio range] [max loss rate] [aggregation window] [ping time]
+ *        [broadcast discovery]
+ */
+int main(int argc, char **argv) {
+    SimulationConfig config;
+    if (argc > 1) config.nodes = std::atoi(argv[1]);
+    if (argc > 2) config.seed = std::strtoul(argv[2], nullptr, 10);
+    if (argc > 3) config.areaRadius = std::atof(argv[3]);
+    if (argc > 4) config.radioRange = std::atof(argv[4]);
+    if (argc > 5) config.maxLossRate = std::atof(argv[5]);
+    if (argc > 6) config.aggregationWindow = std::atoi(argv[6]);
+    if (argc > 7) config.pingTime = std::strtoul(argv[7], nullptr, 10);
+    if (argc > 8) config.broadcastDiscovery = std::atoi(argv[8]) != 0;
+
+    if (config.nodes < 2 || config.nodes > 255) {
+        printf("the number of devices must be between 2 and 255\n");
+        return 1;
+    }
+
+    printf("%u devices, seed %u, area radius %.0f, radio range %.0f, max loss %.2f, aggregation window %u ms, "
+        "ping time %u ms, %s discovery\n", config.nodes, config.seed, config.areaRadius, config.radioRange,
+        config.maxLossRate, config.aggregationWindow, config.pingTime, config.broadcastDiscovery ? "broadcast" : "sweep");
+
+    Simulation simulation(config);
+    bool converged = simulation.runRegistration();
+    uint32_t convergenceTime = simulation.getMedium().getTime();
+    printf("registration   %s after %u ms\n", converged ? "converged" : "did not converge", convergenceTime);
+    print("per device", simulation.registrationTimes());
+
+    // shape of the tree and size of the routing tables
+    uint32_t entries = 0;
+    uint32_t maxEntries = 0;
+    uint32_t depthSum = 0;
+    uint8_t maxDepth = 0;
+    uint16_t registered = 0;
+    for (const SimulatedNode &node : simulation.getNodes()) {
+        if (node.device == nullptr || !node.device->isRegistered()) continue;
+        ++registered;
+        uint16_t size = node.device->getRoutingTable().size();
+        entries += size;
+        if (size > maxEntries) maxEntries = size;
+        depthSum += node.device->getHierarchyLevel();
+        if (node.device->getHierarchyLevel() > maxDepth) maxDepth = node.device->getHierarchyLevel();
+    }
+    printf("tree           mean depth=%.2f  max depth=%u\n", registered > 0 ? double(depthSum) / registered : 0.0,
+        maxDepth);
+    printf("routing tables entries=%u  max per device=%u  memory per device=%u bytes (temporary routes %u bytes)\n",
+        entries, maxEntries, static_cast<uint32_t>(sizeof(RoutingTable)),
+        static_cast<uint32_t>(sizeof(TempRoutingTable)));
+
+    print("uplink", simulation.measureUplink());
+    print("downlink", simulation.measureDownlink());
+
+    const LoopbackMedium &medium = simulation.getMedium();
+    printf("medium         sent=%llu  lost=%llu  delivered=%llu\n",
+        static_cast<unsigned long long>(medium.getSentCount()), static_cast<unsigned long long>(medium.getLostCount()),
+        static_cast<unsigned long long>(medium.getDeliveredCount()));
+    return converged ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../networkHub.h"
+
+// more updates within one millisecond mean that the devices keep sending each other packages without latency
+#define MAX_UPDATE_ROUNDS 64
+
+Simulation::Simulation(const SimulationConfig &config) : config(config), medium(config.seed), random(config.seed) {
+    std::uniform_real_distribution<double> coordinate(-config.areaRadius, config.areaRadius);
+
+    for (uint16_t i = 0; i < config.nodes; ++i) {
+        SimulatedNode node = {nullptr, nullptr, 0, 0, i * config.joinInterval, 0};
+        // the hub is at the center, the other devices must be in range of a device placed before them
+        bool inRange = i == 0;
+        while (!inRange) {
+            node.x = coordinate(this->random);
+            node.y = coordinate(this->random);
+            if (std::hypot(node.x, node.y) > config.areaRadius) continue;
+            for (const SimulatedNode &other : this->nodes) {
+                if (std::hypot(node.x - other.x, node.y - other.y) <= config.radioRange) {
+                    inRange = true;
+                    break;
+                }
+            }
+        }
+        this->nodes.push_back(node);
+    }
+}
+
+Simulation::~Simulation() {
+    for (SimulatedNode &node : this->nodes) {
+        delete node.device;
+    }
+}
+
+void Simulation::_join() {
+    uint32_t time = this->medium.getTime();
+    std::uniform_int_distribution<uint32_t> offset(0, 1 << 20);
+
+    for (; this->nextJoin < this->nodes.size() && this->nodes[this->nextJoin].joinTime <= time; ++this->nextJoin) {
+        SimulatedNode &node = this->nodes[this->nextJoin];
+        node.transport = this->medium.createTransport();
+
+        // the loss grows with the distance
+        for (uint16_t i = 0; i < this->nextJoin; ++i) {
+            double distance = std::hypot(node.x - this->nodes[i].x, node.y - this->nodes[i].y);
+            if (distance > this->config.radioRange) continue;
+            double ratio = distance / this->config.radioRange;
+            this->medium.connect(node.transport, this->nodes[i].transport,
+                {this->config.latency, this->config.maxLossRate * ratio * ratio, this->config.bandwidth});
+        }
+
+        if (this->nextJoin == 0) {
+            node.device = new NetworkHub(this->config.timeout, this->config.pingTime);
+        } else {
+            node.device = new NetworkDevice(0, this->config.timeout);
+            // devices are switched on at different times, so they choose different temporary IDs
+            node.transport->setClockOffset(offset(this->random));
+        }
+        node.device->setTransport(node.transport);
+        node.device->setAggregationWindow(this->config.aggregationWindow);
+        node.device->setBroadcastDiscovery(this->config.broadcastDiscovery);
+    }
+}
+
+void Simulation::_updateAll(int32_t *receivedBy) {
+    for (uint8_t round = 0; round < MAX_UPDATE_ROUNDS; ++round) {
+        bool available = false;
+        for (uint16_t i = 0; i < this->nextJoin; ++i) {
+            SimulatedNode &node = this->nodes[i];
+            if (node.device->update() && receivedBy != nullptr) *receivedBy = i;
+            if (node.registrationTime == 0 && node.device->isRegistered()) {
+                node.registrationTime = this->medium.getTime();
+            }
+            available = available || node.transport->messageAvailable();
+        }
+        if (!available) return;
+    }
+}
+
+bool Simulation::_quiet() const {
+    for (uint16_t i = 0; i < this->nextJoin; ++i) {
+        if (!this->nodes[i].device->isQuiet()) return false;
+    }
+    return true;
+}
+
+bool Simulation::_step() {
+    uint32_t next;
+    bool found = this->medium.nextArrival(&next);
+    uint32_t delay;
+    for (uint16_t i = 0; i < this->nextJoin; ++i) {
+        if (!this->nodes[i].device->nextTimer(&delay)) continue;
+        // the devices have been updated at the current time already
+        uint32_t expiry = this->medium.getTime() + (delay > 0 ? delay : 1);
+        if (!found || expiry < next) next = expiry;
+        found = true;
+    }
+    if (this->nextJoin < this->nodes.size()) {
+        uint32_t join = this->nodes[this->nextJoin].joinTime;
+        if (!found || join < next) next = join;
+        found = true;
+    }
+    if (!found) return false;
+    this->medium.advanceTo(next);
+    return true;
+}
+
+bool Simulation::runRegistration() {
+    while (this->medium.getTime() < this->config.timeLimit) {
+        this->_join();
+        this->_updateAll(nullptr);
+
+        bool registered = this->nextJoin == this->nodes.size();
+        for (uint16_t i = 0; registered && i < this->nodes.size(); ++i) {
+            registered = this->nodes[i].device->isRegistered();
+        }
+        if (registered) return true;
+        if (!this->_step()) return false;
+    }
+    return false;
+}
+
+bool Simulation::_deliver(uint16_t from, uint16_t to, uint32_t *latency) {
+    uint8_t content[8] = {};
+    content[0] = from;
+    content[1] = to;
+
+    uint32_t start = this->medium.getTime();
+    this->nodes[from].device->send(this->nodes[to].device->getID(), content, sizeof(content));
+
+    bool received = false;
+    while (this->medium.getTime() - start < this->config.deliveryTimeout) {
+        int32_t receivedBy = -1;
+        this->_updateAll(&receivedBy);
+        if (receivedBy == to) {
+            received = true;
+            break;
+        }
+        if (!this->_step()) break;
+    }
+    *latency = this->medium.getTime() - start;
+
+    // let the acknowledgements settle, so the next message starts from a quiet network
+    // the periodic pings of the hub never stop, so they are not waited for
+    while (!this->_quiet() && this->_step()) {
+        this->_updateAll(nullptr);
+        if (this->medium.getTime() - start > 2 * this->config.deliveryTimeout) break;
+    }
+    return received;
+}
+
+TimeStatistics Simulation::measureUplink() {
+    std::vector<uint32_t> latencies;
+    uint32_t lost = 0;
+    uint32_t latency;
+    for (uint16_t i = 1; i < this->nextJoin; ++i) {
+        if (!this->nodes[i].device->isRegistered()) continue;
+        if (this->_deliver(i, 0, &latency)) latencies.push_back(latency);
+        else ++lost;
+    }
+    return _statistics(latencies, lost);
+}
+
+TimeStatistics Simulation::measureDownlink() {
+    std::vector<uint32_t> latencies;
+    uint32_t lost = 0;
+    uint32_t latency;
+    for (uint16_t i = 1; i < this->nextJoin; ++i) {
+        if (!this->nodes[i].device->isRegistered()) continue;
+        if (this->_deliver(0, i, &latency)) latencies.push_back(latency);
+        else ++lost;
+    }
+    return _statistics(latencies, lost);
+}
+
+TimeStatistics Simulation::registrationTimes() const {
+    std::vector<uint32_t> times;
+    uint32_t lost = 0;
+    for (uint16_t i = 1; i < this->nodes.size(); ++i) {
+        const SimulatedNode &node = this->nodes[i];
+        if (node.registrationTime == 0) ++lost;
+        else times.push_back(node.registrationTime - node.joinTime);
+    }
+    return _statistics(times, lost);
+}
+
+TimeStatistics Simulation::_statistics(std::vector<uint32_t> &times, uint32_t lost) {
+    TimeStatistics statistics = {static_cast<uint32_t>(times.size()), lost, 0, 0, 0, 0};
+    if (times.empty()) return statistics;
+
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (uint32_t time : times) sum += time;
+    statistics.mean = sum / times.size();
+    statistics.median = times[times.size() / 2];
+    statistics.p95 = times[times.size() * 95 / 100];
+    statistics.max = times.back();
+    return statistics;
+}
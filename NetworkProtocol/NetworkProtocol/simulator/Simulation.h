@@ -0,0 +1,252 @@
+#ifndef NETWORKPROTOCOL_SIMULATION_H
+#define NETWORKPROTOCOL_SIMULATION_H
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../loopbackTransport.h"
+#include "../networkDevice.h"
+
+/**
+ * Parameters of a simulated network.
+ */
+typedef struct SimulationConfig {
+    /**
+     * Number of devices including the hub.
+     */
+    uint16_t nodes = 250;
+
+    /**
+     * Seed of the topology, the clock offsets and the losses, so runs can be repeated.
+     */
+    uint32_t seed = 1;
+
+    /**
+     * Radius of the area the devices are placed in, the hub is at its center.
+     */
+    double areaRadius = 100;
+
+    /**
+     * Distance up to which two devices are in radio range.
+     */
+    double radioRange = 25;
+
+    /**
+     * Loss rate of a link between devices at the border of the radio range. The loss grows with the square
+     * of the distance.
+     */
+    double maxLossRate = 0.2;
+
+    /**
+     * Latency of all links in milliseconds.
+     */
+    uint32_t latency = 2;
+
+    /**
+     * Bits per second of all links. 0 for unlimited bandwidth.
+     */
+    uint32_t bandwidth = 250000;
+
+    /**
+     * Time in milliseconds between two devices joining the network.
+     */
+    uint32_t joinInterval = 20;
+
+    /**
+     * Timeout of discoveries and registration requests in milliseconds.
+     */
+    uint16_t timeout = 1000;
+
+    /**
+     * Simulated time in milliseconds after which the registration is given up.
+     */
+    uint32_t timeLimit = 600000;
+
+    /**
+     * Simulated time in milliseconds after which a data message is counted as lost.
+     */
+    uint32_t deliveryTimeout = 5000;
+
+    /**
+     * Time in milliseconds small messages wait to be sent in one frame with others. 0 disables the aggregation.
+     */
+    uint16_t aggregationWindow = 0;
+
+    /**
+     * Time in milliseconds in which the hub pings each device once. 0 disables the pings.
+     */
+    uint32_t pingTime = 0;
+
+    /**
+     * True if the devices broadcast their discoveries, false if they ping each ID.
+     */
+    bool broadcastDiscovery = true;
+} SimulationConfig;
+
+/**
+ * A simulated device and its place in the topology.
+ */
+typedef struct SimulatedNode {
+    /**
+     * The device, the hub at index 0. Created when the device joins.
+     */
+    NetworkDevice *device;
+
+    /**
+     * Transport of the device. Owned by the medium.
+     */
+    LoopbackTransport *transport;
+
+    /**
+     * Position of the device.
+     */
+    double x;
+    double y;
+
+    /**
+     * Time the device is switched on.
+     */
+    uint32_t joinTime;
+
+    /**
+     * Time the device has been registered. 0 as long as it is not registered.
+     */
+    uint32_t registrationTime;
+} SimulatedNode;
+
+/**
+ * Distribution of measured times.
+ */
+typedef struct TimeStatistics {
+    uint32_t count;
+    uint32_t lost;
+    double mean;
+    uint32_t median;
+    uint32_t p95;
+    uint32_t max;
+} TimeStatistics;
+
+/**
+ * Deterministic discrete-event simulation of many devices on a loopback medium.
+ * All devices share the virtual clock of the medium. The simulation jumps to the next package arrival, join or
+ * timer of a device, e.g. a retransmission, a registration timeout or a coalescing window.
+ */
+class Simulation {
+
+    /**
+     * Parameters of the network.
+     */
+    SimulationConfig config;
+
+    /**
+     * Medium connecting the devices.
+     */
+    LoopbackMedium medium;
+
+    /**
+     * Random numbers for the topology and the clock offsets.
+     */
+    std::mt19937 random;
+
+    /**
+     * All devices, the hub at index 0.
+     */
+    std::vector<SimulatedNode> nodes;
+
+    /**
+     * Index of the next device to be switched on.
+     */
+    uint16_t nextJoin = 0;
+
+    /**
+     * Switches on the devices whose join time has come and connects them to the devices in range.
+     */
+    void _join();
+
+    /**
+     * Updates all devices until no package is available at the current time.
+     * @param receivedBy The index of a device that completed a data message is written into this, if not null.
+     */
+    void _updateAll(int32_t *receivedBy);
+
+    /**
+     * @return True if no device has data to send or waits for an acknowledgement. Pings are ignored.
+     */
+    bool _quiet() const;
+
+    /**
+     * Moves the clock to the next time something happens.
+     * @return False if nothing will happen anymore.
+     */
+    bool _step();
+
+    /**
+     * Sends a data message and runs the simulation until it has been received.
+     * @param from Index of the sending device.
+     * @param to Index of the receiving device.
+     * @param latency The end-to-end latency is written into this.
+     * @return False if the message has not been received within the delivery timeout.
+     */
+    bool _deliver(uint16_t from, uint16_t to, uint32_t *latency);
+
+    /**
+     * Calculates the distribution of the given times.
+     * @param times The times. Sorted by this method.
+     * @param lost Number of measurements without a result.
+     * @return The distribution.
+     */
+    static TimeStatistics _statistics(std::vector<uint32_t> &times, uint32_t lost);
+
+public:
+    /**
+     * Places the devices randomly in the area. Each device is in range of a device placed before it,
+     * so the network is connected.
+     * @param config Parameters of the network.
+     */
+    explicit Simulation(const SimulationConfig &config);
+
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    /**
+     * Switches on the devices one after another and runs the simulation until all of them are registered.
+     * @return False if not all devices have been registered within the time limit.
+     */
+    bool runRegistration();
+
+    /**
+     * Sends a data message from each registered device to the hub, one after another.
+     * @return Distribution of the end-to-end latencies in milliseconds.
+     */
+    TimeStatistics measureUplink();
+
+    /**
+     * Sends a data message from the hub to each registered device, one after another.
+     * @return Distribution of the end-to-end latencies in milliseconds.
+     */
+    TimeStatistics measureDownlink();
+
+    /**
+     * @return Distribution of the times from switching on to registration of the devices without the hub.
+     */
+    TimeStatistics registrationTimes() const;
+
+    /**
+     * @return The simulated devices.
+     */
+    const std::vector<SimulatedNode>& getNodes() const {
+        return this->nodes;
+    }
+
+    /**
+     * @return The medium connecting the devices.
+     */
+    const LoopbackMedium& getMedium() const {
+        return this->medium;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_SIMULATION_H
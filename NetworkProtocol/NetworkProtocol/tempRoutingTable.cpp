@@ -0,0 +1,95 @@
+#include "tempRoutingTable.h"
+
+#include "timer.h"
+
+#define NEXT_SLOT(index) (((index) + 1) & (TEMP_ROUTING_SLOTS - 1))
+
+uint8_t TempRoutingTable::_home(uint32_t tempID) {
+    // temporary IDs are timestamps, so the multiplication spreads consecutive IDs over the table
+    return (static_cast<uint32_t>(tempID * 2654435761UL) >> 24) & (TEMP_ROUTING_SLOTS - 1);
+}
+
+uint16_t TempRoutingTable::_find(uint32_t tempID) const {
+    uint16_t index = _home(tempID);
+    for (uint16_t probe = 0; probe < TEMP_ROUTING_SLOTS; probe++) {
+        const TempRoute &route = this->slots[index];
+        if (!route.used) break;
+        if (route.tempID == tempID) return index;
+        index = NEXT_SLOT(index);
+    }
+    return TEMP_ROUTING_SLOTS;
+}
+
+void TempRoutingTable::_remove(uint16_t index) {
+    this->slots[index].used = false;
+    this->entries--;
+
+    // move routes back, whose probe sequence passes the emptied slot
+    uint16_t empty = index;
+    uint16_t next = NEXT_SLOT(index);
+    while (this->slots[next].used) {
+        uint16_t home = _home(this->slots[next].tempID);
+        // distance from the home slot to the current and to the empty slot, both in probing direction
+        uint16_t distanceCurrent = (next - home) & (TEMP_ROUTING_SLOTS - 1);
+        uint16_t distanceEmpty = (empty - home) & (TEMP_ROUTING_SLOTS - 1);
+        if (distanceEmpty < distanceCurrent) {
+            this->slots[empty] = this->slots[next];
+            this->slots[next].used = false;
+            empty = next;
+        }
+        next = NEXT_SLOT(next);
+    }
+}
+
+bool TempRoutingTable::set(uint32_t tempID, uint8_t nextHop, uint32_t time) {
+    uint16_t index = _home(tempID);
+    for (uint16_t probe = 0; probe < TEMP_ROUTING_SLOTS; probe++) {
+        TempRoute &route = this->slots[index];
+        if (!route.used || route.tempID == tempID) {
+            if (!route.used) {
+                route.used = true;
+                route.tempID = tempID;
+                this->entries++;
+                if (this->entries > this->peakEntries) this->peakEntries = this->entries;
+            }
+            route.nextHop = nextHop;
+            route.timestamp = time;
+            return true;
+        }
+        index = NEXT_SLOT(index);
+    }
+    this->rejectedCount++;
+    return false;
+}
+
+bool TempRoutingTable::get(uint32_t tempID, uint8_t *nextHop) const {
+    uint16_t index = this->_find(tempID);
+    if (index == TEMP_ROUTING_SLOTS) return false;
+    *nextHop = this->slots[index].nextHop;
+    return true;
+}
+
+bool TempRoutingTable::erase(uint32_t tempID) {
+    uint16_t index = this->_find(tempID);
+    if (index == TEMP_ROUTING_SLOTS) return false;
+    this->_remove(index);
+    return true;
+}
+
+void TempRoutingTable::update(uint32_t time) {
+    for (uint16_t index = 0; index < TEMP_ROUTING_SLOTS; index++) {
+        // a route moved into this slot by the removal has to be checked as well
+        while (this->slots[index].used && Timer::elapsed(this->slots[index].timestamp, time) > this->timeout) {
+            this->_remove(index);
+            this->expiredCount++;
+        }
+    }
+}
+
+uint8_t TempRoutingTable::count(uint8_t nextHop) const {
+    uint8_t routes = 0;
+    for (const TempRoute &route : this->slots) {
+        if (route.used && route.nextHop == nextHop) ++routes;
+    }
+    return routes;
+}
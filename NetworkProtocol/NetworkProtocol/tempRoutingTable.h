@@ -0,0 +1,166 @@
+#ifndef NETWORKPROTOCOL_TEMPROUTINGTABLE_H
+#define NETWORKPROTOCOL_TEMPROUTINGTABLE_H
+#include <cstdint>
+
+#define TEMP_ROUTING_SLOTS 16
+#define TEMP_ROUTE_TIMEOUT 10000
+
+static_assert((TEMP_ROUTING_SLOTS & (TEMP_ROUTING_SLOTS - 1)) == 0, "TEMP_ROUTING_SLOTS must be a power of two");
+static_assert(TEMP_ROUTING_SLOTS <= 256, "TEMP_ROUTING_SLOTS must fit in one byte");
+
+/**
+ * Route to a device, that only has a temporary ID while it registers.
+ */
+typedef struct TempRoute {
+    /**
+     * True if this slot holds a route.
+     */
+    bool used;
+
+    /**
+     * ID of the children over which the device can be reached.
+     */
+    uint8_t nextHop;
+
+    /**
+     * Temporary ID of the device.
+     */
+    uint32_t tempID;
+
+    /**
+     * Time the route has been added or updated. The route expires after the timeout of the table.
+     */
+    uint32_t timestamp;
+} TempRoute;
+
+/**
+ * Routing table for devices that only have a temporary ID.
+ * The table is an open addressing hash table with a fixed number of slots, so registrations that are abandoned
+ * halfway expire instead of leaking memory on every hop.
+ */
+class TempRoutingTable {
+
+    /**
+     * Slots of the hash table. Collisions are resolved by linear probing.
+     */
+    TempRoute slots[TEMP_ROUTING_SLOTS] = {};
+
+    /**
+     * Time after which a route expires.
+     */
+    uint16_t timeout;
+
+    /**
+     * Number of used slots.
+     */
+    uint8_t entries = 0;
+
+    /**
+     * Highest number of used slots so far.
+     */
+    uint8_t peakEntries = 0;
+
+    /**
+     * Number of routes dropped, because they expired.
+     */
+    uint32_t expiredCount = 0;
+
+    /**
+     * Number of routes not added, because the table was full.
+     */
+    uint32_t rejectedCount = 0;
+
+    /**
+     * @param tempID A temporary ID.
+     * @return The slot at which the probing for the temporary ID starts.
+     */
+    static uint8_t _home(uint32_t tempID);
+
+    /**
+     * Searches the slot of the given temporary ID.
+     * @param tempID Temporary ID of the device.
+     * @return Index of the slot or TEMP_ROUTING_SLOTS if there is no route for the temporary ID.
+     */
+    uint16_t _find(uint32_t tempID) const;
+
+    /**
+     * Empties the given slot and moves the following routes of the probe sequence back, so no tombstones are needed.
+     * @param index Index of the slot.
+     */
+    void _remove(uint16_t index);
+
+public:
+    /**
+     * Creates an empty table.
+     * @param timeout Time after which a route expires.
+     */
+    explicit TempRoutingTable(uint16_t timeout = TEMP_ROUTE_TIMEOUT) : timeout(timeout) {}
+
+    /**
+     * Adds or updates the route of the given temporary ID and restarts its expiry.
+     * @param tempID Temporary ID of the device.
+     * @param nextHop ID of the children over which the device can be reached.
+     * @param time The current time.
+     * @return False if the table is full.
+     */
+    bool set(uint32_t tempID, uint8_t nextHop, uint32_t time);
+
+    /**
+     * Looks up the route of the given temporary ID.
+     * @param tempID Temporary ID of the device.
+     * @param nextHop The next hop is written into this, if there is a route.
+     * @return False if there is no route for the temporary ID.
+     */
+    bool get(uint32_t tempID, uint8_t *nextHop) const;
+
+    /**
+     * Removes the route of the given temporary ID, if there is one.
+     * @param tempID Temporary ID of the device.
+     * @return True if a route has been removed.
+     */
+    bool erase(uint32_t tempID);
+
+    /**
+     * Counts the routes over the given next hop.
+     * @param nextHop ID of the children.
+     * @return Number of routes.
+     */
+    uint8_t count(uint8_t nextHop) const;
+
+    /**
+     * Drops all expired routes.
+     * @param time The current time.
+     */
+    void update(uint32_t time);
+
+    /**
+     * @return Number of routes.
+     */
+    uint8_t size() const {
+        return this->entries;
+    }
+
+    /**
+     * @return Highest number of routes held at the same time.
+     */
+    uint8_t getPeakSize() const {
+        return this->peakEntries;
+    }
+
+    /**
+     * @return Number of routes dropped, because they expired.
+     */
+    uint32_t getExpiredCount() const {
+        return this->expiredCount;
+    }
+
+    /**
+     * @return Number of routes not added, because the table was full.
+     */
+    uint32_t getRejectedCount() const {
+        return this->rejectedCount;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_TEMPROUTINGTABLE_H
@@ -9,6 +9,11 @@ bool Timer::expired(uint32_t time) {
     return elapsed(this->startTime, time) > this->duration;
 }
 
+uint32_t Timer::remaining(uint32_t time) const {
+    uint32_t elapsed = Timer::elapsed(this->startTime, time);
+    return elapsed > this->duration ? 0 : this->duration + 1 - elapsed;
+}
+
 uint32_t Timer::elapsed(uint32_t startingTime, uint32_t time) {
     if (startingTime > time) {
         return UINT32_MAX - startingTime + time;
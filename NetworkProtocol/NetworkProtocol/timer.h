@@ -48,6 +48,13 @@ public:
      */
     bool expired(uint32_t time);
 
+    /**
+     * Calculates the time until the timer is expired.
+     * @param time Current time.
+     * @return Milliseconds until expired() returns true, 0 if it is already expired.
+     */
+    uint32_t remaining(uint32_t time) const;
+
     /**
      * Calculates the elapsed time between the given times, while paying attention to overflows.
      * @param startingTime Starting time.
@@ -0,0 +1,105 @@
+#include "timerWheel.h"
+
+void TimerWheel::_link(WheelTimer **head, WheelTimer *timer) {
+    timer->next = *head;
+    if (*head != nullptr) (*head)->previous = &timer->next;
+    timer->previous = head;
+    *head = timer;
+}
+
+void TimerWheel::_unlink(WheelTimer *timer) {
+    *timer->previous = timer->next;
+    if (timer->next != nullptr) timer->next->previous = timer->previous;
+    timer->next = nullptr;
+    timer->previous = nullptr;
+}
+
+void TimerWheel::_insert(WheelTimer *timer) {
+    uint32_t delay = timer->expiry - this->now;
+    // the slot of the current time has been handled already
+    if (delay == 0 || delay >= UINT32_C(1) << 31) {
+        _link(&this->expired, timer);
+        return;
+    }
+
+    // timers beyond the range wait in the last slot of the top level and are inserted again when it is reached
+    uint32_t slotTime = delay < WHEEL_RANGE ? timer->expiry : this->now + WHEEL_RANGE - 1;
+    uint8_t level = 0;
+    while (level < WHEEL_LEVELS - 1 && delay >= UINT32_C(1) << ((level + 1) * WHEEL_SLOT_BITS)) level++;
+    uint8_t slot = (slotTime >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1);
+    _link(&this->slots[level][slot], timer);
+}
+
+void TimerWheel::schedule(WheelTimer *timer, uint32_t time, uint32_t delay) {
+    this->cancel(timer);
+    // without pending timers the wheel can jump to the current time
+    if (this->count == 0) this->now = time;
+    timer->expiry = time + delay;
+    this->count++;
+    this->_insert(timer);
+}
+
+void TimerWheel::cancel(WheelTimer *timer) {
+    if (!timer->scheduled()) return;
+    _unlink(timer);
+    this->count--;
+}
+
+WheelTimer* TimerWheel::poll(uint32_t time) {
+    // times before the last poll, e.g. of a clock that has been set back, do not move the wheel
+    while (this->expired == nullptr && static_cast<int32_t>(time - this->now) > 0) {
+        if (this->count == 0) {
+            this->now = time;
+            break;
+        }
+        this->now++;
+
+        // move the timers of the upper levels down when the levels below have turned once
+        for (uint8_t level = 1; level < WHEEL_LEVELS; level++) {
+            if (this->now & ((UINT32_C(1) << (level * WHEEL_SLOT_BITS)) - 1)) break;
+            WheelTimer **slot = &this->slots[level][(this->now >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1)];
+            while (*slot != nullptr) {
+                WheelTimer *timer = *slot;
+                _unlink(timer);
+                this->_insert(timer);
+            }
+        }
+
+        // all timers of the lowest level expire when their slot is reached
+        WheelTimer **slot = &this->slots[0][this->now & (WHEEL_SLOTS - 1)];
+        while (*slot != nullptr) {
+            WheelTimer *timer = *slot;
+            _unlink(timer);
+            _link(&this->expired, timer);
+        }
+    }
+
+    WheelTimer *timer = this->expired;
+    if (timer == nullptr) return nullptr;
+    _unlink(timer);
+    this->count--;
+    return timer;
+}
+
+bool TimerWheel::nextExpiry(uint32_t *time) const {
+    if (this->count == 0) return false;
+    if (this->expired != nullptr) {
+        *time = this->now;
+        return true;
+    }
+
+    bool found = false;
+    for (uint8_t level = 0; level < WHEEL_LEVELS; level++) {
+        uint8_t shift = level * WHEEL_SLOT_BITS;
+        // the slot of the current time is reached again after a full turn
+        for (uint8_t step = 1; step <= WHEEL_SLOTS; step++) {
+            uint32_t slotIndex = (this->now >> shift) + step;
+            if (this->slots[level][slotIndex & (WHEEL_SLOTS - 1)] == nullptr) continue;
+            uint32_t slotTime = slotIndex << shift;
+            if (!found || slotTime - this->now < *time - this->now) *time = slotTime;
+            found = true;
+            break;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,154 @@
+#ifndef NETWORKPROTOCOL_TIMERWHEEL_H
+#define NETWORKPROTOCOL_TIMERWHEEL_H
+#include <cstdint>
+
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_RANGE (UINT32_C(1) << (WHEEL_LEVELS * WHEEL_SLOT_BITS))
+
+/**
+ * Timer that is scheduled on a timer wheel. It is owned by the caller and linked into the wheel while it is
+ * scheduled, so it must not be moved or destroyed before it has expired or has been cancelled.
+ */
+typedef struct WheelTimer {
+    /**
+     * Kind of the timer, so the owner knows what to do when it expires.
+     */
+    uint8_t kind;
+
+    /**
+     * Identifies the object of the timer for its owner, e.g. a device or a temporary ID.
+     */
+    uint32_t key;
+
+    /**
+     * Time the timer expires.
+     */
+    uint32_t expiry;
+
+    /**
+     * Next timer in the same slot.
+     */
+    WheelTimer *next;
+
+    /**
+     * Pointer that points to this timer. Null while the timer is not scheduled.
+     */
+    WheelTimer **previous;
+
+    /**
+     * Creates an unscheduled timer.
+     * @param kind Kind of the timer.
+     * @param key Identifies the object of the timer.
+     */
+    explicit WheelTimer(uint8_t kind = 0, uint32_t key = 0) : kind(kind), key(key), expiry(0), next(nullptr),
+        previous(nullptr) {}
+
+    /**
+     * @return True while the timer is scheduled on a wheel.
+     */
+    bool scheduled() const {
+        return this->previous != nullptr;
+    }
+} WheelTimer;
+
+/**
+ * Hierarchical timer wheel with a resolution of one millisecond. Level l has WHEEL_SLOTS slots of
+ * WHEEL_SLOTS ^ l milliseconds each, timers move down a level when the lower levels have turned once.
+ * Scheduling and cancelling are O(1) and advancing the time costs one step per millisecond plus the expired timers,
+ * independent of the number of pending timers.
+ */
+class TimerWheel {
+
+    /**
+     * Lists of the timers of each slot.
+     */
+    WheelTimer *slots[WHEEL_LEVELS][WHEEL_SLOTS] = {};
+
+    /**
+     * Timers that have expired, but have not been polled yet.
+     */
+    WheelTimer *expired = nullptr;
+
+    /**
+     * Time up to which the wheel has been advanced.
+     */
+    uint32_t now = 0;
+
+    /**
+     * Number of scheduled timers, including the expired ones.
+     */
+    uint16_t count = 0;
+
+    /**
+     * Links a timer into the list of its slot or into the expired timers.
+     * @param timer The timer. Its expiry must be set.
+     */
+    void _insert(WheelTimer *timer);
+
+    /**
+     * Links a timer at the front of a list.
+     * @param head The list.
+     * @param timer The timer.
+     */
+    static void _link(WheelTimer **head, WheelTimer *timer);
+
+    /**
+     * Unlinks a timer from its list.
+     * @param timer The timer.
+     */
+    static void _unlink(WheelTimer *timer);
+
+public:
+    TimerWheel() = default;
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * Schedules a timer. If it is scheduled already, it is moved to the new time.
+     * @param timer The timer.
+     * @param time The current time. Must not be before the time of the last poll.
+     * @param delay Time until the timer expires.
+     */
+    void schedule(WheelTimer *timer, uint32_t time, uint32_t delay);
+
+    /**
+     * Cancels a timer. Does nothing if it is not scheduled.
+     * @param timer The timer.
+     */
+    void cancel(WheelTimer *timer);
+
+    /**
+     * Advances the wheel to the given time and takes the next expired timer.
+     * @param time The current time.
+     * @return The expired timer, which is not scheduled anymore, or nullptr if no timer has expired.
+     */
+    WheelTimer* poll(uint32_t time);
+
+    /**
+     * Calculates when the wheel has to be polled next. Timers on the upper levels are only known to expire
+     * after their slot has been reached, so the result is never after the next expiry.
+     * @param time The time of the next poll is written into this.
+     * @return False if no timer is scheduled.
+     */
+    bool nextExpiry(uint32_t *time) const;
+
+    /**
+     * @return Number of scheduled timers.
+     */
+    uint16_t size() const {
+        return this->count;
+    }
+
+    /**
+     * @return True if no timer is scheduled.
+     */
+    bool empty() const {
+        return this->count == 0;
+    }
+};
+
+
+#endif //NETWORKPROTOCOL_TIMERWHEEL_H
@@ -0,0 +1,45 @@
+#ifndef NETWORKPROTOCOL_TRANSPORT_H
+#define NETWORKPROTOCOL_TRANSPORT_H
+#include <cstdint>
+
+/**
+ * Data link layer a network device sends and receives raw packages with, e.g. a nRF24 radio or a simulated medium.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * Writes a raw package to a neighbour.
+     * @param package Raw package of PACKAGE_SIZE bytes to be sent. Only valid during the call.
+     * @param nextHop ID of the neighbour.
+     * @return True if the package has been sent successfully.
+     */
+    virtual bool write(const uint8_t *package, uint8_t nextHop) = 0;
+
+    /**
+     * Reads the next received raw package. Must only be called if a package is available.
+     * @param package Buffer of PACKAGE_SIZE bytes the received package is written into.
+     * @return ID of the neighbour that sent the package.
+     */
+    virtual uint8_t read(uint8_t *package) = 0;
+
+    /**
+     * @return True if a received package is available.
+     */
+    virtual bool messageAvailable() = 0;
+
+    /**
+     * @return The current time in milliseconds.
+     */
+    virtual uint32_t getTime() = 0;
+
+    /**
+     * Sets the ID packages are received for. Called whenever the ID of the device changes.
+     * @param id ID of the device.
+     */
+    virtual void setAddress(uint8_t id) = 0;
+};
+
+
+#endif //NETWORKPROTOCOL_TRANSPORT_H